@@ -0,0 +1,46 @@
+#version 330 core
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+// Per-frame camera and light data, written once per frame (frame_uniforms.h)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 cameraPos;
+    vec4 lightPos;
+    vec4 lightColor;
+    float time;
+};
+
+uniform vec3 objectColor;
+uniform bool useTexture;
+uniform sampler2D texture1;
+
+void main()
+{
+    vec3 baseColor = objectColor;
+    if (useTexture)
+        baseColor *= texture(texture1, TexCoord).rgb;
+
+    // Lines (the grid) have no normal; draw them unlit
+    if (dot(Normal, Normal) < 1e-6) {
+        FragColor = vec4(baseColor, 1.0);
+        return;
+    }
+
+    vec3 normal = normalize(Normal);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
+    vec3 viewDir = normalize(cameraPos.xyz - FragPos);
+    vec3 halfDir = normalize(lightDir + viewDir);
+
+    vec3 ambient = 0.2 * lightColor.rgb;
+    vec3 diffuse = max(dot(normal, lightDir), 0.0) * lightColor.rgb;
+    vec3 specular = 0.3 * pow(max(dot(normal, halfDir), 0.0), 32.0) * lightColor.rgb;
+
+    FragColor = vec4((ambient + diffuse + specular) * baseColor, 1.0);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+
+in vec2 TexCoord;
+in vec3 Tint;
+
+out vec4 FragColor;
+
+uniform sampler2D texture1;
+
+void main()
+{
+    vec4 texColor = texture(texture1, TexCoord);
+
+    // Drop fully transparent texels so they don't write depth
+    if (texColor.a < 0.1)
+        discard;
+
+    FragColor = vec4(texColor.rgb * Tint, texColor.a);
+}
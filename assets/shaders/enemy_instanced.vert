@@ -0,0 +1,50 @@
+#version 330 core
+
+// Unit quad corner and its texture coordinate (shared by every instance)
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+// Per-instance: world position + size, and pulse phase (sin, cos) + hit flash
+layout (location = 2) in vec4 aCenterScale;
+layout (location = 3) in vec4 aPhaseFlash;
+
+// Per-instance: animation frame rect in the atlas (u0, v0, u1, v1)
+layout (location = 4) in vec4 aFrameUV;
+
+// Per-frame camera and light data, written once per frame (frame_uniforms.h)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 cameraPos;
+    vec4 lightPos;
+    vec4 lightColor;
+    float time;
+};
+
+// sin/cos of the shared pulse time, expanded against each instance's phase
+uniform float timeSin;
+uniform float timeCos;
+uniform float pulseAmount;
+
+uniform vec3 baseTint;
+uniform vec3 flashTint;
+
+out vec2 TexCoord;
+out vec3 Tint;
+
+void main()
+{
+    // sin(time + phase) = sin(time) * cos(phase) + cos(time) * sin(phase)
+    float pulse = timeSin * aPhaseFlash.y + timeCos * aPhaseFlash.x;
+    float size = aCenterScale.w * (1.0 + pulse * pulseAmount);
+
+    // Billboard: span the quad along the camera's right and up axes
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    vec3 worldPos = aCenterScale.xyz + (right * aPos.x + up * aPos.y) * size;
+
+    gl_Position = viewProj * vec4(worldPos, 1.0);
+    TexCoord = mix(aFrameUV.xy, aFrameUV.zw, aTexCoord);
+    Tint = mix(baseTint, flashTint, aPhaseFlash.z);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+
+in vec3 Color;
+
+out vec4 FragColor;
+
+void main()
+{
+    // Round point with a soft edge; added to what is behind it
+    vec2 offset = gl_PointCoord * 2.0 - 1.0;
+    float distance2 = dot(offset, offset);
+    if (distance2 > 1.0)
+        discard;
+
+    float falloff = 1.0 - distance2;
+    FragColor = vec4(Color * falloff * falloff, 1.0);
+}
@@ -0,0 +1,54 @@
+#version 330 core
+
+layout (location = 0) in vec4 aPositionAge;    // xyz world position, seconds alive
+layout (location = 1) in vec4 aVelocityLife;   // xyz velocity, seconds to live
+layout (location = 2) in vec2 aHueSize;        // Hue in [0, 1), size in world units
+
+// Per-frame camera and light data, written once per frame (frame_uniforms.h)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 cameraPos;
+    vec4 lightPos;
+    vec4 lightColor;
+    float time;
+};
+
+// Height of the viewport in pixels, to size the points in world units
+uniform float viewportHeight;
+
+out vec3 Color;
+
+// Fully saturated color of a hue in [0, 1)
+vec3 hue_to_rgb(float hue)
+{
+    vec3 rgb = abs(fract(hue + vec3(0.0, 2.0 / 3.0, 1.0 / 3.0)) * 6.0 - 3.0) - 1.0;
+    return clamp(rgb, 0.0, 1.0);
+}
+
+void main()
+{
+    float age = aPositionAge.w;
+    float life = aVelocityLife.w;
+
+    // Dead particles land outside the clip volume and are dropped
+    if (age >= life) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        gl_PointSize = 1.0;
+        Color = vec3(0.0);
+        return;
+    }
+
+    float t = age / life;
+    vec4 viewPosition = view * vec4(aPositionAge.xyz, 1.0);
+    gl_Position = projection * viewPosition;
+
+    // Perspective size, shrinking to half over the particle's life
+    float pixels = aHueSize.y * (1.0 - 0.5 * t) * projection[1][1] * 0.5 * viewportHeight;
+    gl_PointSize = clamp(pixels / max(-viewPosition.z, 0.05), 1.0, 64.0);
+
+    // Hue drifts as it ages and the glow fades out
+    float fade = (1.0 - t) * (1.0 - t);
+    Color = hue_to_rgb(fract(aHueSize.x + 0.25 * t)) * fade;
+}
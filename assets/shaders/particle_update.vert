@@ -0,0 +1,109 @@
+#version 330 core
+
+// One particle in, the same particle one step later out through transform
+// feedback (see particles.c for the buffer layout)
+layout (location = 0) in vec4 aPositionAge;    // xyz world position, seconds alive
+layout (location = 1) in vec4 aVelocityLife;   // xyz velocity, seconds to live
+layout (location = 2) in vec2 aHueSize;        // Hue in [0, 1), size in world units
+
+out vec4 outPositionAge;
+out vec4 outVelocityLife;
+out vec2 outHueSize;
+
+// Must match PARTICLES_MAX_EMITTERS
+#define MAX_EMITTERS 64
+
+uniform float deltaTime;
+uniform float gravity;
+uniform float drag;
+uniform float groundLevel;
+uniform int capacity;
+uniform int seed;
+
+// Emitters started this pass. Each one owns a run of ring slots and
+// overwrites the particles in them with fresh ones.
+uniform int emitterCount;
+uniform ivec2 emitterRange[MAX_EMITTERS];      // First slot, particle count
+uniform vec4 emitterOrigin[MAX_EMITTERS];      // xyz position, speed
+uniform vec4 emitterShape[MAX_EMITTERS];       // xyz direction, spread (0 straight, 1 any direction)
+uniform vec4 emitterLook[MAX_EMITTERS];        // Hue, hue spread, size, lifetime
+
+// Integer hash (lowbias32); every slot and pass gets its own stream
+uint hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(inout uint state)
+{
+    state = hash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+// Uniformly distributed unit vector
+vec3 random_direction(inout uint state)
+{
+    float z = random(state) * 2.0 - 1.0;
+    float angle = random(state) * 6.28318531;
+    float r = sqrt(max(1.0 - z * z, 0.0));
+    return vec3(r * cos(angle), r * sin(angle), z);
+}
+
+void main()
+{
+    vec4 positionAge = aPositionAge;
+    vec4 velocityLife = aVelocityLife;
+    vec2 hueSize = aHueSize;
+
+    for (int e = 0; e < emitterCount; e++) {
+        // Distance into the emitter's run, which may wrap around the ring
+        int offset = gl_VertexID - emitterRange[e].x;
+        if (offset < 0) {
+            offset += capacity;
+        }
+        if (offset >= emitterRange[e].y) {
+            continue;
+        }
+
+        uint state = hash(uint(gl_VertexID) ^ hash(uint(seed)));
+        vec3 direction = random_direction(state);
+        if (dot(emitterShape[e].xyz, emitterShape[e].xyz) > 0.0) {
+            direction = normalize(mix(emitterShape[e].xyz, direction, emitterShape[e].w) + vec3(0.0, 1e-4, 0.0));
+        }
+
+        float speed = emitterOrigin[e].w * (0.35 + 0.65 * random(state));
+        positionAge = vec4(emitterOrigin[e].xyz, 0.0);
+        velocityLife = vec4(direction * speed, emitterLook[e].w * (0.5 + 0.5 * random(state)));
+        hueSize = vec2(fract(emitterLook[e].x + (random(state) - 0.5) * emitterLook[e].y),
+                       emitterLook[e].z * (0.5 + random(state)));
+        break;
+    }
+
+    // Dead particles keep their state until a slot is reused
+    if (positionAge.w < velocityLife.w) {
+        vec3 velocity = velocityLife.xyz;
+        velocity.y -= gravity * deltaTime;
+        velocity /= 1.0 + drag * deltaTime;
+
+        vec3 position = positionAge.xyz + velocity * deltaTime;
+
+        // Bounce off the ground, losing most of the energy
+        if (position.y < groundLevel) {
+            position.y = groundLevel;
+            velocity.y = abs(velocity.y) * 0.4;
+            velocity.xz *= 0.7;
+        }
+
+        positionAge = vec4(position, positionAge.w + deltaTime);
+        velocityLife.xyz = velocity;
+    }
+
+    outPositionAge = positionAge;
+    outVelocityLife = velocityLife;
+    outHueSize = hueSize;
+}
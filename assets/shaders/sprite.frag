@@ -0,0 +1,30 @@
+#version 330 core
+
+in vec2 TexCoord;
+in vec4 Color;
+
+out vec4 FragColor;
+
+uniform sampler2D texture1;
+
+// Clamp coordinates so edge texels don't bleed in from the opposite side
+uniform bool clampTexture;
+
+// Warm glow while the player is attacking
+uniform bool hasAttackLight;
+
+void main()
+{
+    vec2 uv = clampTexture ? clamp(TexCoord, 0.0, 1.0) : TexCoord;
+    // Textures are premultiplied, so premultiply the tint too
+    vec4 texColor = texture(texture1, uv) * vec4(Color.rgb * Color.a, Color.a);
+
+    // Drop fully transparent texels so they don't write depth
+    if (texColor.a < 0.1)
+        discard;
+
+    if (hasAttackLight)
+        texColor.rgb += vec3(0.3, 0.2, 0.05) * texColor.a;
+
+    FragColor = texColor;
+}
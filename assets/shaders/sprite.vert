@@ -0,0 +1,28 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+
+// Per-frame camera and light data, written once per frame (frame_uniforms.h)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 cameraPos;
+    vec4 lightPos;
+    vec4 lightColor;
+    float time;
+};
+
+uniform mat4 model;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+void main()
+{
+    TexCoord = aTexCoord;
+    Color = aColor;
+    gl_Position = viewProj * model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,19 @@
+#version 330 core
+
+in vec2 TexCoord;
+in vec4 Color;
+
+out vec4 FragColor;
+
+// Glyph coverage in the red channel
+uniform sampler2D fontAtlas;
+
+void main()
+{
+    float coverage = texture(fontAtlas, TexCoord).r * Color.a;
+    if (coverage <= 0.0)
+        discard;
+
+    // Premultiplied, like every sprite texture
+    FragColor = vec4(Color.rgb * coverage, coverage);
+}
@@ -0,0 +1,41 @@
+#version 330 core
+
+layout (location = 0) in vec2 aCorner;     // Quad corner, (0, 0) top-left to (1, 1) bottom-right
+layout (location = 1) in vec4 aAnchor;     // xyz world position; w 1 for world text, 0 for screen text
+layout (location = 2) in vec4 aRect;       // Glyph offset from the anchor in pixels (y down), size
+layout (location = 3) in vec4 aUV;         // Atlas rectangle (u0, v0, u1, v1)
+layout (location = 4) in vec4 aColor;      // Straight RGBA
+
+// Per-frame camera and light data, written once per frame (frame_uniforms.h)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 cameraPos;
+    vec4 lightPos;
+    vec4 lightColor;
+    float time;
+};
+
+uniform float viewportWidth;
+uniform float viewportHeight;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+void main()
+{
+    vec2 pixel = aRect.xy + aCorner * aRect.zw;
+    vec2 pixelToNdc = vec2(2.0 / viewportWidth, -2.0 / viewportHeight);
+
+    if (aAnchor.w > 0.5) {
+        // Pixel offsets around the projected anchor, constant size at any distance
+        vec4 clip = viewProj * vec4(aAnchor.xyz, 1.0);
+        gl_Position = vec4(clip.xy + pixel * pixelToNdc * clip.w, 0.0, clip.w);
+    } else {
+        gl_Position = vec4(pixel * pixelToNdc + vec2(-1.0, 1.0), 0.0, 1.0);
+    }
+
+    TexCoord = mix(aUV.xy, aUV.zw, aCorner);
+    Color = aColor;
+}
@@ -0,0 +1,323 @@
+// bench.c
+//
+// Microbenchmarks for the simulation hot paths: enemy update, projectile
+// update (linear and orbit), enemy-projectile collisions, spawn slot
+// allocation and the wave batch spawner. Every case runs at several
+// population sizes and reports the fastest of BENCH_REPEATS samples as
+// ns per entity. Links only the headless simulation sources.
+//
+// Usage: bench [--json FILE] [--threads N] [--repeats N]
+//   --json FILE   also write results as JSON (use - for stdout) for diffing
+//   --threads N   job system threads (default 1 so runs are repeatable)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "enemy.h"
+#include "projectile.h"
+#include "wave.h"
+#include "physics.h"
+#include "job_system.h"
+#include "timer.h"
+
+// Number of timed samples per case; the fastest one is reported
+#define BENCH_REPEATS 7
+
+// Upper bound on recorded results
+#define BENCH_MAX_RESULTS 64
+
+// Fixed tick length fed to the update functions
+#define BENCH_TICK_SECONDS (1.0f / 60.0f)
+
+// Long enough that nothing expires while being measured
+#define BENCH_PROJECTILE_LIFETIME 1.0e9f
+
+static const int enemyCounts[] = {1000, 10000, 100000};
+static const int projectileCounts[] = {8, 16, MAX_PROJECTILES};
+
+// Wave sizes are 5 + 2 * (wave - 1), so these are reachable exactly
+static const int waveSizes[] = {101, 1001, 10001};
+
+#define COUNT_OF(array) ((int)(sizeof(array) / sizeof((array)[0])))
+
+typedef struct {
+    const char* name;
+    int size;           // Entities per sample
+    uint64_t bestNs;    // Fastest sample
+    double nsPerEntity;
+} BenchResult;
+
+static BenchResult results[BENCH_MAX_RESULTS];
+static int resultCount = 0;
+static int repeats = BENCH_REPEATS;
+
+// Where the human-readable table goes (stderr when JSON takes stdout)
+static FILE* tableOut = NULL;
+
+// Deterministic pseudo-random float in [-range, range]
+static float bench_random(unsigned int* state, float range) {
+    *state = *state * 1664525u + 1013904223u;
+    return ((float)(*state >> 8) / (float)(1u << 24)) * 2.0f * range - range;
+}
+
+static void record(const char* name, int size, uint64_t bestNs, int entitiesPerSample) {
+    if (resultCount >= BENCH_MAX_RESULTS) {
+        return;
+    }
+    
+    BenchResult* result = &results[resultCount++];
+    result->name = name;
+    result->size = size;
+    result->bestNs = bestNs;
+    result->nsPerEntity = (double)bestNs / (double)entitiesPerSample;
+    
+    fprintf(tableOut, "%-26s %8d %14.3f us %10.2f ns/entity\n",
+           name, size, (double)bestNs / 1000.0, result->nsPerEntity);
+}
+
+// Fresh enemy system holding count enemies spread over the arena
+static void reset_enemies(int count) {
+    enemy_system_cleanup();
+    enemy_system_init();
+    
+    unsigned int seed = 12345u;
+    for (int i = 0; i < count; i++) {
+        float x = bench_random(&seed, WAVE_ARENA_HALF_SIZE);
+        float z = bench_random(&seed, WAVE_ARENA_HALF_SIZE);
+        spawn_enemy(x, GROUND_LEVEL, z);
+    }
+}
+
+// Fresh projectile system with at least count linear or orbiting projectiles
+// (orbit spawns come in rings of six). Returns how many slots are active.
+static int reset_projectiles(int count, bool orbit) {
+    projectile_system_cleanup();
+    projectile_system_init();
+    set_projectile_orbit_mode(orbit);
+    
+    unsigned int seed = 777u;
+    int spawned = 0;
+    while (spawned < count) {
+        float x = bench_random(&seed, 5.0f);
+        float z = bench_random(&seed, 5.0f);
+        float angle = bench_random(&seed, 3.14159f);
+        spawn_projectile(x, GROUND_LEVEL + 0.3f, z, cosf(angle), sinf(angle), 0.5f,
+                         BENCH_PROJECTILE_LIFETIME);
+        
+        // Orbit mode fills six slots per spawn
+        spawned += orbit ? 6 : 1;
+    }
+    
+    int active = 0;
+    const Projectile* projectiles = get_projectiles();
+    for (int i = 0; i < MAX_PROJECTILES; i++) {
+        if (projectiles[i].active) active++;
+    }
+    return active;
+}
+
+// One steering tick over the whole horde
+static void bench_update_enemies(void) {
+    for (int c = 0; c < COUNT_OF(enemyCounts); c++) {
+        int count = enemyCounts[c];
+        uint64_t best = UINT64_MAX;
+        
+        for (int r = 0; r < repeats; r++) {
+            reset_enemies(count);
+            
+            uint64_t start = timer_now_ns();
+            update_enemies(BENCH_TICK_SECONDS, 0.0f, 0.0f);
+            uint64_t elapsed = timer_now_ns() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        
+        record("update_enemies", count, best, count);
+    }
+}
+
+// Projectile integration; the pool is tiny, so each sample runs many ticks
+static void bench_update_projectiles(const char* name, bool orbit) {
+    const int ticksPerSample = 1000;
+    
+    for (int c = 0; c < COUNT_OF(projectileCounts); c++) {
+        int count = projectileCounts[c];
+        uint64_t best = UINT64_MAX;
+        
+        for (int r = 0; r < repeats; r++) {
+            count = reset_projectiles(projectileCounts[c], orbit);
+            
+            uint64_t start = timer_now_ns();
+            for (int t = 0; t < ticksPerSample; t++) {
+                update_projectiles(BENCH_TICK_SECONDS);
+            }
+            uint64_t elapsed = timer_now_ns() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        
+        record(name, count, best, count * ticksPerSample);
+    }
+}
+
+// Full collision pass (grid build, queries, resolve) against a full projectile pool
+static void bench_collisions(void) {
+    for (int c = 0; c < COUNT_OF(enemyCounts); c++) {
+        int count = enemyCounts[c];
+        uint64_t best = UINT64_MAX;
+        
+        for (int r = 0; r < repeats; r++) {
+            reset_enemies(count);
+            reset_projectiles(MAX_PROJECTILES, false);
+            
+            uint64_t start = timer_now_ns();
+            check_enemy_projectile_collisions();
+            uint64_t elapsed = timer_now_ns() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        
+        record("collisions", count, best, count);
+    }
+    
+    projectile_system_cleanup();
+}
+
+// Spawning into an empty system, including store growth
+static void bench_spawn_enemy(void) {
+    for (int c = 0; c < COUNT_OF(enemyCounts); c++) {
+        int count = enemyCounts[c];
+        uint64_t best = UINT64_MAX;
+        
+        for (int r = 0; r < repeats; r++) {
+            reset_enemies(0);
+            
+            uint64_t start = timer_now_ns();
+            for (int i = 0; i < count; i++) {
+                spawn_enemy((float)(i % 40) - 20.0f, GROUND_LEVEL, (float)(i / 40 % 40) - 20.0f);
+            }
+            uint64_t elapsed = timer_now_ns() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        
+        record("spawn_enemy", count, best, count);
+    }
+}
+
+// Filling the projectile slots one spawn at a time (linear free-slot scan)
+static void bench_spawn_projectile(void) {
+    const int fillsPerSample = 1000;
+    
+    for (int c = 0; c < COUNT_OF(projectileCounts); c++) {
+        int count = projectileCounts[c];
+        uint64_t best = UINT64_MAX;
+        
+        for (int r = 0; r < repeats; r++) {
+            uint64_t elapsed = 0;
+            
+            for (int f = 0; f < fillsPerSample; f++) {
+                projectile_system_cleanup();
+                projectile_system_init();
+                
+                uint64_t start = timer_now_ns();
+                for (int i = 0; i < count; i++) {
+                    spawn_projectile(0.0f, GROUND_LEVEL, 0.0f, 1.0f, 0.0f, 0.5f,
+                                     BENCH_PROJECTILE_LIFETIME);
+                }
+                elapsed += timer_now_ns() - start;
+            }
+            if (elapsed < best) best = elapsed;
+        }
+        
+        record("spawn_projectile", count, best, count * fillsPerSample);
+    }
+    
+    projectile_system_cleanup();
+}
+
+// Start a wave and step the spawner until every batch is out
+static void bench_wave_spawner(void) {
+    for (int c = 0; c < COUNT_OF(waveSizes); c++) {
+        int size = waveSizes[c];
+        uint64_t best = UINT64_MAX;
+        
+        for (int r = 0; r < repeats; r++) {
+            reset_enemies(0);
+            srand(42u);
+            
+            // Pretend the previous waves are done so the next one has `size` enemies
+            WaveState wave;
+            wave_init(&wave);
+            wave.waveNumber = (size - 5) / 2;
+            
+            // A one-second step makes every call spawn a batch
+            uint64_t start = timer_now_ns();
+            bool startRequested = true;
+            do {
+                wave_update(&wave, startRequested, 1.0f);
+                startRequested = false;
+            } while (wave.enemiesRemainingInWave > 0);
+            uint64_t elapsed = timer_now_ns() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        
+        record("wave_spawner", size, best, size);
+    }
+}
+
+static void write_json(FILE* file, int threads) {
+    fprintf(file, "{\n  \"threads\": %d,\n  \"repeats\": %d,\n  \"results\": [\n", threads, repeats);
+    for (int i = 0; i < resultCount; i++) {
+        fprintf(file, "    {\"name\": \"%s\", \"size\": %d, \"best_ns\": %llu, \"ns_per_entity\": %.3f}%s\n",
+                results[i].name, results[i].size, (unsigned long long)results[i].bestNs,
+                results[i].nsPerEntity, i + 1 < resultCount ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    const char* jsonPath = NULL;
+    int threads = 1;
+    
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+            jsonPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0) {
+            threads = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--repeats") == 0) {
+            repeats = atoi(argv[++i]);
+            if (repeats < 1) repeats = 1;
+        } else {
+            fprintf(stderr, "usage: %s [--json FILE] [--threads N] [--repeats N]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    job_system_init(threads);
+    projectile_system_init();
+    enemy_system_init();
+    
+    tableOut = (jsonPath && strcmp(jsonPath, "-") == 0) ? stderr : stdout;
+    fprintf(tableOut, "%-26s %8s %17s %20s\n", "case", "size", "best", "per entity");
+    
+    bench_update_enemies();
+    bench_update_projectiles("update_projectiles_linear", false);
+    bench_update_projectiles("update_projectiles_orbit", true);
+    bench_collisions();
+    bench_spawn_enemy();
+    bench_spawn_projectile();
+    bench_wave_spawner();
+    
+    if (jsonPath) {
+        FILE* file = strcmp(jsonPath, "-") == 0 ? stdout : fopen(jsonPath, "w");
+        if (!file) {
+            fprintf(stderr, "Failed to open %s for writing\n", jsonPath);
+        } else {
+            write_json(file, job_system_thread_count());
+            if (file != stdout) fclose(file);
+        }
+    }
+    
+    enemy_system_cleanup();
+    projectile_system_cleanup();
+    job_system_shutdown();
+    return 0;
+}
@@ -0,0 +1,150 @@
+// bench_enemy_store.c
+//
+// Times the struct-of-arrays enemy store at horde sizes. Runs without a
+// window or GL context: only the store, steering kernels and timer are linked.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "enemy_store.h"
+#include "enemy_steering.h"
+#include "timer.h"
+
+// Number of timed repetitions per case; the fastest one is reported
+#define BENCH_REPEATS 7
+
+static const int populationSizes[] = {1000, 10000, 100000};
+
+// Deterministic pseudo-random float in [-range, range]
+static float bench_random(unsigned int* state, float range) {
+    *state = *state * 1664525u + 1013904223u;
+    return ((float)(*state >> 8) / (float)(1u << 24)) * 2.0f * range - range;
+}
+
+// Fill an empty store with count enemies spread over the grid
+static void fill_store(EnemyStore* store, int count) {
+    unsigned int seed = 12345u;
+    for (int i = 0; i < count; i++) {
+        float x = bench_random(&seed, 20.0f);
+        float z = bench_random(&seed, 20.0f);
+        enemy_store_push(store, x, 1.0f, z, 50.0f, 0.3f, (float)i);
+    }
+}
+
+// Steering inputs for one 60 Hz tick with the player at the origin
+static EnemySteerParams steer_params(void) {
+    EnemySteerParams params;
+    params.targetX = 0.0f;
+    params.targetZ = 0.0f;
+    params.speed = 0.5f;
+    params.stopDistance = 0.5f;
+    params.deltaTime = 1.0f / 60.0f;
+    params.bobBaseY = 0.8f;
+    params.bobAmplitude = 0.05f;
+    params.timeSin = sinf(1.3f);
+    params.timeCos = cosf(1.3f);
+    return params;
+}
+
+// Largest absolute difference between two stores' positions and velocities
+static float max_difference(const EnemyStore* a, const EnemyStore* b) {
+    float worst = 0.0f;
+    for (int i = 0; i < a->count; i++) {
+        float d[5] = {
+            fabsf(a->x[i] - b->x[i]),
+            fabsf(a->y[i] - b->y[i]),
+            fabsf(a->z[i] - b->z[i]),
+            fabsf(a->velocityX[i] - b->velocityX[i]),
+            fabsf(a->velocityZ[i] - b->velocityZ[i])
+        };
+        for (int k = 0; k < 5; k++) {
+            if (d[k] > worst) worst = d[k];
+        }
+    }
+    return worst;
+}
+
+// Kill every tenth enemy and sweep the dead out with swap-remove
+static void churn_pass(EnemyStore* store) {
+    for (int i = 0; i < store->count; i += 10) {
+        store->health[i] = 0.0f;
+    }
+    enemy_store_remove_dead(store);
+}
+
+static void report(const char* name, int count, uint64_t bestNs) {
+    printf("%-12s %8d enemies %12.3f us %8.2f ns/enemy\n",
+           name, count, (double)bestNs / 1000.0, (double)bestNs / (double)count);
+}
+
+int main(void) {
+    int caseCount = (int)(sizeof(populationSizes) / sizeof(populationSizes[0]));
+    const EnemySteerKernel kernels[] = {
+        ENEMY_STEER_KERNEL_SCALAR, ENEMY_STEER_KERNEL_SSE2, ENEMY_STEER_KERNEL_AVX2
+    };
+    const EnemySteerParams params = steer_params();
+
+    enemy_steer_init();
+    printf("best steering kernel: %s\n", enemy_steer_kernel_name(enemy_steer_best_kernel()));
+
+    for (int c = 0; c < caseCount; c++) {
+        int count = populationSizes[c];
+        uint64_t bestFill = UINT64_MAX;
+        uint64_t bestChurn = UINT64_MAX;
+
+        for (int r = 0; r < BENCH_REPEATS; r++) {
+            EnemyStore store;
+            enemy_store_init(&store, ENEMY_STORE_INITIAL_CAPACITY);
+
+            // Fill from a small store so growth is part of the measurement
+            uint64_t start = timer_now_ns();
+            fill_store(&store, count);
+            uint64_t elapsed = timer_now_ns() - start;
+            if (elapsed < bestFill) bestFill = elapsed;
+
+            start = timer_now_ns();
+            churn_pass(&store);
+            elapsed = timer_now_ns() - start;
+            if (elapsed < bestChurn) bestChurn = elapsed;
+
+            enemy_store_free(&store);
+        }
+
+        report("fill", count, bestFill);
+        report("churn", count, bestChurn);
+
+        // Steering: time each kernel and check it against the scalar reference
+        EnemyStore reference;
+        enemy_store_init(&reference, count);
+        fill_store(&reference, count);
+        enemy_steer_with_kernel(ENEMY_STEER_KERNEL_SCALAR, &reference, 0, reference.count, &params);
+
+        for (int k = 0; k < (int)(sizeof(kernels) / sizeof(kernels[0])); k++) {
+            uint64_t bestSteer = UINT64_MAX;
+            float error = 0.0f;
+
+            for (int r = 0; r < BENCH_REPEATS; r++) {
+                EnemyStore store;
+                enemy_store_init(&store, count);
+                fill_store(&store, count);
+
+                uint64_t start = timer_now_ns();
+                enemy_steer_with_kernel(kernels[k], &store, 0, store.count, &params);
+                uint64_t elapsed = timer_now_ns() - start;
+                if (elapsed < bestSteer) bestSteer = elapsed;
+
+                error = max_difference(&store, &reference);
+                enemy_store_free(&store);
+            }
+
+            char name[32];
+            snprintf(name, sizeof(name), "steer-%s", enemy_steer_kernel_name(kernels[k]));
+            report(name, count, bestSteer);
+            printf("         max |kernel - scalar| = %g\n", error);
+        }
+
+        enemy_store_free(&reference);
+    }
+
+    return 0;
+}
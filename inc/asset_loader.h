@@ -0,0 +1,50 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// GL upload time asset_loader_pump may spend per frame by default
+#define ASSET_LOADER_FRAME_BUDGET_NS 2000000ull
+
+// Where an asynchronously loaded asset is. Only the GL thread writes it
+// (LOADING on submit, READY or FAILED after the upload), so the owner can
+// read it every frame without synchronisation.
+typedef enum {
+    ASSET_STATE_UNLOADED,
+    ASSET_STATE_LOADING,
+    ASSET_STATE_READY,
+    ASSET_STATE_FAILED
+} AssetState;
+
+// Runs on a worker thread: read and decode into the payload, no GL calls.
+// Returns false if the asset could not be decoded.
+typedef bool (*AssetDecodeFunc)(void* payload);
+
+// Runs on the GL thread inside asset_loader_pump with the decode result.
+// Creates the GL objects and frees the decoded data either way; returns
+// false if the asset is unusable.
+typedef bool (*AssetUploadFunc)(void* payload, bool decoded);
+
+// Set up the ready queue. Call on the GL thread after job_system_init.
+void asset_loader_init(void);
+
+// Queue payload for decoding on the job system. state (may be NULL) is set to
+// LOADING now and to READY or FAILED once upload has run on the GL thread.
+void asset_loader_submit(AssetDecodeFunc decode, AssetUploadFunc upload, void* payload, AssetState* state);
+
+// Upload decoded assets on the GL thread until budgetNs has been spent. At
+// least one asset is uploaded per call when any is ready, so progress never
+// stalls. Returns the number of assets uploaded.
+int asset_loader_pump(uint64_t budgetNs);
+
+// Assets submitted and not yet uploaded
+int asset_loader_pending(void);
+
+// Wait for every outstanding decode and upload all of them (GL thread)
+void asset_loader_finish(void);
+
+// Finish outstanding loads and release the queue
+void asset_loader_shutdown(void);
+
+#endif // ASSET_LOADER_H
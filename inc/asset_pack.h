@@ -0,0 +1,77 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "atlas_packer.h"
+#include "file_map.h"
+
+// Cooked sprite pack written by cook_assets and memory-mapped at startup
+#define ASSET_PACK_PATH "assets/cooked/sprites.pack"
+#define ASSET_PACK_MAGIC 0x4B504650u   // "PFPK"
+#define ASSET_PACK_VERSION 1
+
+// Animation frame groups, in the order they are packed
+typedef enum {
+    ASSET_GROUP_KNIGHT_IDLE,
+    ASSET_GROUP_KNIGHT_RUN,
+    ASSET_GROUP_KNIGHT_JUMP,
+    ASSET_GROUP_KNIGHT_SWORD_SLASH,
+    ASSET_GROUP_FIRE_SKULL,
+    ASSET_GROUP_COUNT
+} AssetGroup;
+
+// File layout: header, frame table, group table, then each mip level of the
+// premultiplied RGBA atlas page at the offsets the header gives (16-byte aligned)
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pageWidth;
+    uint32_t pageHeight;
+    uint32_t mipCount;
+    uint32_t frameCount;
+    uint32_t groupCount;
+    uint32_t reserved;
+    uint64_t framesOffset;
+    uint64_t groupsOffset;
+    uint64_t mipOffsets[ATLAS_MAX_MIP_LEVELS];
+    uint64_t mipSizes[ATLAS_MAX_MIP_LEVELS];
+} AssetPackHeader;
+
+typedef struct {
+    float u0, v0, u1, v1;      // (u0, v0) at the top-left of the frame
+    uint32_t width;            // Source image size in pixels (0 if it failed to cook)
+    uint32_t height;
+} AssetPackFrame;
+
+typedef struct {
+    uint32_t firstFrame;
+    uint32_t frameCount;
+} AssetPackGroup;
+
+// A mapped pack. Pointers stay valid until asset_pack_close.
+typedef struct {
+    MappedFile file;
+    const AssetPackHeader* header;
+    const AssetPackFrame* frames;
+    const AssetPackGroup* groups;
+} AssetPack;
+
+// Source directory of a frame group
+const char* asset_group_directory(AssetGroup group);
+
+// List the .png files in a directory, sorted so "frame10" follows "frame9".
+// Returns the count; the caller frees each path and the array.
+int load_animation_frames(const char* basePath, char*** framePathsOut);
+
+// Map a pack and validate it. Returns false if it is missing, stale or corrupt.
+bool asset_pack_open(AssetPack* pack, const char* path);
+
+// Pixels of one mip level of the atlas page
+const unsigned char* asset_pack_mip(const AssetPack* pack, int level, int* width, int* height);
+
+// Unmap the pack
+void asset_pack_close(AssetPack* pack);
+
+#endif // ASSET_PACK_H
@@ -0,0 +1,45 @@
+#ifndef ATLAS_PACKER_H
+#define ATLAS_PACKER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Gutter around every packed frame. Frame edges are extruded into it, and it
+// halves per mip level, so ATLAS_MAX_MIP_LEVELS levels stay bleed-free.
+#define ATLAS_PADDING 4
+
+// Mip levels kept for an atlas page (level 0 included)
+#define ATLAS_MAX_MIP_LEVELS 3
+
+// Smallest page width tried; doubled until the packed height fits
+#define ATLAS_MIN_WIDTH 256
+
+// One source image. x/y are filled in by atlas_pack.
+typedef struct {
+    unsigned char* pixels;   // Straight-alpha RGBA, NULL if the image failed to load
+    int width;
+    int height;
+    int x;                   // Packed position of the image (inside its padding)
+    int y;
+} AtlasImage;
+
+// A packed page: premultiplied RGBA with its mip chain
+typedef struct {
+    int width;
+    int height;
+    int mipCount;
+    unsigned char* mips[ATLAS_MAX_MIP_LEVELS];
+} AtlasPage;
+
+// Place every loaded image on one page no larger than maxSize, then build the
+// premultiplied pixels and mip chain. Returns false if no image has pixels.
+bool atlas_pack(AtlasImage* images, int count, int maxSize, AtlasPage* page);
+
+// Size in pixels of mip level of a page
+int atlas_mip_width(const AtlasPage* page, int level);
+int atlas_mip_height(const AtlasPage* page, int level);
+
+// Release the page's pixels
+void atlas_page_free(AtlasPage* page);
+
+#endif // ATLAS_PACKER_H
@@ -27,9 +27,12 @@ typedef struct {
     CharacterState currentState;
     bool facingRight;
     float stateTime;  // Time spent in current state
+    bool atlasAcquired;  // Holds a reference on the shared character atlas
+    bool animationsBound;  // States point into the atlas (set once it has loaded)
 } CharacterAnimator;
 
-// Initialize the character animator
+// Initialize the character animator. The frames load asynchronously and
+// are bound by character_animator_update once the atlas is resident.
 void character_animator_init(CharacterAnimator* animator);
 
 // Update the animator with the current state
@@ -41,7 +44,16 @@ void character_animator_render(CharacterAnimator* animator, Shader* shader, vec3
 // Clean up resources
 void character_animator_cleanup(CharacterAnimator* animator);
 
-// Helper function to load all frames from a directory
-int load_animation_frames(const char* basePath, char*** framePathsOut);
+// Start loading the Fire Skull enemy frames, which share one atlas with the
+// player's animations. sprite stays empty until fire_skull_animation_bind
+// succeeds. Returns false if the atlas already failed to load.
+bool fire_skull_animation_init(Sprite* sprite);
+
+// Point sprite at the Fire Skull frames if the atlas has loaded. Returns
+// true once sprite has frames to draw.
+bool fire_skull_animation_bind(Sprite* sprite);
+
+// Release a sprite set up by fire_skull_animation_init
+void fire_skull_animation_cleanup(Sprite* sprite);
 
 #endif // CHARACTER_ANIMATION_H 
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <stdbool.h>
+#include <cglm/cglm.h>
+
+// View frustum as six planes (left, right, bottom, top, near, far). Each is
+// (a, b, c, d) with a unit normal pointing inwards: a point p is inside
+// when a*x + b*y + c*z + d >= 0.
+typedef struct {
+    vec4 planes[6];
+} Frustum;
+
+// Positions of a struct-of-arrays set of entities, blended between the last
+// two ticks the way the renderers draw them. prev arrays may be NULL to use
+// the current positions as they are.
+typedef struct {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* prevX;
+    const float* prevY;
+    const float* prevZ;
+    float alpha;
+} CullPositions;
+
+// Work done by the culling stage this frame
+typedef struct {
+    int tested;
+    int visible;
+    int culled;
+} CullStats;
+
+// Extract the frustum planes of a projection * view matrix (Gribb/Hartmann)
+void frustum_extract(Frustum* frustum, mat4 viewProj);
+
+// True if a sphere touches the frustum
+bool frustum_sphere_visible(const Frustum* frustum, const vec3 center, float radius);
+
+// Test count spheres of one radius, four at a time with SSE2 on x86. Writes
+// the indices of the visible ones to visible in order and returns how many.
+int frustum_cull_spheres(const Frustum* frustum, const CullPositions* positions, int count,
+                         float radius, int* visible);
+
+// Start a frame: take the camera's planes and reset the counters
+void culling_begin(mat4 viewProj);
+
+// Frame-frustum versions of the tests above that also update the counters
+bool culling_sphere_visible(const vec3 center, float radius);
+int culling_cull_spheres(const CullPositions* positions, int count, float radius, int* visible);
+
+// Planes taken by the last culling_begin, for tests that shouldn't count
+// towards the culling stats
+const Frustum* culling_frame_frustum(void);
+
+// Counters for the current frame (complete once it has rendered)
+CullStats culling_get_stats(void);
+
+#endif // CULLING_H
@@ -2,18 +2,8 @@
 #define ENEMY_H
 
 #include <stdbool.h>
-#include "shader.h"
-
-#define MAX_ENEMIES 20
-
-typedef struct {
-    float x, y, z;         // Position
-    float velocityX, velocityZ; // Velocity
-    float health;          // Health points
-    float radius;          // Collision radius
-    bool active;           // Whether the enemy is active
-    unsigned int textureID; // Texture ID for the enemy
-} Enemy;
+#include "enemy_store.h"
+#include "job_system.h"
 
 // Initialize the enemy system
 void enemy_system_init(void);
@@ -24,8 +14,11 @@ void spawn_enemy(float x, float y, float z);
 // Update all enemies
 void update_enemies(float deltaTime, float playerX, float playerZ);
 
-// Render all enemies
-void render_enemies(Shader* shader);
+// Start updating all enemies as jobs; finished when counter reaches zero
+void update_enemies_async(float deltaTime, float playerX, float playerZ, JobCounter* counter);
+
+// Remove enemies whose health dropped to zero. Returns how many were removed
+int remove_dead_enemies(void);
 
 // Clean up enemy resources
 void enemy_system_cleanup(void);
@@ -33,7 +26,19 @@ void enemy_system_cleanup(void);
 // Check if an enemy is hit by a projectile
 void check_enemy_projectile_collisions(void);
 
+// Start collision detection after dependency (may be NULL); finished when counter reaches zero
+void check_enemy_projectile_collisions_async(JobCounter* dependency, JobCounter* counter);
+
 // Add this function declaration
 bool is_enemy_active(int index);
 
+// Number of live enemies
+int get_enemy_count(void);
+
+// Read-only access to the enemy store
+const EnemyStore* get_enemy_store(void);
+
+// Seconds of simulation time the enemies have been updated for (drives bob/pulse)
+float get_enemy_time(void);
+
 #endif // ENEMY_H 
\ No newline at end of file
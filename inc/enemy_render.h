@@ -0,0 +1,18 @@
+#ifndef ENEMY_RENDER_H
+#define ENEMY_RENDER_H
+
+#include "shader.h"
+
+// Load the instanced enemy shader, Fire Skull frames and quad (needs a GL context)
+void enemy_render_init(void);
+
+// Queue the enemies inside the frame's frustum (culling_begin) with the
+// render queue as one instanced draw of camera-facing billboards, sorted back
+// to front. alpha in [0, 1] blends the previous and current tick. The camera
+// comes from the per-frame uniform buffer.
+void render_enemies(float alpha);
+
+// Release the enemy shader, texture, quad and instance buffer
+void enemy_render_cleanup(void);
+
+#endif // ENEMY_RENDER_H
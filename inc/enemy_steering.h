@@ -0,0 +1,43 @@
+#ifndef ENEMY_STEERING_H
+#define ENEMY_STEERING_H
+
+#include "enemy_store.h"
+
+// Which implementation of the seek-the-player kernel to run
+typedef enum {
+    ENEMY_STEER_KERNEL_AUTO,    // Best kernel supported by this CPU
+    ENEMY_STEER_KERNEL_SCALAR,  // Portable reference implementation
+    ENEMY_STEER_KERNEL_SSE2,    // 4 enemies per iteration
+    ENEMY_STEER_KERNEL_AVX2     // 8 enemies per iteration
+} EnemySteerKernel;
+
+// Per-tick steering inputs, computed once outside the enemy loop
+typedef struct {
+    float targetX, targetZ;    // Position to seek (the player)
+    float speed;               // Movement speed in units per second
+    float stopDistance;        // Enemies closer than this stop moving
+    float deltaTime;           // Tick length in seconds
+    float bobBaseY;            // Resting height of the bob
+    float bobAmplitude;        // Bob height offset
+    float timeSin, timeCos;    // sin/cos of the shared time phase for this tick
+} EnemySteerParams;
+
+// Detect the best kernel for this CPU. Call once before any steering runs
+// (enemy_system_init does); steering jobs only read the result.
+void enemy_steer_init(void);
+
+// Seek, integrate and bob enemies [begin, end) using the best available kernel.
+// The pre-step position is saved to prevX/prevY/prevZ for render interpolation.
+void enemy_steer(EnemyStore* store, int begin, int end, const EnemySteerParams* params);
+
+// Same as enemy_steer but with an explicit kernel (falls back to scalar if unsupported)
+void enemy_steer_with_kernel(EnemySteerKernel kernel, EnemyStore* store, int begin, int end,
+                             const EnemySteerParams* params);
+
+// Kernel that ENEMY_STEER_KERNEL_AUTO resolves to on this CPU
+EnemySteerKernel enemy_steer_best_kernel(void);
+
+// Human-readable kernel name for logs and benchmarks
+const char* enemy_steer_kernel_name(EnemySteerKernel kernel);
+
+#endif // ENEMY_STEERING_H
@@ -0,0 +1,51 @@
+#ifndef ENEMY_STORE_H
+#define ENEMY_STORE_H
+
+#include <stdbool.h>
+
+// Number of slots reserved up front; the store doubles when it runs out
+#define ENEMY_STORE_INITIAL_CAPACITY 64
+
+// Struct-of-arrays enemy storage. Live enemies are packed into [0, count)
+// and removal swaps the last live enemy into the freed slot, so every pass
+// touches only live data.
+typedef struct {
+    float* x;              // Position X
+    float* y;              // Position Y
+    float* z;              // Position Z
+    float* prevX;          // Position X before the last tick (render interpolation)
+    float* prevY;          // Position Y before the last tick
+    float* prevZ;          // Position Z before the last tick
+    float* velocityX;      // Velocity X
+    float* velocityZ;      // Velocity Z
+    float* health;         // Health points
+    float* radius;         // Collision radius
+    float* hitFlashTime;   // Remaining hit flash time in seconds
+    float* phaseSin;       // sin of the bob/pulse phase offset, fixed at spawn
+    float* phaseCos;       // cos of the bob/pulse phase offset, fixed at spawn
+    int count;             // Number of live enemies
+    int capacity;          // Allocated slots per array
+} EnemyStore;
+
+// Allocate the arrays with room for initialCapacity enemies
+bool enemy_store_init(EnemyStore* store, int initialCapacity);
+
+// Grow the arrays so at least capacity enemies fit
+bool enemy_store_reserve(EnemyStore* store, int capacity);
+
+// Append an enemy, growing if needed. Returns its index or -1 on failure
+int enemy_store_push(EnemyStore* store, float x, float y, float z, float health, float radius, float phase);
+
+// Remove the enemy at index by moving the last live enemy into its slot
+void enemy_store_remove(EnemyStore* store, int index);
+
+// Remove every enemy whose health dropped to zero. Returns how many were removed
+int enemy_store_remove_dead(EnemyStore* store);
+
+// Drop all enemies but keep the allocation
+void enemy_store_clear(EnemyStore* store);
+
+// Release all arrays
+void enemy_store_free(EnemyStore* store);
+
+#endif // ENEMY_STORE_H
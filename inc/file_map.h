@@ -0,0 +1,23 @@
+#ifndef FILE_MAP_H
+#define FILE_MAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// A whole file mapped read-only. data stays valid until file_map_close.
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+} MappedFile;
+
+// Map path into memory. Returns false if it is missing or empty.
+bool file_map_open(MappedFile* file, const char* path);
+
+// Unmap the file (safe on a zeroed MappedFile)
+void file_map_close(MappedFile* file);
+
+#endif // FILE_MAP_H
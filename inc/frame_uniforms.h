@@ -0,0 +1,41 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <cglm/cglm.h>
+
+// Per-frame data shared by every shader program through one std140 uniform
+// block. Mirrors this GLSL declaration (see assets/shaders/*.vert):
+//
+//   layout (std140) uniform FrameData {
+//       mat4 view;
+//       mat4 projection;
+//       mat4 viewProj;
+//       vec4 cameraPos;   // xyz position, w unused
+//       vec4 lightPos;    // xyz position, w unused
+//       vec4 lightColor;  // rgb color, a unused
+//       float time;       // Seconds since startup
+//   };
+//
+// Every member sits on a 16-byte boundary, so the C layout matches std140.
+typedef struct {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 cameraPos;
+    vec4 lightPos;
+    vec4 lightColor;
+    float time;
+    float padding[3];
+} FrameUniforms;
+
+// Create the uniform buffer and bind it to SHADER_FRAME_DATA_BINDING
+void frame_uniforms_init(void);
+
+// Upload this frame's camera and light data (one buffer write for all programs)
+void frame_uniforms_update(const FrameUniforms* frame);
+
+// Release the uniform buffer
+void frame_uniforms_cleanup(void);
+
+#endif // FRAME_UNIFORMS_H
@@ -0,0 +1,61 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+
+// Texture units whose 2D texture and sampler bindings are tracked
+#define GL_STATE_TEXTURE_UNITS 16
+
+// Kinds of state change, for the counters
+typedef enum {
+    GL_STATE_PROGRAM,
+    GL_STATE_VERTEX_ARRAY,
+    GL_STATE_TEXTURE,
+    GL_STATE_SAMPLER,
+    GL_STATE_CAPABILITY,
+    GL_STATE_BLEND_FUNC,
+    GL_STATE_DEPTH_MASK,
+    GL_STATE_KIND_COUNT
+} GLStateKind;
+
+// Calls passed to GL and calls dropped as no-ops, per kind
+typedef struct {
+    int issued[GL_STATE_KIND_COUNT];
+    int skipped[GL_STATE_KIND_COUNT];
+} GLStateStats;
+
+// Shadow copy of the GL binding and pipeline state. Every program, vertex
+// array, texture and sampler bind in the engine goes through these setters,
+// which only call GL when the value differs from the shadow.
+
+// Forget everything, so the next set of each state reaches GL (call after
+// code outside the engine, e.g. a UI library, changed state directly)
+void gl_state_invalidate(void);
+
+void gl_state_use_program(GLuint program);
+void gl_state_bind_vertex_array(GLuint vao);
+
+// Bind texture to GL_TEXTURE_2D of unit (0-based), switching the active unit only if needed
+void gl_state_bind_texture(int unit, GLuint texture);
+
+// Bind a sampler object to unit (0 to use the texture's own parameters)
+void gl_state_bind_sampler(int unit, GLuint sampler);
+
+// glEnable/glDisable, shadowed for GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE,
+// GL_SCISSOR_TEST, GL_RASTERIZER_DISCARD and GL_PROGRAM_POINT_SIZE
+void gl_state_set_enabled(GLenum capability, bool enabled);
+
+void gl_state_blend_func(GLenum source, GLenum destination);
+void gl_state_depth_mask(bool write);
+
+// Delete objects, dropping them from the shadow (GL unbinds deleted names
+// and may hand them out again)
+void gl_state_delete_textures(GLsizei count, const GLuint* textures);
+void gl_state_delete_vertex_arrays(GLsizei count, const GLuint* vertexArrays);
+
+// Counters since the last reset (renderer_begin resets them every frame)
+GLStateStats gl_state_get_stats(void);
+void gl_state_reset_stats(void);
+
+#endif // GL_STATE_H
@@ -1,10 +1,22 @@
 #ifndef GLB_LOADER_H
 #define GLB_LOADER_H
 
-// Function to load a GLB file
-void loadGLB(const char* filename);
+#include "model.h"
+#include "shader.h"
 
-// Function to render the loaded GLB model
-void renderGLBModel();
+// Models kept by the filename-keyed GLB cache
+#define GLB_CACHE_SIZE 16
 
-#endif // GLB_LOADER_H 
\ No newline at end of file
+// Function to load a GLB file. Each file is uploaded once; loading it again
+// returns the cached model. The last model loaded is the one renderGLBModel
+// draws. Returns NULL if the file can't be loaded.
+Model* loadGLB(const char* filename);
+
+// Function to render the loaded GLB model with shader (basic.vert layout),
+// or a yellow cube if no model is loaded
+void renderGLBModel(Shader* shader);
+
+// Delete every cached model
+void cleanupGLB(void);
+
+#endif // GLB_LOADER_H
@@ -0,0 +1,56 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Maximum number of threads (including the main thread) the pool will start
+#define JOB_MAX_THREADS 64
+
+// A job processes the index range [begin, end) of whatever data it was given
+typedef void (*JobFunc)(void* data, int begin, int end);
+
+struct Job;
+
+// Tracks outstanding jobs. A stage waits on a counter, or other jobs can be
+// submitted "after" it so they only start once it reaches zero.
+typedef struct {
+    atomic_int pending;        // Jobs submitted against this counter and not yet finished
+    struct Job* waiters;       // Jobs deferred until pending reaches zero
+} JobCounter;
+
+// Start the pool. threadCount includes the main thread; 0 picks one thread
+// per hardware core, 1 runs every job inline on the caller (debug mode).
+bool job_system_init(int threadCount);
+
+// Stop and join all worker threads
+void job_system_shutdown(void);
+
+// Number of threads executing jobs (1 in single-threaded mode)
+int job_system_thread_count(void);
+
+// Index of the calling thread in [0, job_system_thread_count()); 0 is the main thread
+int job_system_worker_index(void);
+
+// Reset a counter before submitting against it
+void job_counter_init(JobCounter* counter);
+
+// Run func(data, 0, 1) once dependency (may be NULL) reaches zero
+void job_submit(JobCounter* counter, JobCounter* dependency, JobFunc func, void* data);
+
+// Run func(data, 0, 1) on a worker thread, never the main thread, so a
+// job_wait on the main thread can't pick up long work such as asset decodes.
+// Workers start background jobs in submission order, once they have nothing
+// else to run. Single-threaded mode runs it inline.
+void job_submit_background(JobCounter* counter, JobFunc func, void* data);
+
+// Split [0, count) into chunks of grainSize and run func on each chunk,
+// once dependency (may be NULL) reaches zero
+void job_parallel_for(JobCounter* counter, JobCounter* dependency, int count, int grainSize,
+                      JobFunc func, void* data);
+
+// Block until counter reaches zero, running queued jobs on this thread
+// meanwhile (background jobs only when called from a worker)
+void job_wait(JobCounter* counter);
+
+#endif // JOB_SYSTEM_H
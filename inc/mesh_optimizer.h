@@ -0,0 +1,59 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Post-transform cache size the reordering scores against (LRU, Forsyth)
+#define MESH_OPTIMIZER_CACHE_SIZE 32
+
+// FIFO cache size ACMR is reported for, typical of older and low-end GPUs
+#define MESH_OPTIMIZER_ANALYZE_CACHE_SIZE 16
+
+// ACMR an overdraw cluster may reach, relative to the run it was cut from
+#define MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+// Largest vertex count drawn with 16-bit indices
+#define MESH_OPTIMIZER_MAX_SHORT_VERTICES 65536
+
+// Give identical vertices (byte-equal across stride bytes) one index.
+// Fills remap[vertex] with the new index, in first-occurrence order, and
+// returns the number of unique vertices. indices may be NULL for an
+// unindexed list, where vertex i is the i-th corner.
+size_t mesh_generate_remap(uint32_t* remap, const uint32_t* indices, size_t indexCount,
+                           const void* vertices, size_t vertexCount, size_t stride);
+
+// Apply a remap from mesh_generate_remap or mesh_optimize_vertex_fetch
+void mesh_remap_indices(uint32_t* indices, size_t indexCount, const uint32_t* remap);
+void mesh_remap_vertices(void* destination, const void* vertices, size_t vertexCount,
+                         size_t stride, const uint32_t* remap);
+
+// Reorder a triangle list for the post-transform vertex cache (Forsyth's
+// linear-speed algorithm). destination may alias indices.
+void mesh_optimize_vertex_cache(uint32_t* destination, const uint32_t* indices,
+                                size_t indexCount, size_t vertexCount);
+
+// Reorder the clusters of a cache-optimized list so outward-facing ones draw
+// first and occlude the rest (Tipsify's overdraw pass). Clusters are cut
+// where each one's cold-cache ACMR stays within threshold (e.g. 1.05) of
+// the run it came from; the sort can still cost a little ACMR overall.
+// positions are xyz floats at positionStride bytes. destination may alias
+// indices.
+void mesh_optimize_overdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+                            const float* positions, size_t vertexCount, size_t positionStride,
+                            float threshold);
+
+// Number vertices in the order the indices first use them, so fetches walk
+// the buffer forwards. Fills remap like mesh_generate_remap; unreferenced
+// vertices map to UINT32_MAX. Returns the referenced vertex count.
+size_t mesh_optimize_vertex_fetch(uint32_t* remap, const uint32_t* indices, size_t indexCount,
+                                  size_t vertexCount);
+
+// Average cache miss ratio (vertex shader runs per triangle) of a triangle
+// list on a FIFO cache of cacheSize entries. 0.5 is ideal for a large grid,
+// 3 means no reuse at all.
+float mesh_analyze_acmr(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                        int cacheSize);
+
+#endif // MESH_OPTIMIZER_H
@@ -2,33 +2,46 @@
 #define MODEL_H
 
 #include <glad/glad.h>
-#include "cgltf.h"
+#include <stddef.h>
 #include "shader.h"
+#include "asset_loader.h"
 
+// One glTF primitive, drawn with a single call
 typedef struct {
-    unsigned int VAO, VBO, EBO;
+    unsigned int VAO;
+    GLenum mode;               // GL primitive type
+    GLenum indexType;          // GL_UNSIGNED_SHORT/INT, or 0 to draw without indices
+    size_t indexOffset;        // Byte offset of the first index in the element buffer
+    int count;                 // Indices, or vertices when not indexed
+    bool hasNormals;           // Without them the shader sees a constant up normal
+    bool hasTexCoords;
     unsigned int texture;
-    int vertexCount;
-    int indexCount;
-    float* vertices;
-    unsigned int* indices;
     vec3 color;
     bool hasTexture;
 } Mesh;
 
 typedef struct {
-    Mesh* meshes;
+    Mesh* meshes;              // Every primitive of every glTF mesh
     int meshCount;
-    cgltf_data* data;
+    unsigned int* buffers;     // GL buffers the meshes read from (shared between them)
+    int bufferCount;
+    long long gpuBytes;        // Vertex and index data resident on the GPU
 } Model;
 
-// Load a model from a GLB file
+// Load a model from a GLB (or glTF) file. The file is memory-mapped;
+// triangle lists are deduplicated and reordered for the vertex cache and
+// overdraw (see mesh_optimizer.h), other primitives go from the binary chunk
+// straight into GL buffers. Nothing stays on the CPU afterwards.
 void model_load(Model* model, const char* filename);
 
+// Parse the file on the job system and create its GL objects in a later
+// asset_loader_pump. model must stay alive until state leaves LOADING.
+void model_load_async(Model* model, const char* filename, AssetState* state);
+
 // Render the model using the specified shader
 void model_render(Model* model, Shader* shader);
 
 // Clean up model resources
 void model_cleanup(Model* model);
 
-#endif 
\ No newline at end of file
+#endif
@@ -0,0 +1,59 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <stdbool.h>
+#include <cglm/cglm.h>
+
+// Particles the ring holds unless particles_init is given another size
+#define PARTICLES_DEFAULT_CAPACITY 262144
+
+// Emitters one update pass can start; the rest wait for the next frame.
+// Must match MAX_EMITTERS in particle_update.vert.
+#define PARTICLES_MAX_EMITTERS 64
+
+// Emitters waiting for an update pass; later ones are dropped
+#define PARTICLES_QUEUE_CAPACITY 1024
+
+// Effects an emitter can produce
+typedef enum {
+    PARTICLE_EFFECT_HIT,      // Short spray from a projectile hit
+    PARTICLE_EFFECT_DEATH,    // Rainbow burst where an enemy died
+    PARTICLE_EFFECT_SLASH,    // Fan of sparks along a sword swing
+    PARTICLE_EFFECT_SPIN,     // Golden sparks as the daggers start orbiting
+    PARTICLE_EFFECT_COUNT
+} ParticleEffect;
+
+// Work done by the last update
+typedef struct {
+    int capacity;          // Slots in the ring
+    int simulated;         // Slots run through transform feedback
+    int spawned;           // Particles started
+    int emitters;          // Emitters started
+    int pendingEmitters;   // Emitters left for later frames
+} ParticleStats;
+
+// GPU particles. Each frame one transform feedback pass reads every particle
+// from one buffer and writes it, a step later, to the other. Emitters claim
+// runs of slots in a ring and the update shader seeds the particles in them,
+// so nothing but a few uniforms goes over the bus. Needs a GL 3.3 context.
+bool particles_init(int capacity);
+
+// Queue an effect at position. direction (may be NULL) aims effects that
+// have one, like the slash.
+void particles_emit(ParticleEffect effect, const vec3 position, const vec3 direction);
+
+// Start the queued emitters and advance every particle by deltaTime
+void particles_update(float deltaTime);
+
+// Queue the particles with the render queue as one additive draw of point
+// sprites. eye is the camera position; the cloud sorts there, after every
+// sprite, and the depth test still hides it behind them.
+void particles_render(const vec3 eye, float viewportHeight);
+
+// Counters for the last update
+ParticleStats particles_get_stats(void);
+
+// Release the buffers and shaders
+void particles_cleanup(void);
+
+#endif // PARTICLES_H
@@ -0,0 +1,27 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include <stdbool.h>
+
+// Height of the ground plane the player stands on
+#define GROUND_LEVEL 0.5f
+
+// Vertical motion constants (applied once per tick)
+#define PHYSICS_GRAVITY 0.008f
+#define PHYSICS_JUMP_FORCE 0.12f
+
+// Position and vertical motion of a body that walks on the ground plane
+typedef struct {
+    float x, y, z;     // Position
+    float velocityY;   // Vertical velocity for jumping
+    bool isGrounded;   // Whether the body is standing on the ground
+} PhysicsBody;
+
+// Place a grounded body at rest
+void physics_body_init(PhysicsBody* body, float x, float y, float z);
+
+// Start a jump if grounded, otherwise apply gravity and land on the ground.
+// Returns true while the body is in the air this tick.
+bool physics_update_jump(PhysicsBody* body, bool jumpPressed);
+
+#endif // PHYSICS_H
@@ -0,0 +1,60 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+// Scoped CPU profiler writing Chrome trace / Perfetto JSON.
+//
+// Zones are recorded only when PROFILER_ENABLED is defined (CMake option
+// PLATFORMER_PROFILER); otherwise every macro below compiles to nothing.
+// Each thread records into its own ring buffer, so recording takes no
+// locks and only the most recent PROFILER_RING_SIZE zones per thread are kept.
+//
+//   PROFILE_SCOPE("renderWorld") {
+//       ...
+//   }
+//
+// Don't break, goto or return out of a PROFILE_SCOPE body: the zone would
+// stay open. Use PROFILE_BEGIN/PROFILE_END around code with early exits.
+
+// Zones kept per thread (power of two)
+#define PROFILER_RING_SIZE 32768
+
+// Deepest zone nesting tracked per thread
+#define PROFILER_MAX_DEPTH 32
+
+// Maximum number of threads that can record zones
+#define PROFILER_MAX_THREADS 64
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_BEGIN(name) profiler_begin(name)
+#define PROFILE_END() profiler_end()
+#define PROFILE_THREAD_NAME(name) profiler_set_thread_name(name)
+#else
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
+
+// Runs the statement or block that follows inside a zone named name
+#define PROFILE_SCOPE(name) \
+    for (int profileScopeOnce_ = (PROFILE_BEGIN(name), 1); profileScopeOnce_; \
+         profileScopeOnce_ = 0, PROFILE_END())
+
+// Open a zone on the calling thread. name must outlive the profiler (use literals)
+void profiler_begin(const char* name);
+
+// Close the innermost open zone on the calling thread
+void profiler_end(void);
+
+// Label the calling thread in the trace (copied)
+void profiler_set_thread_name(const char* name);
+
+// Write every thread's recorded zones to path as Chrome trace JSON.
+// Zones still being recorded while this runs may be missing from the file.
+bool profiler_write_trace(const char* path);
+
+// Free all thread buffers. Call once no other thread is recording
+void profiler_shutdown(void);
+
+#endif // PROFILER_H
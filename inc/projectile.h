@@ -1,20 +1,21 @@
 #ifndef PROJECTILE_H
 #define PROJECTILE_H
 
-#include <cglm/cglm.h>
-#include "shader.h"
+#include <stdbool.h>
+#include "job_system.h"
 
 #define MAX_PROJECTILES 32
 
 typedef struct {
     float x, y, z;         // Position
+    float prevX, prevY, prevZ; // Position before the last tick (render interpolation)
+    float prevRotation;    // Rotation before the last tick
     float velocityX, velocityZ; // Velocity (2D movement)
     float rotation;        // Rotation angle in radians
     float scale;           // Scale factor
     float lifetime;        // How long the projectile lives
     float maxLifetime;     // Maximum lifetime
     bool active;           // Whether the projectile is active
-    unsigned int textureID; // Texture ID for the projectile
     bool orbitMode;        // Whether the projectile is in orbit mode
     float orbitAngle;      // Angle in the orbit
     float orbitCenterX;    // X coordinate of orbit center
@@ -31,8 +32,8 @@ void spawn_projectile(float x, float y, float z, float dirX, float dirZ, float s
 // Update all projectiles
 void update_projectiles(float deltaTime);
 
-// Render all projectiles
-void render_projectiles(Shader* shader);
+// Start updating all projectiles as jobs; finished when counter reaches zero
+void update_projectiles_async(float deltaTime, JobCounter* counter);
 
 // Clean up projectile resources
 void projectile_system_cleanup(void);
@@ -43,4 +44,7 @@ void update_orbit_center(float x, float z);
 bool check_projectile_collision(float x, float z, float radius);
 void handle_projectile_collision(int projectileIndex);
 
+// Read-only access to the projectile slots (MAX_PROJECTILES entries, check .active)
+const Projectile* get_projectiles(void);
+
 #endif // PROJECTILE_H 
\ No newline at end of file
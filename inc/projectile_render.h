@@ -0,0 +1,16 @@
+#ifndef PROJECTILE_RENDER_H
+#define PROJECTILE_RENDER_H
+
+#include "shader.h"
+
+// Load the dagger texture (needs a GL context)
+void projectile_render_init(void);
+
+// Queue the projectiles inside the frame's frustum with the batch renderer, alpha in [0, 1] blending
+// the previous and current tick
+void render_projectiles(Shader* shader, float alpha);
+
+// Release the dagger texture
+void projectile_render_cleanup(void);
+
+#endif // PROJECTILE_RENDER_H
@@ -0,0 +1,110 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <glad/glad.h>
+#include <cglm/cglm.h>
+#include <stdint.h>
+#include "shader.h"
+#include "sampler.h"
+
+// Most quads one draw call covers: 4 vertices per quad keeps every index
+// within 16 bits. Longer runs draw in several calls from a base vertex.
+#define RENDERER_MAX_QUADS 8192
+
+// Draw items (quads included) the queue holds before its arrays first grow
+#define RENDERER_INITIAL_ITEMS 16384
+
+// Most draw items one frame can queue, set by the index field of a sort key
+#define RENDERER_MAX_ITEMS (1 << 20)
+
+// View distance mapped onto the depth bits of a sort key; farther items
+// sort as if they were at this distance
+#define RENDERER_MAX_DEPTH 256.0f
+
+// Vertex layout of a batched quad (attribute 0 position, 1 uv, 2 color)
+typedef struct {
+    float x, y, z;
+    float u, v;
+    unsigned char color[4];   // RGBA, normalized in the shader
+} RendererVertex;
+
+// Passes of a frame, drawn in this order
+typedef enum {
+    RENDER_LAYER_OPAQUE,        // Depth-writing scenery, by state then front to back
+    RENDER_LAYER_TRANSPARENT,   // Blended sprites, back to front in one pass
+    RENDER_LAYER_OVERLAY,       // Screen-space items in submission order
+    RENDER_LAYER_COUNT
+} RenderLayer;
+
+typedef enum {
+    RENDER_BLEND_OPAQUE,          // Blending off
+    RENDER_BLEND_PREMULTIPLIED,   // GL_ONE, GL_ONE_MINUS_SRC_ALPHA (every sprite texture)
+    RENDER_BLEND_ADDITIVE,        // GL_ONE, GL_ONE
+    RENDER_BLEND_COUNT
+} RenderBlend;
+
+// Issues an item's draw call. The queue has already bound the item's shader,
+// texture and sampler (unit 0), vertex array and blend state; set uniforms and draw.
+typedef void (*RenderDrawFunc)(void* data);
+
+// One draw pushed by a system
+typedef struct {
+    RenderLayer layer;
+    RenderBlend blend;
+    Shader* shader;
+    unsigned int textureID;   // 0 to leave unit 0 as it is
+    SamplerKind sampler;      // Filtering for textureID
+    unsigned int vao;
+    vec3 position;            // Sorting point, in world space (ignored for overlays)
+    RenderDrawFunc draw;
+    void* data;               // Must stay valid until the flush
+} RenderItem;
+
+// Work done by the last flushed frame
+typedef struct {
+    int itemCount;
+    int quadCount;
+    int drawCalls;
+    int shaderChanges;
+    int textureChanges;
+} RendererStats;
+
+// Create the streamed vertex buffer and the shared quad index buffer
+void renderer_init(void);
+
+// Start collecting draws for a new frame seen through view (for depth sorting)
+void renderer_begin(mat4 view);
+
+// Queue a draw item
+void renderer_submit(const RenderItem* item);
+
+// Distance of a world-space point in front of this frame's camera
+float renderer_view_depth(const vec3 position);
+
+// Queue a unit quad ([-0.5, 0.5] in X and Y) transformed by model as a
+// transparent, premultiplied sprite sampling textureID through sampler.
+// uvRect is (u0, v0, u1, v1) with (u0, v0) at the top-left corner; swap the
+// pairs to flip. color multiplies the texture (NULL for opaque white).
+void renderer_submit_quad(Shader* shader, unsigned int textureID, SamplerKind sampler, mat4 model,
+                          const vec4 uvRect, const vec4 color);
+
+// Radix sort the queued items by key and draw them. Adjacent quads sharing
+// shader, texture and sampler go out in one call; redundant GL state
+// changes are filtered by gl_state.
+void renderer_flush(void);
+
+// Counters for the most recent frame
+RendererStats renderer_get_stats(void);
+
+// Sort count keys ascending, least significant byte first (stable), using
+// scratch as a buffer of the same size
+void renderer_sort_keys(uint64_t* keys, uint64_t* scratch, int count);
+
+// Index buffer holding RENDERER_MAX_QUADS quads as 16-bit indices
+// (0,1,2, 2,3,0 per quad), for other systems that draw quads
+unsigned int renderer_quad_index_buffer(void);
+
+// Release the buffers
+void renderer_cleanup(void);
+
+#endif // RENDERER_H
@@ -0,0 +1,28 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <glad/glad.h>
+
+// Named sampler objects, created once. Bound per texture unit, they decide
+// filtering and wrapping, so textures never need their parameters changed
+// at draw time.
+typedef enum {
+    SAMPLER_NONE,                  // Sampler 0: the texture's own parameters
+    SAMPLER_PIXEL_ART,             // Nearest, clamped, base level only (single sprites)
+    SAMPLER_PIXEL_ART_MIPMAPPED,   // Nearest within and between levels, clamped (sprite atlases)
+    SAMPLER_LINEAR_REPEAT,         // Bilinear, repeating, base level only
+    SAMPLER_LINEAR_CLAMP,          // Bilinear, clamped, base level only (glyph atlases)
+    SAMPLER_MIPMAPPED,             // Trilinear, repeating (model textures)
+    SAMPLER_COUNT
+} SamplerKind;
+
+// Create the sampler objects (needs a GL context)
+void sampler_init(void);
+
+// GL name of a sampler (0 for SAMPLER_NONE)
+GLuint sampler_get(SamplerKind kind);
+
+// Delete the sampler objects
+void sampler_cleanup(void);
+
+#endif // SAMPLER_H
@@ -4,17 +4,68 @@
 #include <glad/glad.h>
 #include <cglm/cglm.h>
 
+// Uniform block holding per-frame camera and light data (see frame_uniforms.h),
+// and the binding point every program reads it from
+#define SHADER_FRAME_DATA_BLOCK "FrameData"
+#define SHADER_FRAME_DATA_BINDING 0
+
+// Slots in a shader's uniform table (power of two, more than any program uses)
+#define SHADER_UNIFORM_TABLE_SIZE 64
+
+// Longest uniform name kept in the table, including the terminator. Longer
+// names are rejected with a warning when the program links.
+#define SHADER_UNIFORM_NAME_LENGTH 48
+
+// Largest value cached for redundant-upload checks (a mat4)
+#define SHADER_UNIFORM_VALUE_SIZE (16 * sizeof(float))
+
+// One active uniform, resolved once when the program is linked
+typedef struct {
+    char name[SHADER_UNIFORM_NAME_LENGTH];    // Empty for an unused slot
+    unsigned int nameHash;
+    int location;
+    bool hasValue;                            // value holds the last upload
+    unsigned char value[SHADER_UNIFORM_VALUE_SIZE];
+} ShaderUniform;
+
 typedef struct {
     unsigned int ID;
+    ShaderUniform uniforms[SHADER_UNIFORM_TABLE_SIZE];  // Open-addressed by name hash
+    int uniformCount;
 } Shader;
 
 // Initialize shader from vertex and fragment shader files
 void shader_init(Shader* shader, const char* vertexPath, const char* fragmentPath);
 
+// Initialize a vertex-only program whose outputs named in varyings are
+// written, interleaved in that order, to the transform feedback buffer
+// bound at index 0 (draw with GL_RASTERIZER_DISCARD enabled)
+void shader_init_feedback(Shader* shader, const char* vertexPath, const char* const* varyings,
+                          int varyingCount);
+
 // Use the shader program
 void shader_use(Shader* shader);
 
-// Utility uniform functions
+// Delete the program
+void shader_cleanup(Shader* shader);
+
+// Handle of an active uniform, or -1 if the program has no such uniform.
+// Resolve once and pass to the shader_uniform_* setters.
+int shader_uniform(const Shader* shader, const char* name);
+
+// Upload through a handle. The program must be in use; uploads of the value
+// a uniform already holds are skipped.
+void shader_uniform_bool(Shader* shader, int uniform, bool value);
+void shader_uniform_int(Shader* shader, int uniform, int value);
+void shader_uniform_float(Shader* shader, int uniform, float value);
+void shader_uniform_vec3(Shader* shader, int uniform, vec3 value);
+void shader_uniform_mat4(Shader* shader, int uniform, mat4 value);
+
+// Upload count elements of a uniform array (always reaches GL)
+void shader_uniform_vec4v(Shader* shader, int uniform, int count, const float* values);
+void shader_uniform_ivec2v(Shader* shader, int uniform, int count, const int* values);
+
+// Utility uniform functions (look the name up in the uniform table)
 void shader_set_bool(Shader* shader, const char* name, bool value);
 void shader_set_int(Shader* shader, const char* name, int value);
 void shader_set_float(Shader* shader, const char* name, float value);
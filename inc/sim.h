@@ -0,0 +1,83 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "physics.h"
+#include "wave.h"
+#include "sim_events.h"
+
+// Player commands for one simulation tick, already decoded from the
+// controller (or a script). Movement is zero inside the stick deadzone.
+typedef struct {
+    float moveX, moveZ;   // Stick direction
+    bool jump;            // Jump button held
+    bool attack;          // Sword attack button held
+    bool spinAttack;      // Spinning dagger button held
+    bool startWave;       // Start-wave button pressed this tick
+} SimInput;
+
+// Which attack (if any) the player started this tick
+typedef enum {
+    SIM_ATTACK_NONE,
+    SIM_ATTACK_SWORD,
+    SIM_ATTACK_SPIN
+} SimAttack;
+
+// Simulated player state plus what happened to it this tick
+typedef struct {
+    PhysicsBody body;         // Position and jump state
+    float prevX, prevY, prevZ; // Position before the last tick (render interpolation)
+    float attackCooldown;     // Seconds until the next attack is allowed
+    float direction;          // Facing angle in radians (0 = facing +X)
+    bool facingRight;         // Sprite facing
+    bool isMoving;            // Moved this tick
+    bool isJumping;           // In the air this tick
+    SimAttack attack;         // Attack started this tick
+} SimPlayer;
+
+// Stages of one tick, timed separately
+typedef enum {
+    SIM_STAGE_PLAYER,      // Player movement, jump and attacks
+    SIM_STAGE_INTEGRATE,   // Projectile and enemy integration jobs
+    SIM_STAGE_COLLIDE,     // Enemy-projectile collision jobs
+    SIM_STAGE_CLEANUP,     // Orbit follow and dead enemy sweep
+    SIM_STAGE_WAVES,       // Wave timers and spawning
+    SIM_STAGE_COUNT
+} SimStage;
+
+// Wall-clock nanoseconds spent in each stage during the last tick
+typedef struct {
+    uint64_t stageNs[SIM_STAGE_COUNT];
+    uint64_t totalNs;
+} SimTimings;
+
+// Initialize the player, projectiles, enemies and waves (no GL needed)
+void sim_init(void);
+
+// Release simulation state
+void sim_cleanup(void);
+
+// Run the player stage and start the parallel part of the tick. The caller
+// may do unrelated main-thread work before calling sim_tick_end.
+void sim_tick_begin(const SimInput* input, float deltaTime);
+
+// Wait for the parallel part of the tick, then sweep the dead and run waves
+void sim_tick_end(void);
+
+// sim_tick_begin followed by sim_tick_end
+void sim_tick(const SimInput* input, float deltaTime);
+
+// Current player state
+const SimPlayer* sim_get_player(void);
+
+// Current wave state
+const WaveState* sim_get_waves(void);
+
+// Stage timings of the last completed tick
+const SimTimings* sim_get_timings(void);
+
+// Short name of a stage for reports
+const char* sim_stage_name(SimStage stage);
+
+#endif // SIM_H
@@ -0,0 +1,34 @@
+#ifndef SIM_EVENTS_H
+#define SIM_EVENTS_H
+
+// Most events one tick records; later ones are dropped and counted
+#define SIM_EVENTS_CAPACITY 4096
+
+// Gameplay moments the presentation side reacts to (effects, damage numbers)
+typedef enum {
+    SIM_EVENT_ENEMY_HIT,      // value: damage dealt
+    SIM_EVENT_ENEMY_KILLED,
+    SIM_EVENT_SWORD_SLASH,    // value: facing, +1 right or -1 left
+    SIM_EVENT_SPIN_ATTACK,
+    SIM_EVENT_TYPE_COUNT
+} SimEventType;
+
+typedef struct {
+    SimEventType type;
+    float x, y, z;            // Where it happened
+    float value;              // Meaning depends on type
+} SimEvent;
+
+// Log of what happened during the current tick. sim_tick_begin clears it;
+// the player stage, the collision resolve job and the cleanup stage append
+// to it, and never run at the same time.
+void sim_events_clear(void);
+void sim_events_push(SimEventType type, float x, float y, float z, float value);
+
+// Events of the last tick, in the order they happened
+const SimEvent* sim_events_get(int* count);
+
+// Events that did not fit during the last tick
+int sim_events_dropped(void);
+
+#endif // SIM_EVENTS_H
@@ -0,0 +1,60 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <stdbool.h>
+
+// Default cell edge length in world units (about two enemy diameters)
+#define SPATIAL_HASH_DEFAULT_CELL_SIZE 1.0f
+
+// One overlapping pair reported by a query
+typedef struct {
+    int queryIndex;    // Caller-supplied id of the query shape (e.g. projectile slot)
+    int itemIndex;     // Index of the overlapping item in the arrays passed to build
+} Contact;
+
+// Growable list of contacts, reused across ticks
+typedef struct {
+    Contact* contacts;
+    int count;
+    int capacity;
+} ContactList;
+
+// Uniform grid over the XZ plane, hashed into a power-of-two bucket table.
+// Rebuilt from scratch every tick with a counting sort, so items in one
+// bucket are contiguous in itemIndices.
+typedef struct {
+    float cellSize;
+    float invCellSize;
+    int bucketCount;       // Power of two
+    int* bucketStart;      // bucketCount + 1 offsets into itemIndices
+    int* itemIndices;      // Item indices grouped by bucket
+    int* itemBucket;       // Scratch: bucket of each item
+    int itemCapacity;
+    int itemCount;
+    float maxItemRadius;   // Largest item radius seen in the last build
+    const float* itemX;    // Arrays from the last build (not owned)
+    const float* itemZ;
+    const float* itemRadius;
+} SpatialHash;
+
+// Initialize an empty hash with the given cell size
+void spatial_hash_init(SpatialHash* hash, float cellSize);
+
+// Rebuild the hash from item positions and radii. The arrays must stay
+// valid and unchanged until the queries for this build are done.
+bool spatial_hash_build(SpatialHash* hash, const float* x, const float* z, const float* radius, int count);
+
+// Report every item overlapping the circle (x, z, radius) into contacts,
+// tagged with queryIndex. Returns the number of contacts added.
+int spatial_hash_query_circle(const SpatialHash* hash, float x, float z, float radius,
+                              int queryIndex, ContactList* contacts);
+
+// Release the hash tables
+void spatial_hash_free(SpatialHash* hash);
+
+// Contact list helpers
+void contact_list_clear(ContactList* list);
+bool contact_list_push(ContactList* list, int queryIndex, int itemIndex);
+void contact_list_free(ContactList* list);
+
+#endif // SPATIAL_HASH_H
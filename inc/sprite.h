@@ -9,7 +9,8 @@
 #define MAX_FRAMES 16
 
 typedef struct {
-    unsigned int* textureIDs;  // Array of texture IDs for animation frames
+    unsigned int textureID;    // Texture holding every frame (usually a sprite atlas)
+    const vec4* frameUVs;      // Per-frame (u0, v0, u1, v1) rect in textureID, not owned
     int frameCount;            // Number of frames in the animation
     int currentFrame;          // Current frame index
     float frameDuration;       // Duration of each frame in seconds
@@ -19,28 +20,23 @@ typedef struct {
     // Add these fields to track sprite dimensions if they're not already there
     float width;               // Width of the sprite
     float height;              // Height of the sprite
-    unsigned int VAO;
-    unsigned int VBO;
-    unsigned int EBO;
 } Sprite;
 
-// Initialize a sprite with animation frames
-void sprite_init(Sprite* sprite, const char** texturePaths, int frameCount, float frameDuration, bool loop);
-
-// Initialize a sprite with a pre-created texture
-void sprite_init_with_texture(Sprite* sprite, const char** texturePaths, int frameCount, 
-                             float frameTime, bool loop, unsigned int textureID);
+// Initialize a sprite whose frames are UV rects in one texture. frameUVs must
+// outlive the sprite (it normally points into a SpriteAtlas).
+void sprite_init(Sprite* sprite, unsigned int textureID, const vec4* frameUVs, int frameCount,
+                 float frameDuration, bool loop);
 
 // Update sprite animation
 void sprite_update(Sprite* sprite, float deltaTime);
 
-// Render sprite at position with scale
+// Queue the sprite's current frame with the batch renderer at position with scale
 void sprite_render(Sprite* sprite, Shader* shader, vec3 position, float scale);
 
 // Render sprite with bottom at ground level
 void sprite_render_grounded(Sprite* sprite, Shader* shader, vec3 position, float scale);
 
-// Clean up sprite resources
+// Detach the sprite from its frames (the texture is not deleted)
 void sprite_cleanup(Sprite* sprite);
 
 #endif // SPRITE_H 
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef SPRITE_ATLAS_H
+#define SPRITE_ATLAS_H
+
+#include <glad/glad.h>
+#include <cglm/cglm.h>
+#include <stdbool.h>
+#include "asset_pack.h"
+#include "atlas_packer.h"
+
+// Several image files packed into one premultiplied-alpha texture
+typedef struct {
+    unsigned int textureID;
+    int width;
+    int height;
+    int frameCount;
+    vec4* frameUVs;        // Per-frame (u0, v0, u1, v1), (u0, v0) at the top-left
+    int* frameWidths;      // Source image sizes in pixels (0 if the file failed to load)
+    int* frameHeights;
+    long long residentBytes;  // VRAM of the page and its mips, counted in texture_get_stats
+} SpriteAtlas;
+
+// Decoded and packed images waiting for their GL upload
+typedef struct {
+    AtlasImage* images;    // Source images with their page positions
+    int imageCount;
+    AtlasPage page;
+} SpriteAtlasSource;
+
+// Decode every image in paths on background jobs and pack them into one page
+// of at most maxSize pixels. Makes no GL calls, so it can run on a worker.
+// Frames keep the order of paths. Returns false if nothing loaded.
+bool sprite_atlas_decode(SpriteAtlasSource* source, const char* const* paths, int pathCount, int maxSize);
+
+// Create the texture and frame table from a decoded source (needs a GL
+// context), then free the source
+bool sprite_atlas_upload(SpriteAtlas* atlas, SpriteAtlasSource* source);
+
+// Free a decoded source that won't be uploaded
+void sprite_atlas_source_free(SpriteAtlasSource* source);
+
+// Upload the atlas page and frame table of a cooked pack as-is (needs a GL
+// context). The pack can be closed afterwards.
+bool sprite_atlas_load_pack(SpriteAtlas* atlas, const AssetPack* pack);
+
+// Release the texture and frame tables
+void sprite_atlas_free(SpriteAtlas* atlas);
+
+#endif // SPRITE_ATLAS_H
@@ -0,0 +1,71 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <stdbool.h>
+#include <cglm/cglm.h>
+
+// Fonts that can be loaded at once
+#define TEXT_MAX_FONTS 4
+
+// First and last character baked into a font's atlas (printable ASCII)
+#define TEXT_FIRST_CHAR 32
+#define TEXT_LAST_CHAR 126
+
+// Size of a font's single-channel glyph atlas in pixels
+#define TEXT_ATLAS_SIZE 512
+
+// Glyphs one font can draw per frame; later ones are dropped
+#define TEXT_MAX_GLYPHS 32768
+
+// Damage numbers alive at once. When the ring is full a new number
+// replaces the oldest.
+#define TEXT_MAX_DAMAGE_NUMBERS 4096
+
+// Seconds a damage number floats before it is gone
+#define TEXT_DAMAGE_LIFETIME 0.9f
+
+// Work done by the last text_render
+typedef struct {
+    int glyphs;            // Glyph quads uploaded, all fonts
+    int droppedGlyphs;     // Glyphs over TEXT_MAX_GLYPHS
+    int damageNumbers;     // Live damage numbers
+    int visibleNumbers;    // Damage numbers inside the frustum
+    int drawCalls;         // One per font with glyphs
+} TextStats;
+
+// Text drawn as instanced glyph quads from a glyph atlas baked once per
+// font with stb_truetype. Everything a font shows in a frame, world-anchored
+// damage numbers and screen-space HUD alike, goes out in one instanced draw
+// on the overlay layer. Needs a GL context.
+void text_init(void);
+
+// Bake a TrueType font at pixelHeight. Returns its handle, or -1 if the file
+// is missing or the atlas is too small (text drawn with -1 is skipped).
+int text_font_load(const char* path, float pixelHeight);
+
+// Start a damage number over a world position. Allocation-free.
+void text_spawn_damage(int font, const vec3 position, float amount);
+
+// Age and lift the damage numbers
+void text_update(float deltaTime);
+
+// Queue a string for this frame. Screen text is placed by its top-left
+// corner in pixels from the top-left of the viewport; world text is
+// centered above position. pixelSize is the line height on screen.
+void text_draw_screen(int font, float x, float y, float pixelSize, const vec4 color, const char* string);
+void text_draw_world(int font, const vec3 position, float pixelSize, const vec4 color, const char* string);
+
+// Width in pixels of a string drawn at pixelSize
+float text_measure(int font, float pixelSize, const char* string);
+
+// Lay out the live damage numbers inside the frame's frustum (culling_begin),
+// upload every font's glyphs and queue one overlay item per font
+void text_render(float viewportWidth, float viewportHeight);
+
+// Counters for the last text_render
+TextStats text_get_stats(void);
+
+// Release the fonts, buffers and shader
+void text_cleanup(void);
+
+#endif // TEXT_H
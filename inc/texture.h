@@ -2,6 +2,7 @@
 #define TEXTURE_H
 
 #include <glad/glad.h>
+#include "asset_loader.h"
 
 // Function to load a BMP texture
 unsigned int texture_load_bmp(const char* path);
@@ -20,4 +21,38 @@ unsigned int create_test_texture();
 // Add this declaration if it's missing from texture.h
 unsigned int texture_load(const char* path);
 
+// Slots in the path-keyed texture cache (power of two)
+#define TEXTURE_CACHE_SIZE 256
+
+// Texture memory currently held on the GPU
+typedef struct {
+    int cachedTextures;        // Distinct files resident through texture_acquire
+    int references;            // Outstanding texture_acquire calls
+    long long residentBytes;   // Cached textures plus externally accounted ones (mips included)
+    int hits;                  // Acquires served without decoding
+    int loads;                 // Acquires that decoded a file
+} TextureStats;
+
+// Load a texture once per path and return it with one more reference.
+// Returns 0 if the file can't be loaded.
+unsigned int texture_acquire(const char* path);
+
+// Same as texture_acquire, but the file is decoded on the job system. The
+// returned name holds a transparent 1x1 placeholder until asset_loader_pump
+// uploads the image; texture_get_state reports when that has happened.
+unsigned int texture_acquire_async(const char* path);
+
+// Load state of a cached texture (READY for textures made outside the cache)
+AssetState texture_get_state(unsigned int textureID);
+
+// Drop a reference taken by texture_acquire(_async); the texture is deleted with the last one
+void texture_release(unsigned int textureID);
+
+// Add (or with a negative delta, remove) VRAM used by textures created
+// outside the cache, such as sprite atlases, to the resident total
+void texture_account_bytes(long long delta);
+
+// Current cache counters
+TextureStats texture_get_stats(void);
+
 #endif // TEXTURE_H 
\ No newline at end of file
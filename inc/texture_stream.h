@@ -0,0 +1,40 @@
+#ifndef TEXTURE_STREAM_H
+#define TEXTURE_STREAM_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Bytes in the pixel unpack ring. Larger images upload directly.
+#define TEXTURE_STREAM_RING_BYTES (8u * 1024u * 1024u)
+
+// Uploads still tracked by a fence (power of two)
+#define TEXTURE_STREAM_MAX_IN_FLIGHT 64
+
+// A region of the ring mapped for one image
+typedef struct {
+    unsigned char* pixels;   // Write the image here, first row first (write-only memory)
+    size_t offset;
+    size_t size;
+} TextureStreamUpload;
+
+// Map size bytes of the ring for writing. Space still being read by the GPU
+// is waited on first (normally it has long finished). Returns false, leaving
+// nothing mapped, if size doesn't fit the ring; upload from client memory then.
+bool texture_stream_begin(TextureStreamUpload* upload, size_t size);
+
+// Unmap the region and copy it into level of the texture bound to
+// GL_TEXTURE_2D with glTexSubImage2D. The texture's storage must already
+// exist; the copy runs asynchronously and is fenced.
+void texture_stream_end(TextureStreamUpload* upload, int level, int width, int height,
+                        GLenum format, GLenum type);
+
+// Allocate level of the bound texture and stream pixels into it, falling
+// back to a plain glTexImage2D when the ring is too small
+void texture_stream_image(int level, GLint internalFormat, int width, int height,
+                          GLenum format, const unsigned char* pixels);
+
+// Wait for in-flight uploads and delete the ring
+void texture_stream_cleanup(void);
+
+#endif // TEXTURE_STREAM_H
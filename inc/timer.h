@@ -0,0 +1,12 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+// Monotonic high-resolution clock in nanoseconds (no GLFW required)
+uint64_t timer_now_ns(void);
+
+// Monotonic high-resolution clock in seconds
+double timer_now_seconds(void);
+
+#endif // TIMER_H
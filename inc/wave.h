@@ -0,0 +1,26 @@
+#ifndef WAVE_H
+#define WAVE_H
+
+#include <stdbool.h>
+
+// Half-extent of the arena; enemies enter from its edges (matches the ground grid)
+#define WAVE_ARENA_HALF_SIZE 20.0f
+
+// Wave progression: a wave is started on request, spawns its enemies in
+// timed batches from random arena edges and ends once they are all dead.
+typedef struct {
+    int waveNumber;               // Current (or last finished) wave, 0 before the first
+    int enemiesRemainingInWave;   // Enemies of this wave not spawned yet
+    float spawnTimer;             // Seconds until the next batch
+    float cooldown;               // Seconds until another wave may start
+    bool inProgress;              // Whether a wave is running
+} WaveState;
+
+// Reset to "no wave started yet"
+void wave_init(WaveState* wave);
+
+// Advance timers, start a wave if requested and allowed, spawn the next
+// batch when due and detect completion. Returns the number of enemies spawned.
+int wave_update(WaveState* wave, bool startRequested, float deltaTime);
+
+#endif // WAVE_H
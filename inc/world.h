@@ -6,13 +6,14 @@
 // Function to initialize the game world
 void initWorld(GLFWwindow* win);
 
-// Function to update the game world
-void updateWorld();
+// Function to advance the game world by one fixed simulation step
+void updateWorld(float deltaTime);
 
-// Function to render the game world
-void renderWorld(float aspectRatio);
+// Function to render the game world. alpha in [0, 1] blends from the
+// previous to the current simulation tick; frameTime is the real frame length
+void renderWorld(float aspectRatio, float alpha, float frameTime);
 
-// Function to draw the grid
+// Function to queue the grid with the render queue (between renderer_begin and renderer_flush)
 void drawGrid();
 
 // Function to clean up resources
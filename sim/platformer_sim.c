@@ -0,0 +1,148 @@
+// platformer_sim.c
+//
+// Headless simulation driver. Runs the game tick (player, projectiles,
+// enemies, collisions, waves) with a scripted input stream as fast as the
+// CPU allows and reports ticks/sec plus per-stage timings. Nothing here
+// needs a window or GL context.
+//
+// Usage: platformer_sim [--ticks N] [--threads N] [--horde N] [--seed N] [--trace FILE]
+//   --trace FILE  write a Chrome trace of the run (needs PLATFORMER_PROFILER)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sim.h"
+#include "enemy.h"
+#include "job_system.h"
+#include "timer.h"
+#include "profiler.h"
+
+// Fixed tick length fed to the simulation
+#define SIM_TICK_SECONDS (1.0f / 60.0f)
+
+typedef struct {
+    int ticks;      // Ticks to simulate
+    int threads;    // Job system threads (0 = one per core, 1 = single-threaded)
+    int horde;      // Keep at least this many enemies alive (0 = waves only)
+    unsigned int seed;
+    const char* tracePath;  // Chrome trace output, or NULL
+} SimOptions;
+
+static bool parse_options(int argc, char** argv, SimOptions* options) {
+    options->ticks = 20000;
+    options->threads = 0;
+    options->horde = 0;
+    options->seed = 1u;
+    options->tracePath = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--ticks") == 0) {
+            options->ticks = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0) {
+            options->threads = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--horde") == 0) {
+            options->horde = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+            options->seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--trace") == 0) {
+            options->tracePath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--ticks N] [--threads N] [--horde N] [--seed N] [--trace FILE]\n",
+                    argv[0]);
+            return false;
+        }
+    }
+    return options->ticks > 0;
+}
+
+// Scripted input: circle the arena, jump, swing, throw daggers and call
+// waves on fixed beats so every run exercises the same code paths
+static SimInput scripted_input(int tick) {
+    SimInput input = {0};
+    float t = (float)tick * SIM_TICK_SECONDS;
+    
+    input.moveX = cosf(t * 0.5f);
+    input.moveZ = sinf(t * 0.5f);
+    input.jump = (tick % 90) == 0;
+    input.attack = (tick % 45) == 0;
+    input.spinAttack = (tick % 30) == 15;
+    input.startWave = (tick % 60) == 0;
+    return input;
+}
+
+// Top the enemy count back up to the horde size with a ring around the origin
+static void refill_horde(int horde, int tick) {
+    int missing = horde - get_enemy_count();
+    for (int i = 0; i < missing; i++) {
+        float angle = (float)(tick * 7919 + i) * 0.618034f;
+        float distance = 5.0f + (float)(i % 15);
+        spawn_enemy(cosf(angle) * distance, GROUND_LEVEL, sinf(angle) * distance);
+    }
+}
+
+int main(int argc, char** argv) {
+    SimOptions options;
+    if (!parse_options(argc, argv, &options)) {
+        return 1;
+    }
+    
+    srand(options.seed);
+    job_system_init(options.threads);
+    PROFILE_THREAD_NAME("main");
+    sim_init();
+    
+    uint64_t stageTotals[SIM_STAGE_COUNT] = {0};
+    uint64_t tickTotal = 0;
+    uint64_t worstTick = 0;
+    
+    uint64_t start = timer_now_ns();
+    for (int tick = 0; tick < options.ticks; tick++) {
+        if (options.horde > 0) {
+            refill_horde(options.horde, tick);
+        }
+        
+        SimInput input = scripted_input(tick);
+        PROFILE_SCOPE("tick") sim_tick(&input, SIM_TICK_SECONDS);
+        
+        const SimTimings* timings = sim_get_timings();
+        for (int s = 0; s < SIM_STAGE_COUNT; s++) {
+            stageTotals[s] += timings->stageNs[s];
+        }
+        tickTotal += timings->totalNs;
+        if (timings->totalNs > worstTick) {
+            worstTick = timings->totalNs;
+        }
+    }
+    uint64_t elapsed = timer_now_ns() - start;
+    
+    double seconds = (double)elapsed / 1e9;
+    printf("platformer_sim: %d ticks, %d threads, horde %d, seed %u\n",
+           options.ticks, job_system_thread_count(), options.horde, options.seed);
+    printf("ticks/sec: %.1f (%.3f s wall, %.1f simulated)\n",
+           (double)options.ticks / seconds, seconds, options.ticks * SIM_TICK_SECONDS);
+    printf("%-10s %12s %8s\n", "stage", "us/tick", "share");
+    for (int s = 0; s < SIM_STAGE_COUNT; s++) {
+        printf("%-10s %12.3f %7.1f%%\n", sim_stage_name((SimStage)s),
+               (double)stageTotals[s] / 1000.0 / options.ticks,
+               tickTotal > 0 ? 100.0 * (double)stageTotals[s] / (double)tickTotal : 0.0);
+    }
+    printf("%-10s %12.3f (worst %.3f)\n", "tick",
+           (double)tickTotal / 1000.0 / options.ticks, (double)worstTick / 1000.0);
+    printf("final: wave %d, %d enemies alive\n", sim_get_waves()->waveNumber, get_enemy_count());
+    
+    if (options.tracePath) {
+#ifdef PROFILER_ENABLED
+        if (profiler_write_trace(options.tracePath)) {
+            printf("trace: %s\n", options.tracePath);
+        }
+#else
+        printf("trace: profiler compiled out, rebuild with -DPLATFORMER_PROFILER=ON\n");
+#endif
+    }
+    
+    sim_cleanup();
+    job_system_shutdown();
+    profiler_shutdown();
+    return 0;
+}
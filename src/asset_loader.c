@@ -0,0 +1,166 @@
+#include "asset_loader.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "job_system.h"
+#include "timer.h"
+#include "profiler.h"
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// One submitted asset. It is the node of the ready queue, so handing a
+// decoded payload to the GL thread needs no allocation.
+typedef struct AssetRequest {
+    _Atomic(struct AssetRequest*) next;
+    AssetDecodeFunc decode;
+    AssetUploadFunc upload;
+    void* payload;
+    AssetState* state;
+    bool decoded;
+} AssetRequest;
+
+// Intrusive multi-producer/single-consumer queue (Vyukov). Workers push at
+// the head with one atomic exchange; the GL thread pops from the tail. The
+// stub node keeps the queue non-empty so push never touches the tail.
+static _Atomic(AssetRequest*) readyHead;
+static AssetRequest* readyTail;
+static AssetRequest readyStub;
+
+// Decode jobs still running, waited on by asset_loader_finish
+static JobCounter decodeCounter;
+
+// Submitted and not yet uploaded (GL thread only)
+static int pendingAssets = 0;
+
+static void ready_push(AssetRequest* request) {
+    atomic_store_explicit(&request->next, NULL, memory_order_relaxed);
+    AssetRequest* previous = atomic_exchange_explicit(&readyHead, request, memory_order_acq_rel);
+    // Between the exchange and this store the queue is briefly cut; the
+    // consumer sees that as empty and retries next pump
+    atomic_store_explicit(&previous->next, request, memory_order_release);
+}
+
+// Oldest fully pushed request, or NULL
+static AssetRequest* ready_pop(void) {
+    AssetRequest* tail = readyTail;
+    AssetRequest* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (tail == &readyStub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        readyTail = next;
+        tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+
+    if (next != NULL) {
+        readyTail = next;
+        return tail;
+    }
+
+    // tail is the last node; only take it once the stub is queued behind it
+    if (tail != atomic_load_explicit(&readyHead, memory_order_acquire)) {
+        return NULL;
+    }
+    ready_push(&readyStub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != NULL) {
+        readyTail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+// Worker side: decode, then hand the request to the GL thread
+static void decode_job(void* data, int begin, int end) {
+    (void)begin;
+    (void)end;
+    AssetRequest* request = (AssetRequest*)data;
+
+    PROFILE_BEGIN("asset_decode");
+    request->decoded = request->decode(request->payload);
+    PROFILE_END();
+
+    ready_push(request);
+}
+
+// Set up the ready queue
+void asset_loader_init(void) {
+    atomic_store(&readyStub.next, NULL);
+    atomic_store(&readyHead, &readyStub);
+    readyTail = &readyStub;
+    job_counter_init(&decodeCounter);
+    pendingAssets = 0;
+}
+
+// Queue payload for decoding on the job system
+void asset_loader_submit(AssetDecodeFunc decode, AssetUploadFunc upload, void* payload, AssetState* state) {
+    AssetRequest* request = (AssetRequest*)calloc(1, sizeof(AssetRequest));
+    request->decode = decode;
+    request->upload = upload;
+    request->payload = payload;
+    request->state = state;
+
+    if (state) {
+        *state = ASSET_STATE_LOADING;
+    }
+    pendingAssets++;
+
+    // Decodes go to the background queue so the main thread's job_wait in a
+    // sim tick never runs one. Single-threaded mode decodes right here; the
+    // upload still waits for a pump.
+    job_submit_background(&decodeCounter, decode_job, request);
+}
+
+// Upload decoded assets until budgetNs has been spent
+int asset_loader_pump(uint64_t budgetNs) {
+    if (pendingAssets == 0) {
+        return 0;
+    }
+
+    PROFILE_BEGIN("asset_upload");
+    uint64_t start = timer_now_ns();
+    int uploaded = 0;
+
+    AssetRequest* request;
+    while ((request = ready_pop()) != NULL) {
+        bool ready = request->upload(request->payload, request->decoded);
+        if (request->state) {
+            *request->state = ready ? ASSET_STATE_READY : ASSET_STATE_FAILED;
+        }
+        free(request);
+        pendingAssets--;
+        uploaded++;
+
+        if (timer_now_ns() - start >= budgetNs) {
+            break;
+        }
+    }
+
+    if (uploaded > 0) {
+        LOG("Uploaded %d assets in %.3f ms, %d still loading",
+            uploaded, (double)(timer_now_ns() - start) / 1e6, pendingAssets);
+    }
+    PROFILE_END();
+    return uploaded;
+}
+
+// Assets submitted and not yet uploaded
+int asset_loader_pending(void) {
+    return pendingAssets;
+}
+
+// Wait for every outstanding decode and upload all of them
+void asset_loader_finish(void) {
+    job_wait(&decodeCounter);
+    while (pendingAssets > 0) {
+        asset_loader_pump(UINT64_MAX);
+    }
+}
+
+// Finish outstanding loads and release the queue
+void asset_loader_shutdown(void) {
+    asset_loader_finish();
+}
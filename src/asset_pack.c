@@ -0,0 +1,227 @@
+// dirent is POSIX, not ISO C
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "asset_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "logging.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Source directory of each frame group
+static const char* const groupDirectories[ASSET_GROUP_COUNT] = {
+    "assets/Terrible Knight/Sprites/Idle",
+    "assets/Terrible Knight/Sprites/Run",
+    "assets/Terrible Knight/Sprites/Jump",
+    "assets/Terrible Knight/Sprites/SwordSlash",
+    "assets/Fire-Skull-Files/Sprites/Fire"
+};
+
+// Source directory of a frame group
+const char* asset_group_directory(AssetGroup group) {
+    return groupDirectories[group];
+}
+
+// Order frame files so "frame10" follows "frame9": shorter names first, then by name
+static int compare_frame_paths(const void* a, const void* b) {
+    const char* pathA = *(const char* const*)a;
+    const char* pathB = *(const char* const*)b;
+    size_t lengthA = strlen(pathA);
+    size_t lengthB = strlen(pathB);
+    if (lengthA != lengthB) {
+        return lengthA < lengthB ? -1 : 1;
+    }
+    return strcmp(pathA, pathB);
+}
+
+// List the .png files in a directory, sorted into frame order
+int load_animation_frames(const char* basePath, char*** framePathsOut) {
+#ifdef _WIN32
+    // Windows implementation
+    WIN32_FIND_DATA findData;
+    HANDLE hFind;
+    int frameCount = 0;
+    char** framePaths = NULL;
+    char searchPath[512];
+    
+    // Create search path with wildcard
+    sprintf(searchPath, "%s\\*.png", basePath);
+    
+    // First pass: count PNG files
+    hFind = FindFirstFile(searchPath, &findData);
+    if (hFind == INVALID_HANDLE_VALUE) {
+        LOG("Failed to open directory: %s", basePath);
+        return 0;
+    }
+    
+    do {
+        if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            frameCount++;
+        }
+    } while (FindNextFile(hFind, &findData));
+    
+    FindClose(hFind);
+    
+    // Allocate memory for the frame paths
+    framePaths = (char**)malloc(frameCount * sizeof(char*));
+    if (!framePaths) {
+        return 0;
+    }
+    
+    // Second pass: store the file paths
+    hFind = FindFirstFile(searchPath, &findData);
+    if (hFind == INVALID_HANDLE_VALUE) {
+        free(framePaths);
+        return 0;
+    }
+    
+    int index = 0;
+    do {
+        if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            // Allocate memory for the full path
+            framePaths[index] = (char*)malloc(strlen(basePath) + strlen(findData.cFileName) + 2);
+            if (framePaths[index]) {
+                sprintf(framePaths[index], "%s\\%s", basePath, findData.cFileName);
+                index++;
+            }
+        }
+    } while (FindNextFile(hFind, &findData));
+    
+    FindClose(hFind);
+    
+    // Directory listings are unordered; animations need frame order
+    qsort(framePaths, (size_t)index, sizeof(char*), compare_frame_paths);
+    *framePathsOut = framePaths;
+    return index;
+#else
+    // Unix implementation (unchanged)
+    DIR* dir;
+    struct dirent* entry;
+    int frameCount = 0;
+    char** framePaths = NULL;
+    
+    // Open the directory
+    dir = opendir(basePath);
+    if (!dir) {
+        LOG("Failed to open directory: %s", basePath);
+        return 0;
+    }
+    
+    // First pass: count the number of PNG files
+    while ((entry = readdir(dir)) != NULL) {
+        // Check if the file has a .png extension
+        char* ext = strrchr(entry->d_name, '.');
+        if (ext && strcmp(ext, ".png") == 0) {
+            frameCount++;
+        }
+    }
+    
+    // Allocate memory for the frame paths
+    framePaths = (char**)malloc(frameCount * sizeof(char*));
+    if (!framePaths) {
+        closedir(dir);
+        return 0;
+    }
+    
+    // Reset directory position
+    rewinddir(dir);
+    
+    // Second pass: store the file paths
+    int index = 0;
+    while ((entry = readdir(dir)) != NULL) {
+        char* ext = strrchr(entry->d_name, '.');
+        if (ext && strcmp(ext, ".png") == 0) {
+            // Allocate memory for the full path
+            framePaths[index] = (char*)malloc(strlen(basePath) + strlen(entry->d_name) + 2);
+            if (framePaths[index]) {
+                sprintf(framePaths[index], "%s/%s", basePath, entry->d_name);
+                index++;
+            }
+        }
+    }
+    
+    closedir(dir);
+    
+    // Directory listings are unordered; animations need frame order
+    qsort(framePaths, (size_t)index, sizeof(char*), compare_frame_paths);
+    *framePathsOut = framePaths;
+    return index;
+#endif
+}
+
+// True if [offset, offset + size) lies inside the mapped file
+static bool in_bounds(const AssetPack* pack, uint64_t offset, uint64_t size) {
+    return offset <= pack->file.size && size <= pack->file.size - offset;
+}
+
+// Map a pack and validate it
+bool asset_pack_open(AssetPack* pack, const char* path) {
+    memset(pack, 0, sizeof(*pack));
+    
+    if (!file_map_open(&pack->file, path)) {
+        LOG("No cooked asset pack at %s", path);
+        return false;
+    }
+    
+    const AssetPackHeader* header = (const AssetPackHeader*)pack->file.data;
+    bool valid = pack->file.size >= sizeof(AssetPackHeader) &&
+                 header->magic == ASSET_PACK_MAGIC &&
+                 header->version == ASSET_PACK_VERSION &&
+                 header->groupCount == ASSET_GROUP_COUNT &&
+                 header->mipCount >= 1 && header->mipCount <= ATLAS_MAX_MIP_LEVELS &&
+                 in_bounds(pack, header->framesOffset, (uint64_t)header->frameCount * sizeof(AssetPackFrame)) &&
+                 in_bounds(pack, header->groupsOffset, (uint64_t)header->groupCount * sizeof(AssetPackGroup));
+    
+    for (uint32_t level = 0; valid && level < header->mipCount; level++) {
+        uint64_t width = header->pageWidth >> level ? header->pageWidth >> level : 1;
+        uint64_t height = header->pageHeight >> level ? header->pageHeight >> level : 1;
+        valid = header->mipSizes[level] == width * height * 4 &&
+                in_bounds(pack, header->mipOffsets[level], header->mipSizes[level]);
+    }
+    
+    if (!valid) {
+        printf("WARNING: Ignoring stale or corrupt asset pack %s (re-run cook_assets)\n", path);
+        asset_pack_close(pack);
+        return false;
+    }
+    
+    pack->header = header;
+    pack->frames = (const AssetPackFrame*)(pack->file.data + header->framesOffset);
+    pack->groups = (const AssetPackGroup*)(pack->file.data + header->groupsOffset);
+    
+    for (uint32_t group = 0; group < header->groupCount; group++) {
+        if ((uint64_t)pack->groups[group].firstFrame + pack->groups[group].frameCount > header->frameCount) {
+            printf("WARNING: Asset pack %s has an out-of-range frame group\n", path);
+            asset_pack_close(pack);
+            return false;
+        }
+    }
+    
+    LOG("Mapped asset pack %s: %ux%u atlas, %u mips, %u frames",
+        path, header->pageWidth, header->pageHeight, header->mipCount, header->frameCount);
+    return true;
+}
+
+// Pixels of one mip level of the atlas page
+const unsigned char* asset_pack_mip(const AssetPack* pack, int level, int* width, int* height) {
+    const AssetPackHeader* header = pack->header;
+    *width = header->pageWidth >> level ? (int)(header->pageWidth >> level) : 1;
+    *height = header->pageHeight >> level ? (int)(header->pageHeight >> level) : 1;
+    return pack->file.data + header->mipOffsets[level];
+}
+
+// Unmap the pack
+void asset_pack_close(AssetPack* pack) {
+    file_map_close(&pack->file);
+    memset(pack, 0, sizeof(*pack));
+}
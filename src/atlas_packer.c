@@ -0,0 +1,173 @@
+#include "atlas_packer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Mip levels shrink the page by halves, so packed rects are kept on this grid
+#define ATLAS_ALIGN (1 << (ATLAS_MAX_MIP_LEVELS - 1))
+
+static int align_up(int value) {
+    return (value + ATLAS_ALIGN - 1) & ~(ATLAS_ALIGN - 1);
+}
+
+// Taller images first so each shelf wastes little height
+static int compare_heights(const void* a, const void* b) {
+    const AtlasImage* imageA = *(AtlasImage* const*)a;
+    const AtlasImage* imageB = *(AtlasImage* const*)b;
+    return imageB->height - imageA->height;
+}
+
+// Place images on shelves of pageWidth, returning the height used
+static int pack_shelves(AtlasImage** order, int count, int pageWidth) {
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    
+    for (int i = 0; i < count; i++) {
+        AtlasImage* image = order[i];
+        int paddedWidth = align_up(image->width + 2 * ATLAS_PADDING);
+        int paddedHeight = align_up(image->height + 2 * ATLAS_PADDING);
+        
+        if (shelfX + paddedWidth > pageWidth) {
+            shelfY += shelfHeight;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+        
+        image->x = shelfX + ATLAS_PADDING;
+        image->y = shelfY + ATLAS_PADDING;
+        shelfX += paddedWidth;
+        if (paddedHeight > shelfHeight) {
+            shelfHeight = paddedHeight;
+        }
+    }
+    
+    return shelfY + shelfHeight;
+}
+
+// Copy an image into the page premultiplied, extruding its border into the padding
+static void blit_image(unsigned char* pagePixels, int pageWidth, const AtlasImage* image) {
+    for (int y = -ATLAS_PADDING; y < image->height + ATLAS_PADDING; y++) {
+        int srcY = y < 0 ? 0 : (y >= image->height ? image->height - 1 : y);
+        for (int x = -ATLAS_PADDING; x < image->width + ATLAS_PADDING; x++) {
+            int srcX = x < 0 ? 0 : (x >= image->width ? image->width - 1 : x);
+            const unsigned char* src = image->pixels + ((size_t)srcY * image->width + srcX) * 4;
+            unsigned char* dst = pagePixels + ((size_t)(image->y + y) * pageWidth + (image->x + x)) * 4;
+            
+            unsigned int alpha = src[3];
+            dst[0] = (unsigned char)((src[0] * alpha + 127) / 255);
+            dst[1] = (unsigned char)((src[1] * alpha + 127) / 255);
+            dst[2] = (unsigned char)((src[2] * alpha + 127) / 255);
+            dst[3] = (unsigned char)alpha;
+        }
+    }
+}
+
+// 2x2 box filter; averaging premultiplied texels keeps edges free of dark halos
+static void downsample(const unsigned char* src, int srcWidth, int srcHeight, unsigned char* dst) {
+    int dstWidth = srcWidth > 1 ? srcWidth / 2 : 1;
+    int dstHeight = srcHeight > 1 ? srcHeight / 2 : 1;
+    
+    for (int y = 0; y < dstHeight; y++) {
+        int y0 = y * 2 < srcHeight ? y * 2 : srcHeight - 1;
+        int y1 = y * 2 + 1 < srcHeight ? y * 2 + 1 : srcHeight - 1;
+        for (int x = 0; x < dstWidth; x++) {
+            int x0 = x * 2 < srcWidth ? x * 2 : srcWidth - 1;
+            int x1 = x * 2 + 1 < srcWidth ? x * 2 + 1 : srcWidth - 1;
+            for (int c = 0; c < 4; c++) {
+                unsigned int sum = src[((size_t)y0 * srcWidth + x0) * 4 + c] +
+                                   src[((size_t)y0 * srcWidth + x1) * 4 + c] +
+                                   src[((size_t)y1 * srcWidth + x0) * 4 + c] +
+                                   src[((size_t)y1 * srcWidth + x1) * 4 + c];
+                dst[((size_t)y * dstWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+// Place every loaded image on one page and build its pixels and mip chain
+bool atlas_pack(AtlasImage* images, int count, int maxSize, AtlasPage* page) {
+    memset(page, 0, sizeof(*page));
+    
+    AtlasImage** order = (AtlasImage**)malloc((size_t)(count > 0 ? count : 1) * sizeof(AtlasImage*));
+    int loadedCount = 0;
+    long long totalArea = 0;
+    int widest = 0;
+    
+    for (int i = 0; i < count; i++) {
+        if (!images[i].pixels) {
+            images[i].width = 0;
+            images[i].height = 0;
+            continue;
+        }
+        
+        order[loadedCount++] = &images[i];
+        int paddedWidth = align_up(images[i].width + 2 * ATLAS_PADDING);
+        int paddedHeight = align_up(images[i].height + 2 * ATLAS_PADDING);
+        totalArea += (long long)paddedWidth * paddedHeight;
+        if (paddedWidth > widest) {
+            widest = paddedWidth;
+        }
+    }
+    
+    if (loadedCount == 0) {
+        free(order);
+        return false;
+    }
+    
+    qsort(order, (size_t)loadedCount, sizeof(AtlasImage*), compare_heights);
+    
+    // Grow a power-of-two width until the shelves fit in a square-ish page
+    int pageWidth = ATLAS_MIN_WIDTH;
+    while (pageWidth < widest || (long long)pageWidth * pageWidth < totalArea) {
+        pageWidth *= 2;
+    }
+    int pageHeight = pack_shelves(order, loadedCount, pageWidth);
+    while (pageHeight > pageWidth && pageWidth < maxSize) {
+        pageWidth *= 2;
+        pageHeight = pack_shelves(order, loadedCount, pageWidth);
+    }
+    
+    page->width = pageWidth;
+    page->height = pageHeight;
+    page->mips[0] = (unsigned char*)calloc((size_t)pageWidth * pageHeight, 4);
+    for (int i = 0; i < loadedCount; i++) {
+        blit_image(page->mips[0], pageWidth, order[i]);
+    }
+    
+    page->mipCount = 1;
+    while (page->mipCount < ATLAS_MAX_MIP_LEVELS) {
+        int level = page->mipCount;
+        int srcWidth = atlas_mip_width(page, level - 1);
+        int srcHeight = atlas_mip_height(page, level - 1);
+        if (srcWidth == 1 && srcHeight == 1) {
+            break;
+        }
+        
+        page->mips[level] = (unsigned char*)malloc((size_t)atlas_mip_width(page, level) *
+                                                   atlas_mip_height(page, level) * 4);
+        downsample(page->mips[level - 1], srcWidth, srcHeight, page->mips[level]);
+        page->mipCount++;
+    }
+    
+    free(order);
+    return true;
+}
+
+// Size in pixels of mip level of a page
+int atlas_mip_width(const AtlasPage* page, int level) {
+    int width = page->width >> level;
+    return width > 0 ? width : 1;
+}
+
+int atlas_mip_height(const AtlasPage* page, int level) {
+    int height = page->height >> level;
+    return height > 0 ? height : 1;
+}
+
+// Release the page's pixels
+void atlas_page_free(AtlasPage* page) {
+    for (int level = 0; level < ATLAS_MAX_MIP_LEVELS; level++) {
+        free(page->mips[level]);
+    }
+    memset(page, 0, sizeof(*page));
+}
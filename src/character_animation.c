@@ -1,4 +1,8 @@
 #include "character_animation.h"
+#include "sprite_atlas.h"
+#include "asset_loader.h"
+#include "culling.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,226 +11,172 @@
 // Define this module for logging
 LOG_MODULE_DEFINE(__FILE__, false);
 
-#ifdef _WIN32
-#include <windows.h>
-#else
-#include <dirent.h>
-#endif
+// Bounding sphere radius of a grounded sprite per unit of scale
+#define CHARACTER_CULL_RADIUS 0.625f
 
-// Helper function to load all frames from a directory
-int load_animation_frames(const char* basePath, char*** framePathsOut) {
-#ifdef _WIN32
-    // Windows implementation
-    WIN32_FIND_DATA findData;
-    HANDLE hFind;
-    int frameCount = 0;
-    char** framePaths = NULL;
-    char searchPath[512];
-    
-    // Create search path with wildcard
-    sprintf(searchPath, "%s\\*.png", basePath);
-    
-    // First pass: count PNG files
-    hFind = FindFirstFile(searchPath, &findData);
-    if (hFind == INVALID_HANDLE_VALUE) {
-        LOG("Failed to open directory: %s", basePath);
-        return 0;
+// One texture holds the player and the enemies, so they draw from a single bind
+static SpriteAtlas characterAtlas;
+static AssetState atlasState = ASSET_STATE_UNLOADED;
+static int atlasGroupFirst[ASSET_GROUP_COUNT];
+static int atlasGroupCount[ASSET_GROUP_COUNT];
+static int atlasUsers = 0;
+
+// What the worker produced for the atlas: a mapped pack or decoded PNGs
+static struct {
+    int maxTextureSize;        // Queried on the GL thread before submitting
+    bool cooked;
+    AssetPack pack;
+    SpriteAtlasSource source;
+    int groupFirst[ASSET_GROUP_COUNT];
+    int groupCount[ASSET_GROUP_COUNT];
+} atlasLoad;
+
+// Map the cooked pack written by cook_assets, if there is a current one
+static bool open_cooked_atlas(void) {
+    if (!asset_pack_open(&atlasLoad.pack, ASSET_PACK_PATH)) {
+        return false;
     }
     
-    do {
-        if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-            frameCount++;
-        }
-    } while (FindNextFile(hFind, &findData));
-    
-    FindClose(hFind);
-    
-    // Allocate memory for the frame paths
-    framePaths = (char**)malloc(frameCount * sizeof(char*));
-    if (!framePaths) {
-        return 0;
+    for (int group = 0; group < ASSET_GROUP_COUNT; group++) {
+        atlasLoad.groupFirst[group] = (int)atlasLoad.pack.groups[group].firstFrame;
+        atlasLoad.groupCount[group] = (int)atlasLoad.pack.groups[group].frameCount;
     }
-    
-    // Second pass: store the file paths
-    hFind = FindFirstFile(searchPath, &findData);
-    if (hFind == INVALID_HANDLE_VALUE) {
+    return true;
+}
+
+// Decode and pack the source PNGs (when the pack hasn't been cooked)
+static bool decode_atlas_sources(void) {
+    // Gather every group's frames into one path list
+    char** allPaths = NULL;
+    int totalCount = 0;
+    for (int group = 0; group < ASSET_GROUP_COUNT; group++) {
+        char** framePaths = NULL;
+        int frameCount = load_animation_frames(asset_group_directory((AssetGroup)group), &framePaths);
+        if (frameCount <= 0) {
+            LOG("Failed to load animation frames from %s", asset_group_directory((AssetGroup)group));
+            frameCount = 0;
+        }
+        
+        atlasLoad.groupFirst[group] = totalCount;
+        atlasLoad.groupCount[group] = frameCount;
+        
+        if (frameCount > 0) {
+            allPaths = (char**)realloc(allPaths, (size_t)(totalCount + frameCount) * sizeof(char*));
+            memcpy(allPaths + totalCount, framePaths, (size_t)frameCount * sizeof(char*));
+            totalCount += frameCount;
+        }
         free(framePaths);
-        return 0;
     }
     
-    int index = 0;
-    do {
-        if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-            // Allocate memory for the full path
-            framePaths[index] = (char*)malloc(strlen(basePath) + strlen(findData.cFileName) + 2);
-            if (framePaths[index]) {
-                sprintf(framePaths[index], "%s\\%s", basePath, findData.cFileName);
-                index++;
-            }
-        }
-    } while (FindNextFile(hFind, &findData));
+    bool decoded = totalCount > 0 &&
+                   sprite_atlas_decode(&atlasLoad.source, (const char* const*)allPaths, totalCount,
+                                       atlasLoad.maxTextureSize);
     
-    FindClose(hFind);
-    *framePathsOut = framePaths;
-    return frameCount;
-#else
-    // Unix implementation (unchanged)
-    DIR* dir;
-    struct dirent* entry;
-    int frameCount = 0;
-    char** framePaths = NULL;
+    for (int i = 0; i < totalCount; i++) {
+        free(allPaths[i]);
+    }
+    free(allPaths);
+    return decoded;
+}
+
+// Worker side of the atlas load: map the pack or decode the sources
+static bool decode_character_atlas(void* payload) {
+    (void)payload;
     
-    // Open the directory
-    dir = opendir(basePath);
-    if (!dir) {
-        LOG("Failed to open directory: %s", basePath);
-        return 0;
+    atlasLoad.cooked = open_cooked_atlas();
+    if (atlasLoad.cooked) {
+        return true;
     }
     
-    // First pass: count the number of PNG files
-    while ((entry = readdir(dir)) != NULL) {
-        // Check if the file has a .png extension
-        char* ext = strrchr(entry->d_name, '.');
-        if (ext && strcmp(ext, ".png") == 0) {
-            frameCount++;
+    printf("No cooked sprite pack, decoding source PNGs (run cook_assets to speed up startup)\n");
+    return decode_atlas_sources();
+}
+
+// GL side of the atlas load: create the texture and publish the frame groups
+static bool upload_character_atlas(void* payload, bool decoded) {
+    (void)payload;
+    
+    bool uploaded = false;
+    if (decoded) {
+        if (atlasLoad.cooked) {
+            uploaded = sprite_atlas_load_pack(&characterAtlas, &atlasLoad.pack);
+            asset_pack_close(&atlasLoad.pack);
+        } else {
+            uploaded = sprite_atlas_upload(&characterAtlas, &atlasLoad.source);
         }
     }
     
-    // Allocate memory for the frame paths
-    framePaths = (char**)malloc(frameCount * sizeof(char*));
-    if (!framePaths) {
-        closedir(dir);
-        return 0;
+    if (!uploaded) {
+        LOG("Failed to load the character atlas");
+        return false;
     }
     
-    // Reset directory position
-    rewinddir(dir);
-    
-    // Second pass: store the file paths
-    int index = 0;
-    while ((entry = readdir(dir)) != NULL) {
-        char* ext = strrchr(entry->d_name, '.');
-        if (ext && strcmp(ext, ".png") == 0) {
-            // Allocate memory for the full path
-            framePaths[index] = (char*)malloc(strlen(basePath) + strlen(entry->d_name) + 2);
-            if (framePaths[index]) {
-                sprintf(framePaths[index], "%s/%s", basePath, entry->d_name);
-                index++;
-            }
-        }
+    // Every user let go while the atlas was loading
+    if (atlasUsers == 0) {
+        sprite_atlas_free(&characterAtlas);
+        return false;
     }
     
-    closedir(dir);
-    *framePathsOut = framePaths;
-    return frameCount;
-#endif
+    memcpy(atlasGroupFirst, atlasLoad.groupFirst, sizeof(atlasGroupFirst));
+    memcpy(atlasGroupCount, atlasLoad.groupCount, sizeof(atlasGroupCount));
+    return true;
 }
 
-// Add this global variable to track if an attack is in progress
-static bool attackInProgress = false;
-
-// Initialize the character animator
-void character_animator_init(CharacterAnimator* animator) {
-    animator->currentState = CHARACTER_STATE_IDLE;
-    animator->facingRight = true;
-    animator->stateTime = 0.0f;
-    
-    // Initialize all animations to empty/default state first
-    for (int i = 0; i < CHARACTER_STATE_COUNT; i++) {
-        // Initialize with a dummy texture that will be replaced
-        const char* dummyPath = "dummy";
-        sprite_init_with_texture(&animator->animations[i], &dummyPath, 1, 0.1f, true, 0);
+// Take a reference on the shared atlas, starting its load on first use.
+// Sprites bind to it once atlasState reaches READY.
+static void acquire_character_atlas(void) {
+    atlasUsers++;
+    if (atlasState == ASSET_STATE_LOADING || atlasState == ASSET_STATE_READY) {
+        return;
     }
     
-    // Base path for animations
-    const char* basePath = "assets/Terrible Knight/Sprites";
-    
-    // Load each animation state
-    char** framePaths;
-    int frameCount;
-    
-    // Idle animation
-    char idlePath[256];
-    sprintf(idlePath, "%s/Idle", basePath);
-    frameCount = load_animation_frames(idlePath, &framePaths);
-    if (frameCount > 0) {
-        sprite_init(&animator->animations[CHARACTER_STATE_IDLE], 
-                   (const char**)framePaths, frameCount, 0.1f, true);
-        
-        // Free allocated memory
-        for (int i = 0; i < frameCount; i++) {
-            free(framePaths[i]);
-        }
-        free(framePaths);
-    } else {
-        LOG("Failed to load Idle animation");
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    memset(&atlasLoad, 0, sizeof(atlasLoad));
+    atlasLoad.maxTextureSize = maxSize;
+    asset_loader_submit(decode_character_atlas, upload_character_atlas, NULL, &atlasState);
+}
+
+// Free the shared atlas once its last user is gone
+static void release_character_atlas(void) {
+    if (atlasUsers > 0 && --atlasUsers == 0 && atlasState == ASSET_STATE_READY) {
+        sprite_atlas_free(&characterAtlas);
+        memset(atlasGroupCount, 0, sizeof(atlasGroupCount));
+        atlasState = ASSET_STATE_UNLOADED;
     }
-    
-    // Run animation
-    char runPath[256];
-    sprintf(runPath, "%s/Run", basePath);
-    frameCount = load_animation_frames(runPath, &framePaths);
-    if (frameCount > 0) {
-        sprite_init(&animator->animations[CHARACTER_STATE_RUN], 
-                   (const char**)framePaths, frameCount, 0.08f, true);
-        
-        // Free allocated memory
-        for (int i = 0; i < frameCount; i++) {
-            free(framePaths[i]);
-        }
-        free(framePaths);
-    } else {
-        LOG("Failed to load Run animation");
+}
+
+// Point a sprite at one group's frames in the shared atlas
+static void init_from_atlas(Sprite* sprite, AssetGroup group, float frameDuration, bool loop) {
+    if (atlasGroupCount[group] == 0) {
+        return;
     }
-    
-    // Jump animation
-    char jumpPath[256];
-    sprintf(jumpPath, "%s/Jump", basePath);
-    frameCount = load_animation_frames(jumpPath, &framePaths);
-    if (frameCount > 0) {
-        sprite_init(&animator->animations[CHARACTER_STATE_JUMP], 
-                   (const char**)framePaths, frameCount, 0.1f, false);
-        
-        // Free allocated memory
-        for (int i = 0; i < frameCount; i++) {
-            free(framePaths[i]);
-        }
-        free(framePaths);
-    } else {
-        LOG("Failed to load Jump animation");
+    sprite_init(sprite, characterAtlas.textureID, &characterAtlas.frameUVs[atlasGroupFirst[group]],
+                atlasGroupCount[group], frameDuration, loop);
+}
+
+// Point the animator's states at their frames once the atlas is resident
+static void bind_animations(CharacterAnimator* animator) {
+    if (animator->animationsBound || !animator->atlasAcquired || atlasState != ASSET_STATE_READY) {
+        return;
     }
-    
-    // Attack animation
-    char attackPath[256];
-    sprintf(attackPath, "%s/SwordSlash", basePath);
-    frameCount = load_animation_frames(attackPath, &framePaths);
-    if (frameCount > 0) {
-        LOG("Loading attack animation with %d frames", frameCount);
-        sprite_init(&animator->animations[CHARACTER_STATE_ATTACK], 
-                   (const char**)framePaths, frameCount, 0.2f, false);
-        
-        // Clone the attack animation for air attacks BEFORE freeing framePaths
-        LOG("Setting up air attack animation with %d frames", frameCount);
-        sprite_init(&animator->animations[CHARACTER_STATE_AIR_ATTACK], 
-                   (const char**)framePaths, frameCount, 0.2f, false);
-        
-        // Free allocated memory
-        for (int i = 0; i < frameCount; i++) {
-            free(framePaths[i]);
-        }
-        free(framePaths);
-    } else {
-        LOG("Failed to load Attack animation from %s", attackPath);
-        
-        // Fallback: Create a simple 1-frame animation using the idle animation's first frame
-        if (animator->animations[CHARACTER_STATE_IDLE].frameCount > 0) {
-            unsigned int idleTextureID = animator->animations[CHARACTER_STATE_IDLE].textureIDs[0];
-            const char* dummyPath = "dummy";
-            sprite_init_with_texture(&animator->animations[CHARACTER_STATE_ATTACK], 
-                                    &dummyPath, 1, 0.5f, false, idleTextureID);
-            sprite_init_with_texture(&animator->animations[CHARACTER_STATE_AIR_ATTACK], 
-                                    &dummyPath, 1, 0.5f, false, idleTextureID);
-        }
+    animator->animationsBound = true;
+    
+    init_from_atlas(&animator->animations[CHARACTER_STATE_IDLE], ASSET_GROUP_KNIGHT_IDLE, 0.1f, true);
+    init_from_atlas(&animator->animations[CHARACTER_STATE_RUN], ASSET_GROUP_KNIGHT_RUN, 0.08f, true);
+    init_from_atlas(&animator->animations[CHARACTER_STATE_JUMP], ASSET_GROUP_KNIGHT_JUMP, 0.1f, false);
+    
+    // Air attacks reuse the sword slash frames
+    if (atlasGroupCount[ASSET_GROUP_KNIGHT_SWORD_SLASH] > 0) {
+        LOG("Loading attack animation with %d frames", atlasGroupCount[ASSET_GROUP_KNIGHT_SWORD_SLASH]);
+        init_from_atlas(&animator->animations[CHARACTER_STATE_ATTACK], ASSET_GROUP_KNIGHT_SWORD_SLASH, 0.2f, false);
+        init_from_atlas(&animator->animations[CHARACTER_STATE_AIR_ATTACK], ASSET_GROUP_KNIGHT_SWORD_SLASH, 0.2f, false);
+    } else if (atlasGroupCount[ASSET_GROUP_KNIGHT_IDLE] > 0) {
+        // Fallback: a 1-frame attack showing the first idle frame
+        LOG("Failed to load Attack animation, using the first idle frame");
+        const vec4* idleFrame = &characterAtlas.frameUVs[atlasGroupFirst[ASSET_GROUP_KNIGHT_IDLE]];
+        sprite_init(&animator->animations[CHARACTER_STATE_ATTACK], characterAtlas.textureID, idleFrame, 1, 0.5f, false);
+        sprite_init(&animator->animations[CHARACTER_STATE_AIR_ATTACK], characterAtlas.textureID, idleFrame, 1, 0.5f, false);
     }
     
     // Load other animations as needed...
@@ -240,6 +190,27 @@ void character_animator_init(CharacterAnimator* animator) {
     }
 }
 
+// Add this global variable to track if an attack is in progress
+static bool attackInProgress = false;
+
+// Initialize the character animator
+void character_animator_init(CharacterAnimator* animator) {
+    animator->currentState = CHARACTER_STATE_IDLE;
+    animator->facingRight = true;
+    animator->stateTime = 0.0f;
+    animator->atlasAcquired = false;
+    animator->animationsBound = false;
+    
+    // Start every state empty; states without frames are never entered
+    for (int i = 0; i < CHARACTER_STATE_COUNT; i++) {
+        sprite_init(&animator->animations[i], 0, NULL, 0, 0.1f, true);
+    }
+    
+    // The frames arrive asynchronously; bind_animations picks them up
+    acquire_character_atlas();
+    animator->atlasAcquired = true;
+}
+
 // Update the animator with the current state
 void character_animator_update(CharacterAnimator* animator, CharacterState newState, float deltaTime) {
     // Safety check for invalid state
@@ -248,6 +219,9 @@ void character_animator_update(CharacterAnimator* animator, CharacterState newSt
         newState = CHARACTER_STATE_IDLE;
     }
     
+    // Pick up the frames once the shared atlas has finished loading
+    bind_animations(animator);
+    
     // Check if current animation has finished (for non-looping animations)
     Sprite* currentSprite = &animator->animations[animator->currentState];
     bool animationFinished = false;
@@ -341,12 +315,19 @@ void character_animator_update(CharacterAnimator* animator, CharacterState newSt
 
 // Render the current animation
 void character_animator_render(CharacterAnimator* animator, Shader* shader, vec3 position, float scale) {
+    // Bounding sphere of the grounded quad: |scale| wide, 0.75 * |scale| tall
+    float absScale = fabsf(scale);
+    vec3 center = {position[0], position[1] + 0.375f * absScale, position[2]};
+    if (!culling_sphere_visible(center, CHARACTER_CULL_RADIUS * absScale)) {
+        return;
+    }
+    
     // Flip the sprite based on facing direction
     float actualScale = animator->facingRight ? scale : -scale;
     
     // Safety check - only render if the animation has valid frames
     if (animator->animations[animator->currentState].frameCount > 0 &&
-        animator->animations[animator->currentState].textureIDs != NULL) {
+        animator->animations[animator->currentState].frameUVs != NULL) {
         // Render the current animation
         sprite_render_grounded(&animator->animations[animator->currentState], 
                               shader, position, actualScale);
@@ -366,4 +347,31 @@ void character_animator_cleanup(CharacterAnimator* animator) {
     for (int i = 0; i < CHARACTER_STATE_COUNT; i++) {
         sprite_cleanup(&animator->animations[i]);
     }
-} 
\ No newline at end of file
+    
+    if (animator->atlasAcquired) {
+        release_character_atlas();
+        animator->atlasAcquired = false;
+        animator->animationsBound = false;
+    }
+}
+
+// Start loading the Fire Skull frames in the shared character atlas
+bool fire_skull_animation_init(Sprite* sprite) {
+    sprite_init(sprite, 0, NULL, 0, 0.1f, true);
+    acquire_character_atlas();
+    return atlasState != ASSET_STATE_FAILED;
+}
+
+// Point sprite at the Fire Skull frames once the atlas is resident
+bool fire_skull_animation_bind(Sprite* sprite) {
+    if (sprite->frameCount == 0 && atlasState == ASSET_STATE_READY) {
+        init_from_atlas(sprite, ASSET_GROUP_FIRE_SKULL, 0.1f, true);
+    }
+    return sprite->frameCount > 0;
+}
+
+// Release a sprite set up by fire_skull_animation_init
+void fire_skull_animation_cleanup(Sprite* sprite) {
+    sprite_cleanup(sprite);
+    release_character_atlas();
+}
@@ -0,0 +1,163 @@
+#include "culling.h"
+#include <math.h>
+
+// The batched test is built with SSE2 on x86 (always present on x86-64);
+// other targets use the scalar path
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULLING_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Planes and counters of the frame being rendered
+static Frustum frameFrustum;
+static CullStats frameStats;
+
+// Extract the frustum planes of a projection * view matrix
+void frustum_extract(Frustum* frustum, mat4 viewProj) {
+    // cglm is column-major: row r of the matrix is m[0][r], m[1][r], m[2][r], m[3][r].
+    // Each plane is row 3 plus or minus row 0 (left/right), 1 (bottom/top) or 2 (near/far).
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i & 1) ? -1.0f : 1.0f;
+        vec4 plane = {
+            viewProj[0][3] + sign * viewProj[0][row],
+            viewProj[1][3] + sign * viewProj[1][row],
+            viewProj[2][3] + sign * viewProj[2][row],
+            viewProj[3][3] + sign * viewProj[3][row]
+        };
+
+        float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            glm_vec4_scale(plane, 1.0f / length, plane);
+        }
+        glm_vec4_copy(plane, frustum->planes[i]);
+    }
+}
+
+// True if a sphere touches the frustum
+bool frustum_sphere_visible(const Frustum* frustum, const vec3 center, float radius) {
+    for (int i = 0; i < 6; i++) {
+        const float* plane = frustum->planes[i];
+        float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+        if (distance < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Position of entity i as drawn this frame
+static void cull_position(const CullPositions* positions, int i, vec3 center) {
+    center[0] = positions->x[i];
+    center[1] = positions->y[i];
+    center[2] = positions->z[i];
+    if (positions->prevX) {
+        center[0] = positions->prevX[i] + (center[0] - positions->prevX[i]) * positions->alpha;
+        center[1] = positions->prevY[i] + (center[1] - positions->prevY[i]) * positions->alpha;
+        center[2] = positions->prevZ[i] + (center[2] - positions->prevZ[i]) * positions->alpha;
+    }
+}
+
+#ifdef CULLING_SSE2
+// Four spheres per iteration against all six planes; returns the first index not tested
+static int cull_spheres_sse2(const Frustum* frustum, const CullPositions* positions, int count,
+                             float radius, int* visible, int* visibleCount) {
+    __m128 planeA[6], planeB[6], planeC[6], planeD[6];
+    for (int p = 0; p < 6; p++) {
+        planeA[p] = _mm_set1_ps(frustum->planes[p][0]);
+        planeB[p] = _mm_set1_ps(frustum->planes[p][1]);
+        planeC[p] = _mm_set1_ps(frustum->planes[p][2]);
+        planeD[p] = _mm_set1_ps(frustum->planes[p][3]);
+    }
+    __m128 negRadius = _mm_set1_ps(-radius);
+    __m128 alpha = _mm_set1_ps(positions->alpha);
+
+    int i = 0;
+    int out = *visibleCount;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(positions->x + i);
+        __m128 y = _mm_loadu_ps(positions->y + i);
+        __m128 z = _mm_loadu_ps(positions->z + i);
+        if (positions->prevX) {
+            __m128 prevX = _mm_loadu_ps(positions->prevX + i);
+            __m128 prevY = _mm_loadu_ps(positions->prevY + i);
+            __m128 prevZ = _mm_loadu_ps(positions->prevZ + i);
+            x = _mm_add_ps(prevX, _mm_mul_ps(_mm_sub_ps(x, prevX), alpha));
+            y = _mm_add_ps(prevY, _mm_mul_ps(_mm_sub_ps(y, prevY), alpha));
+            z = _mm_add_ps(prevZ, _mm_mul_ps(_mm_sub_ps(z, prevZ), alpha));
+        }
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeA[p], x), _mm_mul_ps(planeB[p], y)),
+                                         _mm_add_ps(_mm_mul_ps(planeC[p], z), planeD[p]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++) {
+            if (mask & (1 << lane)) {
+                visible[out++] = i + lane;
+            }
+        }
+    }
+
+    *visibleCount = out;
+    return i;
+}
+#endif
+
+// Test count spheres of one radius, writing the visible indices in order
+int frustum_cull_spheres(const Frustum* frustum, const CullPositions* positions, int count,
+                         float radius, int* visible) {
+    int visibleCount = 0;
+    int i = 0;
+
+#ifdef CULLING_SSE2
+    i = cull_spheres_sse2(frustum, positions, count, radius, visible, &visibleCount);
+#endif
+
+    for (; i < count; i++) {
+        vec3 center;
+        cull_position(positions, i, center);
+        if (frustum_sphere_visible(frustum, center, radius)) {
+            visible[visibleCount++] = i;
+        }
+    }
+    return visibleCount;
+}
+
+// Start a frame: take the camera's planes and reset the counters
+void culling_begin(mat4 viewProj) {
+    frustum_extract(&frameFrustum, viewProj);
+    frameStats.tested = 0;
+    frameStats.visible = 0;
+    frameStats.culled = 0;
+}
+
+bool culling_sphere_visible(const vec3 center, float radius) {
+    bool visible = frustum_sphere_visible(&frameFrustum, center, radius);
+    frameStats.tested++;
+    frameStats.visible += visible ? 1 : 0;
+    frameStats.culled += visible ? 0 : 1;
+    return visible;
+}
+
+int culling_cull_spheres(const CullPositions* positions, int count, float radius, int* visible) {
+    int visibleCount = frustum_cull_spheres(&frameFrustum, positions, count, radius, visible);
+    frameStats.tested += count;
+    frameStats.visible += visibleCount;
+    frameStats.culled += count - visibleCount;
+    return visibleCount;
+}
+
+// Planes taken by the last culling_begin
+const Frustum* culling_frame_frustum(void) {
+    return &frameFrustum;
+}
+
+// Counters for the current frame
+CullStats culling_get_stats(void) {
+    return frameStats;
+}
@@ -1,8 +1,11 @@
-#include "pch.h"
 #include "enemy.h"
-#include "texture.h"
-#include "shader.h"
 #include "projectile.h"
+#include "physics.h"
+#include "spatial_hash.h"
+#include "enemy_steering.h"
+#include "sim_events.h"
+#include "job_system.h"
+#include "profiler.h"
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
@@ -11,117 +14,81 @@
 #include "logging.h"
 LOG_MODULE_DEFINE(__FILE__, false);
 
-// For getcwd function
-#ifdef _WIN32
-#include <direct.h>
-#define getcwd _getcwd
-#else
-#include <unistd.h>
-#endif
+// Enemy storage (struct-of-arrays, live enemies packed at the front)
+static EnemyStore enemies;
 
-// Define ground level constant
-#define GROUND_LEVEL 0.5f
+// Enemies per steering job (a multiple of 8 so AVX2 chunks stay full)
+#define ENEMY_STEER_GRAIN 4096
 
-// Enemy array
-static Enemy enemies[MAX_ENEMIES];
+// Projectiles per collision query job; each job fills its own contact list
+#define COLLISION_QUERY_GRAIN 8
+#define COLLISION_QUERY_CHUNKS ((MAX_PROJECTILES + COLLISION_QUERY_GRAIN - 1) / COLLISION_QUERY_GRAIN)
 
-// Enemy texture
-static unsigned int enemyTextureID = 0;
+// Broadphase grid over enemy positions and the pairs it reports each tick.
+// Contacts are kept per query chunk so resolution order doesn't depend on
+// which thread ran which chunk.
+static SpatialHash enemyGrid;
+static ContactList enemyContacts[COLLISION_QUERY_CHUNKS];
 
-// Enemy rendering data
-static unsigned int enemyVAO = 0;
-static unsigned int enemyVBO = 0;
+// Steering inputs for the jobs of the current tick
+static EnemySteerParams steerParams;
 
-// Enemy hit flash timer
-static float enemyHitFlashTime[MAX_ENEMIES] = {0};
+// Intermediate stages of the collision job chain
+static JobCounter collisionBuilt;
+static JobCounter collisionQueried;
+
+// Scratch flags marking enemies already damaged during the current collision pass
+static unsigned char* enemyHitThisTick = NULL;
+static int enemyHitCapacity = 0;
+
+// Monotonic spawn counter used to give each enemy its own bob/pulse phase
+static unsigned int enemySpawnCounter = 0;
+
+// Simulation time driving the shared bob phase (advanced by update_enemies)
+static float enemyTime = 0.0f;
 
 // Add these at the top of the file
 static float lastPlayerX = 0.0f;
 static float lastPlayerZ = 0.0f;
 
 
-// Initialize the enemy system
+// Initialize the enemy system (simulation state only; see enemy_render.c)
 void enemy_system_init(void) {
-    // Initialize all enemies as inactive
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        enemies[i].active = false;
+    // Allocate the enemy store (grows on demand)
+    if (!enemy_store_init(&enemies, ENEMY_STORE_INITIAL_CAPACITY)) {
+        printf("ERROR: Failed to allocate enemy store!\n");
     }
+    enemySpawnCounter = 0;
+    enemyTime = 0.0f;
     
-    // Load the enemy texture - use the Fire Skull sprite instead of slime
-    enemyTextureID = texture_load_png("assets/Fire-Skull-Files/Sprites/Fire/frame1.png");
-    
-    if (enemyTextureID == 0) {
-        printf("ERROR: Failed to load enemy texture from 'assets/Fire-Skull-Files/Sprites/Fire/frame1.png'!\n");
-        printf("Current working directory: ");
-        char cwd[256];
-        if (getcwd(cwd, sizeof(cwd)) != NULL) {
-            printf("%s\n", cwd);
-        } else {
-            printf("Unable to get current working directory\n");
-        }
-    }
-    
-    // Create a simple quad for the enemy
-    float vertices[] = {
-        // Position (XYZ), TexCoord (UV)
-        -0.5f, -0.5f, 0.0f,  0.0f, 1.0f,  // Bottom left - flip Y coordinate
-         0.5f, -0.5f, 0.0f,  1.0f, 1.0f,  // Bottom right - flip Y coordinate
-         0.5f,  0.5f, 0.0f,  1.0f, 0.0f,  // Top right - flip Y coordinate
-         0.5f,  0.5f, 0.0f,  1.0f, 0.0f,  // Top right - flip Y coordinate
-        -0.5f,  0.5f, 0.0f,  0.0f, 0.0f,  // Top left - flip Y coordinate
-        -0.5f, -0.5f, 0.0f,  0.0f, 1.0f   // Bottom left - flip Y coordinate
-    };
-    
-    // Create VAO and VBO
-    glGenVertexArrays(1, &enemyVAO);
-    glGenBuffers(1, &enemyVBO);
-    
-    glBindVertexArray(enemyVAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, enemyVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    // Resolved here, before the first tick submits steering jobs
+    enemy_steer_init();
     
-    // Texture coord attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    spatial_hash_init(&enemyGrid, SPATIAL_HASH_DEFAULT_CELL_SIZE);
 }
 
 // Spawn a new enemy
 void spawn_enemy(float x, float y, float z) {
-    // Find an inactive enemy
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (!enemies[i].active) {
-            // Initialize the enemy
-            enemies[i].x = x;
-            enemies[i].y = y + 0.5f;  // Float above the ground
-            enemies[i].z = z;
-            enemies[i].velocityX = 0.0f;
-            enemies[i].velocityZ = 0.0f;
-            enemies[i].health = 50.0f;  // Reduced from 100 to 50 for faster kills
-            enemies[i].radius = 0.3f;
-            enemies[i].active = true;
-            enemies[i].textureID = enemyTextureID;
-            
-            LOG("Spawned enemy %d at (%.2f, %.2f, %.2f)", i, x, enemies[i].y, z);
-            
-            return;
-        }
+    // Float above the ground; health reduced from 100 to 50 for faster kills
+    float phase = (float)enemySpawnCounter++;
+    int i = enemy_store_push(&enemies, x, y + 0.5f, z, 50.0f, 0.3f, phase);
+    
+    if (i < 0) {
+        LOG("Warning: Failed to grow enemy store, enemy not spawned!");
+        return;
     }
     
-    // If we get here, all enemies are active
-    LOG("Warning: No free enemies available!");
+    LOG("Spawned enemy %d at (%.2f, %.2f, %.2f)", i, x, enemies.y[i], z);
 }
 
-// Update all enemies
-void update_enemies(float deltaTime, float playerX, float playerZ) {
+// Job: steer one chunk of enemies
+static void steer_enemy_range(void* data, int begin, int end) {
+    (void)data;
+    PROFILE_SCOPE("enemies.steer") enemy_steer(&enemies, begin, end, &steerParams);
+}
+
+// Start updating all enemies; the work is done when counter reaches zero
+void update_enemies_async(float deltaTime, float playerX, float playerZ, JobCounter* counter) {
     // Store player position for rendering
     lastPlayerX = playerX;
     lastPlayerZ = playerZ;
@@ -132,188 +99,185 @@ void update_enemies(float deltaTime, float playerX, float playerZ) {
         LOG("Player position: (%.2f, %.2f, %.2f)", playerX, GROUND_LEVEL, playerZ);
     }
 
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (enemies[i].active) {
-            // Simple AI: move towards player
-            float dx = playerX - enemies[i].x;
-            float dz = playerZ - enemies[i].z;
-            float distance = sqrtf(dx * dx + dz * dz);
-            
-            // Debug output for enemy position and movement
-            if (i == 0 && debugCounter % 60 == 0) { // Print for first enemy every ~60 frames
-                LOG("Enemy %d: pos=(%.2f, %.2f, %.2f), dist=%.2f, dx=%.2f, dz=%.2f", 
-                       i, enemies[i].x, enemies[i].y, enemies[i].z, distance, dx, dz);
-            }
-            
-            // Only move if not too close to player
-            if (distance > 0.5f) {
-                // Normalize direction
-                float speed = 0.5f; // Much faster speed for more noticeable movement
-                
-                // Calculate velocity
-                enemies[i].velocityX = dx / distance * speed;
-                enemies[i].velocityZ = dz / distance * speed;
-                
-                // Debug output for velocity
-                if (i == 0 && debugCounter % 60 == 0) {
-                    LOG("Enemy %d velocity: (%.4f, %.4f)", i, enemies[i].velocityX, enemies[i].velocityZ);
-                }
-                
-                // Update position
-                float oldX = enemies[i].x;
-                float oldZ = enemies[i].z;
-                
-                enemies[i].x += enemies[i].velocityX * deltaTime;
-                enemies[i].z += enemies[i].velocityZ * deltaTime;
-                
-                // Debug output for position change
-                if (i == 0 && debugCounter % 60 == 0) {
-                    LOG("Enemy %d moved: (%.2f, %.2f) -> (%.2f, %.2f), delta=(%.4f, %.4f)", 
-                           i, oldX, oldZ, enemies[i].x, enemies[i].z, 
-                           enemies[i].x - oldX, enemies[i].z - oldZ);
-                }
-                
-                // Add a slight bobbing up and down for floating effect
-                enemies[i].y = (GROUND_LEVEL + 0.3f) + sinf(glfwGetTime() * 2.0f + i) * 0.05f;
-            } else {
-                // Too close to player, stop moving
-                enemies[i].velocityX = 0.0f;
-                enemies[i].velocityZ = 0.0f;
-                
-                if (i == 0 && debugCounter % 60 == 0) {
-                    LOG("Enemy %d too close to player, stopped moving", i);
-                }
-            }
-            
-            // Check if enemy is dead
-            if (enemies[i].health <= 0) {
-                enemies[i].active = false;
-                LOG("Enemy %d defeated!", i);
-            }
-        }
+    // Debug output for enemy position
+    if (enemies.count > 0 && debugCounter % 60 == 0) { // Print for first enemy every ~60 frames
+        LOG("Enemy 0: pos=(%.2f, %.2f, %.2f)", enemies.x[0], enemies.y[0], enemies.z[0]);
     }
+
+    // Time phase is shared by every enemy, so take its sin/cos once per tick
+    enemyTime += deltaTime;
+    float timePhase = enemyTime * 2.0f;
+
+    // Simple AI: move towards player, with a slight bob for a floating effect
+    steerParams.targetX = playerX;
+    steerParams.targetZ = playerZ;
+    steerParams.speed = 0.5f;           // Much faster speed for more noticeable movement
+    steerParams.stopDistance = 0.5f;    // Stop when this close to the player
+    steerParams.deltaTime = deltaTime;
+    steerParams.bobBaseY = GROUND_LEVEL + 0.3f;
+    steerParams.bobAmplitude = 0.05f;
+    steerParams.timeSin = sinf(timePhase);
+    steerParams.timeCos = cosf(timePhase);
+
+    // Fan the steering out across the job system
+    job_parallel_for(counter, NULL, enemies.count, ENEMY_STEER_GRAIN, steer_enemy_range, NULL);
 }
 
-// Render all enemies
-void render_enemies(Shader* shader) {
-    if (enemyVAO == 0) {
-        printf("Error: Enemy system not initialized!\n");
-        return;
-    }
+// Update all enemies and wait for the result
+void update_enemies(float deltaTime, float playerX, float playerZ) {
+    JobCounter done;
+    job_counter_init(&done);
+    update_enemies_async(deltaTime, playerX, playerZ, &done);
+    job_wait(&done);
     
-    // Count active enemies
-    int activeCount = 0;
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (enemies[i].active) {
-            activeCount++;
+    remove_dead_enemies();
+}
+
+// Remove dead enemies; swap-remove keeps the live range dense
+int remove_dead_enemies(void) {
+    // Report the dead where they fell before the sweep moves them
+    for (int i = 0; i < enemies.count; i++) {
+        if (enemies.health[i] <= 0.0f) {
+            sim_events_push(SIM_EVENT_ENEMY_KILLED, enemies.x[i], enemies.y[i], enemies.z[i], 0.0f);
         }
     }
     
-    //if (activeCount > 0) {
-    //    printf("Rendering %d active enemies\n", activeCount);
-    //}
+    int defeated = enemy_store_remove_dead(&enemies);
+    if (defeated > 0) {
+        LOG("%d enemies defeated! %d remaining", defeated, enemies.count);
+    }
+    return defeated;
+}
+
+// Clean up enemy resources
+void enemy_system_cleanup(void) {
+    enemy_store_free(&enemies);
+    spatial_hash_free(&enemyGrid);
+    for (int c = 0; c < COLLISION_QUERY_CHUNKS; c++) {
+        contact_list_free(&enemyContacts[c]);
+    }
     
-    // Bind the VAO
-    glBindVertexArray(enemyVAO);
+    free(enemyHitThisTick);
+    enemyHitThisTick = NULL;
+    enemyHitCapacity = 0;
+}
+
+// Check if an enemy is hit by a projectile
+void check_enemy_projectile_collisions(void) {
+    JobCounter done;
+    job_counter_init(&done);
+    check_enemy_projectile_collisions_async(NULL, &done);
+    job_wait(&done);
+}
+
+// Collision stage 1: tick hit flashes and bucket enemies into the grid
+static void collision_build_job(void* data, int begin, int end) {
+    (void)data; (void)begin; (void)end;
+    PROFILE_BEGIN("collision.build");
     
-    // Enable texture and set parameters
-    shader_set_bool(shader, "useTexture", true);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    // Update hit flash timers
+    for (int i = 0; i < enemies.count; i++) {
+        if (enemies.hitFlashTime[i] > 0) {
+            enemies.hitFlashTime[i] -= steerParams.deltaTime;
+        }
+    }
     
-    // Render each active enemy
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (enemies[i].active) {
-            // Create model matrix
-            mat4 model = GLM_MAT4_IDENTITY_INIT;
-            
-            // Translate to position
-            glm_translate(model, (vec3){enemies[i].x, enemies[i].y, enemies[i].z});
-            
-            // No rotation - keep sprites facing the same direction like player
-            
-            // Add a subtle pulsating scale effect
-            float time = glfwGetTime();
-            float pulseFactor = 1.0f + sinf(time * 2.0f + i) * 0.05f;
-            
-            // Scale - make fire skulls a bit larger
-            glm_scale(model, (vec3){0.7f * pulseFactor, 0.7f * pulseFactor, 0.7f * pulseFactor});
-            
-            // Set model matrix
-            shader_set_mat4(shader, "model", model);
-            
-            // Set color - make them bright but not too bright
-            vec3 color;
-            if (enemyHitFlashTime[i] > 0) {
-                // White flash when hit
-                color[0] = 2.0f;
-                color[1] = 2.0f;
-                color[2] = 2.0f;
-            } else {
-                // Normal color with bright red/orange tint for fire
-                color[0] = 2.0f;  // Red
-                color[1] = 1.0f;  // Some green to make it more orange/fire-like
-                color[2] = 0.3f;  // A bit of blue
-            }
-            shader_set_vec3(shader, "objectColor", color);
-            
-            // Bind texture
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, enemies[i].textureID);
-            
-            // Draw the enemy
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+    // Grow the per-enemy hit flags alongside the store
+    if (enemyHitCapacity < enemies.capacity) {
+        unsigned char* grown = (unsigned char*)realloc(enemyHitThisTick, (size_t)enemies.capacity);
+        if (grown) {
+            enemyHitThisTick = grown;
+            enemyHitCapacity = enemies.capacity;
         }
     }
     
-    // Unbind VAO
-    glBindVertexArray(0);
+    if (enemyHitCapacity < enemies.count ||
+        !spatial_hash_build(&enemyGrid, enemies.x, enemies.z, enemies.radius, enemies.count)) {
+        LOG("Collision broadphase unavailable this tick");
+        spatial_hash_build(&enemyGrid, enemies.x, enemies.z, enemies.radius, 0);
+        PROFILE_END();
+        return;
+    }
+    memset(enemyHitThisTick, 0, (size_t)enemies.count);
+    PROFILE_END();
 }
 
-// Clean up enemy resources
-void enemy_system_cleanup(void) {
-    if (enemyVAO != 0) {
-        glDeleteVertexArrays(1, &enemyVAO);
-        enemyVAO = 0;
-    }
+// Collision stage 2: each projectile queries the cells its circle can reach
+static void collision_query_job(void* data, int begin, int end) {
+    (void)data;
+    ContactList* contacts = &enemyContacts[begin / COLLISION_QUERY_GRAIN];
+    contact_list_clear(contacts);
     
-    if (enemyVBO != 0) {
-        glDeleteBuffers(1, &enemyVBO);
-        enemyVBO = 0;
+    const Projectile* projectiles = get_projectiles();
+    PROFILE_SCOPE("collision.query") for (int p = begin; p < end; p++) {
+        if (projectiles[p].active) {
+            spatial_hash_query_circle(&enemyGrid, projectiles[p].x, projectiles[p].z,
+                                      projectiles[p].radius, p, contacts);
+        }
     }
 }
 
-// Check if an enemy is hit by a projectile
-void check_enemy_projectile_collisions(void) {
-    for (int i = 0; i < MAX_ENEMIES; i++) {
-        if (enemies[i].active) {
-            // Update hit flash timer
-            if (enemyHitFlashTime[i] > 0) {
-                enemyHitFlashTime[i] -= 0.016f; // Assuming ~60fps
-            }
+// Collision stage 3: resolve every overlapping pair. An enemy takes at most
+// one hit per tick, and regular projectiles are consumed by the first enemy they hit.
+static void collision_resolve_job(void* data, int begin, int end) {
+    (void)data; (void)begin; (void)end;
+    const Projectile* projectiles = get_projectiles();
+    PROFILE_BEGIN("collision.resolve");
+    
+    for (int chunk = 0; chunk < COLLISION_QUERY_CHUNKS; chunk++) {
+        const ContactList* contacts = &enemyContacts[chunk];
+        
+        for (int c = 0; c < contacts->count; c++) {
+            int p = contacts->contacts[c].queryIndex;
+            int i = contacts->contacts[c].itemIndex;
             
-            // Check if this enemy collides with any projectile
-            if (check_projectile_collision(enemies[i].x, enemies[i].z, enemies[i].radius)) {
-                // Enemy was hit by a projectile
-                enemies[i].health -= 25.0f; // Reduce health
-                
-                // Set flash effect timer
-                enemyHitFlashTime[i] = 0.2f; // Flash for 0.2 seconds
-                
-                LOG("Enemy %d hit! Health: %.1f", i, enemies[i].health);
+            if (!projectiles[p].active || enemyHitThisTick[i]) {
+                continue;
             }
+            
+            // Enemy was hit by a projectile
+            enemyHitThisTick[i] = 1;
+            float damage = 25.0f;
+            enemies.health[i] -= damage; // Reduce health
+            sim_events_push(SIM_EVENT_ENEMY_HIT, enemies.x[i], enemies.y[i], enemies.z[i], damage);
+            
+            // Set flash effect timer
+            enemies.hitFlashTime[i] = 0.2f; // Flash for 0.2 seconds
+            
+            handle_projectile_collision(p);
         }
     }
+    
+    PROFILE_END();
 }
 
-// Add this function implementation
+// Start collision detection once dependency (may be NULL) drains; done when counter reaches zero
+void check_enemy_projectile_collisions_async(JobCounter* dependency, JobCounter* counter) {
+    job_counter_init(&collisionBuilt);
+    job_counter_init(&collisionQueried);
+    
+    job_submit(&collisionBuilt, dependency, collision_build_job, NULL);
+    job_parallel_for(&collisionQueried, &collisionBuilt, MAX_PROJECTILES, COLLISION_QUERY_GRAIN,
+                     collision_query_job, NULL);
+    job_submit(counter, &collisionQueried, collision_resolve_job, NULL);
+}
+
+// Live enemies are packed at the front of the store
 bool is_enemy_active(int index) {
-    if (index >= 0 && index < MAX_ENEMIES) {
-        return enemies[index].active;
-    }
-    return false;
+    return index >= 0 && index < enemies.count;
 }
 
-// Optimize collision detection to avoid checking inactive enemies 
\ No newline at end of file
+// Number of live enemies
+int get_enemy_count(void) {
+    return enemies.count;
+}
+
+// Read-only access to the enemy store
+const EnemyStore* get_enemy_store(void) {
+    return &enemies;
+}
+
+// Seconds of simulation time the enemies have been updated for
+float get_enemy_time(void) {
+    return enemyTime;
+}
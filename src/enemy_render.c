@@ -0,0 +1,305 @@
+#include "pch.h"
+#include "enemy_render.h"
+#include "enemy.h"
+#include "character_animation.h"
+#include "renderer.h"
+#include "culling.h"
+#include "gl_state.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Quad size and pulse strength of a fire skull
+#define ENEMY_SPRITE_SCALE 0.7f
+#define ENEMY_PULSE_AMOUNT 0.05f
+
+// Bounding sphere of a billboard: half the quad diagonal at the pulse peak
+#define ENEMY_CULL_RADIUS (0.70710678f * ENEMY_SPRITE_SCALE * (1.0f + ENEMY_PULSE_AMOUNT))
+
+// Instances the buffer holds before its first growth
+#define ENEMY_INSTANCE_INITIAL_CAPACITY 256
+
+// Per-instance attributes streamed to the GPU every frame
+typedef struct {
+    float x, y, z;            // Position interpolated between the last two ticks
+    float scale;              // Quad size before the pulse
+    float phaseSin, phaseCos; // Pulse phase offset
+    float flash;              // 1 while the hit flash is showing, else 0
+    float unused;             // Pads the second attribute to a vec4
+    float u0, v0, u1, v1;     // Current animation frame in the atlas
+} EnemyInstance;
+
+// Fire Skull animation (frames in the shared character atlas)
+static Sprite enemySprite;
+
+// Enemy rendering data
+static Shader enemyShader;
+static struct {
+    int timeSin, timeCos, pulseAmount;
+    int baseTint, flashTint;
+    int texture1;
+} enemyUniforms;
+static unsigned int enemyVAO = 0;
+static unsigned int enemyVBO = 0;
+static unsigned int enemyInstanceVBO = 0;
+
+// CPU staging copy of the instance buffer, the enemies that passed culling,
+// and their depth sort keys (far first)
+static EnemyInstance* enemyInstances = NULL;
+static int* visibleEnemies = NULL;
+static uint64_t* depthKeys = NULL;
+static uint64_t* depthScratch = NULL;
+static int enemyInstanceCapacity = 0;
+
+// Instances uploaded for this frame's queued draw
+static int queuedInstances = 0;
+
+// Load the enemy shader and frames and create the enemy quad
+void enemy_render_init(void) {
+    shader_init(&enemyShader, "assets/shaders/enemy_instanced.vert", "assets/shaders/enemy_instanced.frag");
+    enemyUniforms.timeSin = shader_uniform(&enemyShader, "timeSin");
+    enemyUniforms.timeCos = shader_uniform(&enemyShader, "timeCos");
+    enemyUniforms.pulseAmount = shader_uniform(&enemyShader, "pulseAmount");
+    enemyUniforms.baseTint = shader_uniform(&enemyShader, "baseTint");
+    enemyUniforms.flashTint = shader_uniform(&enemyShader, "flashTint");
+    enemyUniforms.texture1 = shader_uniform(&enemyShader, "texture1");
+    
+    // Fire Skull frames live in the shared character atlas, which loads in
+    // the background; render_enemies binds them once it is resident
+    if (!fire_skull_animation_init(&enemySprite)) {
+        printf("ERROR: Failed to load the Fire Skull frames from 'assets/Fire-Skull-Files/Sprites/Fire'!\n");
+    }
+    
+    // Create a simple quad for the enemy, in the corner order of the
+    // renderer's shared quad indices
+    float vertices[] = {
+        // Position (XYZ), TexCoord (UV)
+        -0.5f, -0.5f, 0.0f,  0.0f, 1.0f,  // Bottom left - flip Y coordinate
+         0.5f, -0.5f, 0.0f,  1.0f, 1.0f,  // Bottom right - flip Y coordinate
+         0.5f,  0.5f, 0.0f,  1.0f, 0.0f,  // Top right - flip Y coordinate
+        -0.5f,  0.5f, 0.0f,  0.0f, 0.0f   // Top left - flip Y coordinate
+    };
+    
+    // Create VAO and VBOs
+    glGenVertexArrays(1, &enemyVAO);
+    glGenBuffers(1, &enemyVBO);
+    glGenBuffers(1, &enemyInstanceVBO);
+    
+    gl_state_bind_vertex_array(enemyVAO);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, enemyVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer_quad_index_buffer());
+    
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    
+    // Texture coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    
+    // Per-instance attributes advance once per enemy instead of once per vertex
+    glBindBuffer(GL_ARRAY_BUFFER, enemyInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, ENEMY_INSTANCE_INITIAL_CAPACITY * sizeof(EnemyInstance), NULL, GL_STREAM_DRAW);
+    
+    // Center + scale
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(EnemyInstance), (void*)0);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    
+    // Phase sin/cos + hit flash
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(EnemyInstance), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    
+    // Atlas frame
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(EnemyInstance), (void*)(8 * sizeof(float)));
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+    
+    // Unbind
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    gl_state_bind_vertex_array(0);
+}
+
+// Make sure the staging array and GPU buffer can hold count instances
+static bool reserve_instances(int count) {
+    if (count <= enemyInstanceCapacity) {
+        return true;
+    }
+    
+    int capacity = enemyInstanceCapacity > 0 ? enemyInstanceCapacity : ENEMY_INSTANCE_INITIAL_CAPACITY;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    
+    EnemyInstance* grown = (EnemyInstance*)realloc(enemyInstances, (size_t)capacity * sizeof(EnemyInstance));
+    if (grown) {
+        enemyInstances = grown;
+    }
+    int* grownVisible = (int*)realloc(visibleEnemies, (size_t)capacity * sizeof(int));
+    if (grownVisible) {
+        visibleEnemies = grownVisible;
+    }
+    uint64_t* grownKeys = (uint64_t*)realloc(depthKeys, (size_t)capacity * sizeof(uint64_t));
+    if (grownKeys) {
+        depthKeys = grownKeys;
+    }
+    uint64_t* grownScratch = (uint64_t*)realloc(depthScratch, (size_t)capacity * sizeof(uint64_t));
+    if (grownScratch) {
+        depthScratch = grownScratch;
+    }
+    if (!grown || !grownVisible || !grownKeys || !grownScratch) {
+        printf("ERROR: Failed to grow enemy instance buffer to %d enemies!\n", capacity);
+        return false;
+    }
+    
+    enemyInstanceCapacity = capacity;
+    return true;
+}
+
+// Render queue callback: the enemy shader, atlas and quad VAO are already bound
+static void draw_enemies_item(void* data) {
+    (void)data;
+    
+    // sin(time + phase) is expanded per instance, so only take the trig once
+    float timePhase = get_enemy_time() * 2.0f;
+    shader_uniform_float(&enemyShader, enemyUniforms.timeSin, sinf(timePhase));
+    shader_uniform_float(&enemyShader, enemyUniforms.timeCos, cosf(timePhase));
+    shader_uniform_float(&enemyShader, enemyUniforms.pulseAmount, ENEMY_PULSE_AMOUNT);
+    
+    // Bright red/orange fire tint, white when hit
+    shader_uniform_vec3(&enemyShader, enemyUniforms.baseTint, (vec3){2.0f, 1.0f, 0.3f});
+    shader_uniform_vec3(&enemyShader, enemyUniforms.flashTint, (vec3){2.0f, 2.0f, 2.0f});
+    shader_uniform_int(&enemyShader, enemyUniforms.texture1, 0);
+    
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0, queuedInstances);
+}
+
+// Queue all visible enemies as one instanced draw
+void render_enemies(float alpha) {
+    if (enemyVAO == 0) {
+        printf("Error: Enemy system not initialized!\n");
+        return;
+    }
+    
+    const EnemyStore* enemies = get_enemy_store();
+    int count = enemies->count;
+    if (count == 0 || !fire_skull_animation_bind(&enemySprite) || !reserve_instances(count)) {
+        return;
+    }
+    
+    // Each enemy plays the loop offset by its pulse phase so the horde doesn't flicker in sync
+    float framePosition = get_enemy_time() / enemySprite.frameDuration;
+    float framesPerRadian = (float)enemySprite.frameCount / (2.0f * (float)M_PI);
+    
+    // Only enemies inside the camera frustum reach the instance buffer
+    CullPositions positions = {
+        enemies->x, enemies->y, enemies->z,
+        enemies->prevX, enemies->prevY, enemies->prevZ,
+        alpha
+    };
+    int visibleCount = culling_cull_spheres(&positions, count, ENEMY_CULL_RADIUS, visibleEnemies);
+    if (visibleCount == 0) {
+        return;
+    }
+    
+    // Overlapping billboards blend correctly only back to front: key each
+    // visible enemy by inverted view depth, with its slot in the low bits
+    vec3 center = {0.0f, 0.0f, 0.0f};
+    for (int v = 0; v < visibleCount; v++) {
+        int i = visibleEnemies[v];
+        vec3 position = {
+            enemies->prevX[i] + (enemies->x[i] - enemies->prevX[i]) * alpha,
+            enemies->prevY[i] + (enemies->y[i] - enemies->prevY[i]) * alpha,
+            enemies->prevZ[i] + (enemies->z[i] - enemies->prevZ[i]) * alpha
+        };
+        glm_vec3_add(center, position, center);
+        
+        float depth = renderer_view_depth(position) / RENDERER_MAX_DEPTH;
+        depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+        uint64_t farFirst = (uint64_t)UINT32_MAX - (uint64_t)((double)depth * (double)UINT32_MAX);
+        depthKeys[v] = (farFirst << 32) | (uint64_t)v;
+    }
+    renderer_sort_keys(depthKeys, depthScratch, visibleCount);
+    
+    // Pack the visible enemies far to near, interpolating between the last two ticks
+    for (int slot = 0; slot < visibleCount; slot++) {
+        int i = visibleEnemies[depthKeys[slot] & UINT32_MAX];
+        EnemyInstance* instance = &enemyInstances[slot];
+        instance->x = enemies->prevX[i] + (enemies->x[i] - enemies->prevX[i]) * alpha;
+        instance->y = enemies->prevY[i] + (enemies->y[i] - enemies->prevY[i]) * alpha;
+        instance->z = enemies->prevZ[i] + (enemies->z[i] - enemies->prevZ[i]) * alpha;
+        instance->scale = ENEMY_SPRITE_SCALE;
+        instance->phaseSin = enemies->phaseSin[i];
+        instance->phaseCos = enemies->phaseCos[i];
+        instance->flash = enemies->hitFlashTime[i] > 0 ? 1.0f : 0.0f;
+        instance->unused = 0.0f;
+        
+        float phase = atan2f(enemies->phaseSin[i], enemies->phaseCos[i]) + (float)M_PI;
+        int frame = (int)(framePosition + phase * framesPerRadian) % enemySprite.frameCount;
+        const float* uv = enemySprite.frameUVs[frame];
+        instance->u0 = uv[0];
+        instance->v0 = uv[1];
+        instance->u1 = uv[2];
+        instance->v1 = uv[3];
+    }
+    
+    // Orphan the old storage so the driver doesn't stall on last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, enemyInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)enemyInstanceCapacity * sizeof(EnemyInstance), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)visibleCount * sizeof(EnemyInstance), enemyInstances);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    // One item for the horde, sorted among the other sprites at its centroid
+    queuedInstances = visibleCount;
+    RenderItem item = {
+        RENDER_LAYER_TRANSPARENT,
+        RENDER_BLEND_PREMULTIPLIED,
+        &enemyShader,
+        enemySprite.textureID,    // Every enemy samples the shared character atlas
+        SAMPLER_PIXEL_ART_MIPMAPPED,
+        enemyVAO,
+        {center[0] / visibleCount, center[1] / visibleCount, center[2] / visibleCount},
+        draw_enemies_item,
+        NULL
+    };
+    renderer_submit(&item);
+}
+
+// Release the enemy shader, texture, quad and instance buffer
+void enemy_render_cleanup(void) {
+    if (enemyVAO != 0) {
+        gl_state_delete_vertex_arrays(1, &enemyVAO);
+        enemyVAO = 0;
+    }
+    
+    if (enemyVBO != 0) {
+        glDeleteBuffers(1, &enemyVBO);
+        enemyVBO = 0;
+    }
+    
+    if (enemyInstanceVBO != 0) {
+        glDeleteBuffers(1, &enemyInstanceVBO);
+        enemyInstanceVBO = 0;
+    }
+    
+    fire_skull_animation_cleanup(&enemySprite);
+    
+    shader_cleanup(&enemyShader);
+    
+    free(enemyInstances);
+    enemyInstances = NULL;
+    free(visibleEnemies);
+    visibleEnemies = NULL;
+    free(depthKeys);
+    depthKeys = NULL;
+    free(depthScratch);
+    depthScratch = NULL;
+    enemyInstanceCapacity = 0;
+}
@@ -0,0 +1,255 @@
+#include "enemy_steering.h"
+#include <math.h>
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// SIMD kernels are only built for x86; other targets use the scalar path
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ENEMY_STEER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang need the AVX2 kernel tagged so it builds without a global -mavx2
+#if defined(__GNUC__) || defined(__clang__)
+#define ENEMY_STEER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ENEMY_STEER_TARGET_AVX2
+#endif
+
+// Reference kernel. The SIMD kernels follow the same operation order, so
+// they only differ by the reciprocal square root estimate (~1e-6 relative).
+static void steer_scalar(EnemyStore* store, int begin, int end, const EnemySteerParams* params) {
+    float stop2 = params->stopDistance * params->stopDistance;
+
+    for (int i = begin; i < end; i++) {
+        store->prevX[i] = store->x[i];
+        store->prevY[i] = store->y[i];
+        store->prevZ[i] = store->z[i];
+
+        float dx = params->targetX - store->x[i];
+        float dz = params->targetZ - store->z[i];
+        float distance2 = dx * dx + dz * dz;
+
+        // Only move if not too close to the target
+        if (distance2 > stop2) {
+            float scale = (1.0f / sqrtf(distance2)) * params->speed;
+            store->velocityX[i] = dx * scale;
+            store->velocityZ[i] = dz * scale;
+
+            store->x[i] += store->velocityX[i] * params->deltaTime;
+            store->z[i] += store->velocityZ[i] * params->deltaTime;
+
+            // sin(time + phase) expanded so the loop needs no trig
+            float bob = params->timeSin * store->phaseCos[i] + params->timeCos * store->phaseSin[i];
+            store->y[i] = params->bobBaseY + bob * params->bobAmplitude;
+        } else {
+            store->velocityX[i] = 0.0f;
+            store->velocityZ[i] = 0.0f;
+        }
+    }
+}
+
+#ifdef ENEMY_STEER_X86
+
+// 4 enemies per iteration; SSE2 is baseline on x86-64
+static void steer_sse2(EnemyStore* store, int begin, int end, const EnemySteerParams* params) {
+    const __m128 targetX = _mm_set1_ps(params->targetX);
+    const __m128 targetZ = _mm_set1_ps(params->targetZ);
+    const __m128 stop2 = _mm_set1_ps(params->stopDistance * params->stopDistance);
+    const __m128 speed = _mm_set1_ps(params->speed);
+    const __m128 deltaTime = _mm_set1_ps(params->deltaTime);
+    const __m128 bobBase = _mm_set1_ps(params->bobBaseY);
+    const __m128 bobAmplitude = _mm_set1_ps(params->bobAmplitude);
+    const __m128 timeSin = _mm_set1_ps(params->timeSin);
+    const __m128 timeCos = _mm_set1_ps(params->timeCos);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 threeHalves = _mm_set1_ps(1.5f);
+
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(store->x + i);
+        __m128 z = _mm_loadu_ps(store->z + i);
+        __m128 y = _mm_loadu_ps(store->y + i);
+        _mm_storeu_ps(store->prevX + i, x);
+        _mm_storeu_ps(store->prevY + i, y);
+        _mm_storeu_ps(store->prevZ + i, z);
+        __m128 dx = _mm_sub_ps(targetX, x);
+        __m128 dz = _mm_sub_ps(targetZ, z);
+        __m128 distance2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+        __m128 moving = _mm_cmpgt_ps(distance2, stop2);
+
+        // rsqrt estimate refined with one Newton-Raphson step
+        __m128 inv = _mm_rsqrt_ps(distance2);
+        inv = _mm_mul_ps(inv, _mm_sub_ps(threeHalves,
+                  _mm_mul_ps(_mm_mul_ps(half, distance2), _mm_mul_ps(inv, inv))));
+
+        // Masking the scale zeroes velocity for stopped lanes (and drops inf from d2 == 0)
+        __m128 scale = _mm_and_ps(moving, _mm_mul_ps(inv, speed));
+        __m128 velocityX = _mm_mul_ps(dx, scale);
+        __m128 velocityZ = _mm_mul_ps(dz, scale);
+        _mm_storeu_ps(store->velocityX + i, velocityX);
+        _mm_storeu_ps(store->velocityZ + i, velocityZ);
+
+        _mm_storeu_ps(store->x + i, _mm_add_ps(x, _mm_mul_ps(velocityX, deltaTime)));
+        _mm_storeu_ps(store->z + i, _mm_add_ps(z, _mm_mul_ps(velocityZ, deltaTime)));
+
+        // Only moving enemies bob
+        __m128 bob = _mm_add_ps(_mm_mul_ps(timeSin, _mm_loadu_ps(store->phaseCos + i)),
+                                _mm_mul_ps(timeCos, _mm_loadu_ps(store->phaseSin + i)));
+        bob = _mm_add_ps(bobBase, _mm_mul_ps(bob, bobAmplitude));
+        y = _mm_or_ps(_mm_and_ps(moving, bob), _mm_andnot_ps(moving, y));
+        _mm_storeu_ps(store->y + i, y);
+    }
+
+    // Remainder
+    steer_scalar(store, i, end, params);
+}
+
+// 8 enemies per iteration
+ENEMY_STEER_TARGET_AVX2
+static void steer_avx2(EnemyStore* store, int begin, int end, const EnemySteerParams* params) {
+    const __m256 targetX = _mm256_set1_ps(params->targetX);
+    const __m256 targetZ = _mm256_set1_ps(params->targetZ);
+    const __m256 stop2 = _mm256_set1_ps(params->stopDistance * params->stopDistance);
+    const __m256 speed = _mm256_set1_ps(params->speed);
+    const __m256 deltaTime = _mm256_set1_ps(params->deltaTime);
+    const __m256 bobBase = _mm256_set1_ps(params->bobBaseY);
+    const __m256 bobAmplitude = _mm256_set1_ps(params->bobAmplitude);
+    const __m256 timeSin = _mm256_set1_ps(params->timeSin);
+    const __m256 timeCos = _mm256_set1_ps(params->timeCos);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 threeHalves = _mm256_set1_ps(1.5f);
+
+    int i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 x = _mm256_loadu_ps(store->x + i);
+        __m256 z = _mm256_loadu_ps(store->z + i);
+        __m256 y = _mm256_loadu_ps(store->y + i);
+        _mm256_storeu_ps(store->prevX + i, x);
+        _mm256_storeu_ps(store->prevY + i, y);
+        _mm256_storeu_ps(store->prevZ + i, z);
+        __m256 dx = _mm256_sub_ps(targetX, x);
+        __m256 dz = _mm256_sub_ps(targetZ, z);
+        __m256 distance2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+        __m256 moving = _mm256_cmp_ps(distance2, stop2, _CMP_GT_OQ);
+
+        __m256 inv = _mm256_rsqrt_ps(distance2);
+        inv = _mm256_mul_ps(inv, _mm256_sub_ps(threeHalves,
+                  _mm256_mul_ps(_mm256_mul_ps(half, distance2), _mm256_mul_ps(inv, inv))));
+
+        __m256 scale = _mm256_and_ps(moving, _mm256_mul_ps(inv, speed));
+        __m256 velocityX = _mm256_mul_ps(dx, scale);
+        __m256 velocityZ = _mm256_mul_ps(dz, scale);
+        _mm256_storeu_ps(store->velocityX + i, velocityX);
+        _mm256_storeu_ps(store->velocityZ + i, velocityZ);
+
+        _mm256_storeu_ps(store->x + i, _mm256_add_ps(x, _mm256_mul_ps(velocityX, deltaTime)));
+        _mm256_storeu_ps(store->z + i, _mm256_add_ps(z, _mm256_mul_ps(velocityZ, deltaTime)));
+
+        __m256 bob = _mm256_add_ps(_mm256_mul_ps(timeSin, _mm256_loadu_ps(store->phaseCos + i)),
+                                   _mm256_mul_ps(timeCos, _mm256_loadu_ps(store->phaseSin + i)));
+        bob = _mm256_add_ps(bobBase, _mm256_mul_ps(bob, bobAmplitude));
+        _mm256_storeu_ps(store->y + i, _mm256_blendv_ps(y, bob, moving));
+    }
+
+    // Remainder
+    steer_sse2(store, i, end, params);
+}
+
+// Runtime AVX2 check (CPU flag plus OS support for saving YMM registers)
+static bool cpu_has_avx2(void) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // ENEMY_STEER_X86
+
+// Kernel chosen by enemy_steer_init. Written once before any steering job
+// runs and only read afterwards, so the jobs need no synchronization.
+static EnemySteerKernel bestKernel = ENEMY_STEER_KERNEL_AUTO;
+
+// Query the CPU for the fastest supported kernel
+static EnemySteerKernel detect_best_kernel(void) {
+#ifdef ENEMY_STEER_X86
+    return cpu_has_avx2() ? ENEMY_STEER_KERNEL_AVX2 : ENEMY_STEER_KERNEL_SSE2;
+#else
+    return ENEMY_STEER_KERNEL_SCALAR;
+#endif
+}
+
+// Pick the kernel for this CPU
+void enemy_steer_init(void) {
+    bestKernel = detect_best_kernel();
+    LOG("Enemy steering kernel: %s", enemy_steer_kernel_name(bestKernel));
+}
+
+// Kernel that ENEMY_STEER_KERNEL_AUTO resolves to on this CPU
+EnemySteerKernel enemy_steer_best_kernel(void) {
+    // Without enemy_steer_init, detect on every call rather than write shared state
+    return bestKernel != ENEMY_STEER_KERNEL_AUTO ? bestKernel : detect_best_kernel();
+}
+
+// Same as enemy_steer but with an explicit kernel
+void enemy_steer_with_kernel(EnemySteerKernel kernel, EnemyStore* store, int begin, int end,
+                             const EnemySteerParams* params) {
+    if (kernel == ENEMY_STEER_KERNEL_AUTO) {
+        kernel = enemy_steer_best_kernel();
+    }
+
+    switch (kernel) {
+#ifdef ENEMY_STEER_X86
+        case ENEMY_STEER_KERNEL_AVX2:
+            if (enemy_steer_best_kernel() == ENEMY_STEER_KERNEL_AVX2) {
+                steer_avx2(store, begin, end, params);
+                return;
+            }
+            steer_sse2(store, begin, end, params);
+            return;
+        case ENEMY_STEER_KERNEL_SSE2:
+            steer_sse2(store, begin, end, params);
+            return;
+#endif
+        default:
+            steer_scalar(store, begin, end, params);
+            return;
+    }
+}
+
+// Seek, integrate and bob enemies [begin, end) using the best available kernel
+void enemy_steer(EnemyStore* store, int begin, int end, const EnemySteerParams* params) {
+    enemy_steer_with_kernel(ENEMY_STEER_KERNEL_AUTO, store, begin, end, params);
+}
+
+// Human-readable kernel name for logs and benchmarks
+const char* enemy_steer_kernel_name(EnemySteerKernel kernel) {
+    switch (kernel) {
+        case ENEMY_STEER_KERNEL_AUTO:   return "auto";
+        case ENEMY_STEER_KERNEL_SCALAR: return "scalar";
+        case ENEMY_STEER_KERNEL_SSE2:   return "sse2";
+        case ENEMY_STEER_KERNEL_AVX2:   return "avx2";
+    }
+    return "unknown";
+}
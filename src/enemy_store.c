@@ -0,0 +1,153 @@
+#include "enemy_store.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Grow a single float array to the new capacity
+static bool grow_array(float** array, int capacity) {
+    float* grown = (float*)realloc(*array, (size_t)capacity * sizeof(float));
+    if (!grown) {
+        return false;
+    }
+    *array = grown;
+    return true;
+}
+
+// Allocate the arrays with room for initialCapacity enemies
+bool enemy_store_init(EnemyStore* store, int initialCapacity) {
+    memset(store, 0, sizeof(*store));
+
+    if (initialCapacity < 1) {
+        initialCapacity = ENEMY_STORE_INITIAL_CAPACITY;
+    }
+
+    return enemy_store_reserve(store, initialCapacity);
+}
+
+// Grow the arrays so at least capacity enemies fit
+bool enemy_store_reserve(EnemyStore* store, int capacity) {
+    if (capacity <= store->capacity) {
+        return true;
+    }
+
+    // Round up to the next doubling so repeated pushes stay amortized O(1)
+    int newCapacity = store->capacity > 0 ? store->capacity : ENEMY_STORE_INITIAL_CAPACITY;
+    while (newCapacity < capacity) {
+        newCapacity *= 2;
+    }
+
+    if (!grow_array(&store->x, newCapacity) ||
+        !grow_array(&store->y, newCapacity) ||
+        !grow_array(&store->z, newCapacity) ||
+        !grow_array(&store->prevX, newCapacity) ||
+        !grow_array(&store->prevY, newCapacity) ||
+        !grow_array(&store->prevZ, newCapacity) ||
+        !grow_array(&store->velocityX, newCapacity) ||
+        !grow_array(&store->velocityZ, newCapacity) ||
+        !grow_array(&store->health, newCapacity) ||
+        !grow_array(&store->radius, newCapacity) ||
+        !grow_array(&store->hitFlashTime, newCapacity) ||
+        !grow_array(&store->phaseSin, newCapacity) ||
+        !grow_array(&store->phaseCos, newCapacity)) {
+        LOG("Failed to grow enemy store to %d enemies", newCapacity);
+        return false;
+    }
+
+    LOG("Enemy store grown from %d to %d enemies", store->capacity, newCapacity);
+    store->capacity = newCapacity;
+    return true;
+}
+
+// Append an enemy, growing if needed. Returns its index or -1 on failure
+int enemy_store_push(EnemyStore* store, float x, float y, float z, float health, float radius, float phase) {
+    if (store->count == store->capacity && !enemy_store_reserve(store, store->count + 1)) {
+        return -1;
+    }
+
+    int i = store->count++;
+    store->x[i] = x;
+    store->y[i] = y;
+    store->z[i] = z;
+    store->prevX[i] = x;
+    store->prevY[i] = y;
+    store->prevZ[i] = z;
+    store->velocityX[i] = 0.0f;
+    store->velocityZ[i] = 0.0f;
+    store->health[i] = health;
+    store->radius[i] = radius;
+    store->hitFlashTime[i] = 0.0f;
+    // Keep sin/cos of the phase so per-tick bobbing needs no trig:
+    // sin(t + phase) = sin(t) * cos(phase) + cos(t) * sin(phase)
+    store->phaseSin[i] = sinf(phase);
+    store->phaseCos[i] = cosf(phase);
+    return i;
+}
+
+// Remove the enemy at index by moving the last live enemy into its slot
+void enemy_store_remove(EnemyStore* store, int index) {
+    if (index < 0 || index >= store->count) {
+        return;
+    }
+
+    int last = --store->count;
+    if (index != last) {
+        store->x[index] = store->x[last];
+        store->y[index] = store->y[last];
+        store->z[index] = store->z[last];
+        store->prevX[index] = store->prevX[last];
+        store->prevY[index] = store->prevY[last];
+        store->prevZ[index] = store->prevZ[last];
+        store->velocityX[index] = store->velocityX[last];
+        store->velocityZ[index] = store->velocityZ[last];
+        store->health[index] = store->health[last];
+        store->radius[index] = store->radius[last];
+        store->hitFlashTime[index] = store->hitFlashTime[last];
+        store->phaseSin[index] = store->phaseSin[last];
+        store->phaseCos[index] = store->phaseCos[last];
+    }
+}
+
+// Remove every enemy whose health dropped to zero. Returns how many were removed
+int enemy_store_remove_dead(EnemyStore* store) {
+    int removed = 0;
+
+    // Don't advance after a removal: the swapped-in enemy still needs checking
+    int i = 0;
+    while (i < store->count) {
+        if (store->health[i] <= 0.0f) {
+            enemy_store_remove(store, i);
+            removed++;
+        } else {
+            i++;
+        }
+    }
+
+    return removed;
+}
+
+// Drop all enemies but keep the allocation
+void enemy_store_clear(EnemyStore* store) {
+    store->count = 0;
+}
+
+// Release all arrays
+void enemy_store_free(EnemyStore* store) {
+    free(store->x);
+    free(store->y);
+    free(store->z);
+    free(store->prevX);
+    free(store->prevY);
+    free(store->prevZ);
+    free(store->velocityX);
+    free(store->velocityZ);
+    free(store->health);
+    free(store->radius);
+    free(store->hitFlashTime);
+    free(store->phaseSin);
+    free(store->phaseCos);
+    memset(store, 0, sizeof(*store));
+}
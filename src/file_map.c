@@ -0,0 +1,89 @@
+// mmap is POSIX, not ISO C
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "file_map.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Map the whole file read-only
+bool file_map_open(MappedFile* file, const char* path) {
+    memset(file, 0, sizeof(*file));
+    
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(handle);
+        return false;
+    }
+    
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+    
+    file->fileHandle = handle;
+    file->mappingHandle = mapping;
+    file->data = (const unsigned char*)view;
+    file->size = (size_t)fileSize.QuadPart;
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    
+    void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    
+    file->data = (const unsigned char*)view;
+    file->size = (size_t)info.st_size;
+    return true;
+#endif
+}
+
+// Unmap the file
+void file_map_close(MappedFile* file) {
+    if (file->data) {
+#ifdef _WIN32
+        UnmapViewOfFile((void*)file->data);
+        CloseHandle((HANDLE)file->mappingHandle);
+        CloseHandle((HANDLE)file->fileHandle);
+#else
+        munmap((void*)file->data, file->size);
+#endif
+    }
+    memset(file, 0, sizeof(*file));
+}
@@ -0,0 +1,39 @@
+#include "frame_uniforms.h"
+#include "shader.h"
+#include <stddef.h>
+
+_Static_assert(offsetof(FrameUniforms, viewProj) == 128, "FrameUniforms must match std140");
+_Static_assert(offsetof(FrameUniforms, cameraPos) == 192, "FrameUniforms must match std140");
+_Static_assert(offsetof(FrameUniforms, time) == 240, "FrameUniforms must match std140");
+_Static_assert(sizeof(FrameUniforms) == 256, "FrameUniforms must match std140");
+
+static unsigned int frameUBO = 0;
+
+// Create the uniform buffer and bind it to SHADER_FRAME_DATA_BINDING
+void frame_uniforms_init(void) {
+    glGenBuffers(1, &frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    
+    // The binding point never changes, so programs linked later pick it up too
+    glBindBufferBase(GL_UNIFORM_BUFFER, SHADER_FRAME_DATA_BINDING, frameUBO);
+}
+
+// Upload this frame's camera and light data (one buffer write for all programs)
+void frame_uniforms_update(const FrameUniforms* frame) {
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    
+    // Orphan last frame's storage so the write doesn't wait on its draws
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), frame);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Release the uniform buffer
+void frame_uniforms_cleanup(void) {
+    if (frameUBO != 0) {
+        glDeleteBuffers(1, &frameUBO);
+        frameUBO = 0;
+    }
+}
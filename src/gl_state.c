@@ -0,0 +1,157 @@
+#include "gl_state.h"
+#include <string.h>
+
+// Capabilities with a shadow flag, in the order of the enabled[] array
+static const GLenum trackedCapabilities[] = {
+    GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST,
+    GL_RASTERIZER_DISCARD, GL_PROGRAM_POINT_SIZE
+};
+#define GL_STATE_CAPABILITY_COUNT (int)(sizeof(trackedCapabilities) / sizeof(trackedCapabilities[0]))
+
+// A value of -1 means unknown: the next set always reaches GL
+static struct {
+    long long program;
+    long long vertexArray;
+    int activeUnit;
+    long long textures[GL_STATE_TEXTURE_UNITS];
+    long long samplers[GL_STATE_TEXTURE_UNITS];
+    int enabled[GL_STATE_CAPABILITY_COUNT];
+    long long blendSource;
+    long long blendDestination;
+    int depthMask;
+} state;
+
+static bool stateValid = false;
+static GLStateStats stats;
+
+void gl_state_invalidate(void) {
+    state.program = -1;
+    state.vertexArray = -1;
+    state.activeUnit = -1;
+    for (int i = 0; i < GL_STATE_TEXTURE_UNITS; i++) {
+        state.textures[i] = -1;
+        state.samplers[i] = -1;
+    }
+    for (int i = 0; i < GL_STATE_CAPABILITY_COUNT; i++) {
+        state.enabled[i] = -1;
+    }
+    state.blendSource = -1;
+    state.blendDestination = -1;
+    state.depthMask = -1;
+    stateValid = true;
+}
+
+// Count a set of kind; returns true if it has to reach GL
+static bool changed(GLStateKind kind, bool differs) {
+    if (!stateValid) {
+        gl_state_invalidate();
+        differs = true;
+    }
+    if (differs) {
+        stats.issued[kind]++;
+    } else {
+        stats.skipped[kind]++;
+    }
+    return differs;
+}
+
+void gl_state_use_program(GLuint program) {
+    if (changed(GL_STATE_PROGRAM, state.program != (long long)program)) {
+        glUseProgram(program);
+        state.program = program;
+    }
+}
+
+void gl_state_bind_vertex_array(GLuint vao) {
+    if (changed(GL_STATE_VERTEX_ARRAY, state.vertexArray != (long long)vao)) {
+        glBindVertexArray(vao);
+        state.vertexArray = vao;
+    }
+}
+
+static void set_active_unit(int unit) {
+    if (state.activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + (GLenum)unit);
+        state.activeUnit = unit;
+    }
+}
+
+void gl_state_bind_texture(int unit, GLuint texture) {
+    if (changed(GL_STATE_TEXTURE, state.textures[unit] != (long long)texture)) {
+        set_active_unit(unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        state.textures[unit] = texture;
+    }
+}
+
+void gl_state_bind_sampler(int unit, GLuint sampler) {
+    // Samplers bind by unit index, no active unit involved
+    if (changed(GL_STATE_SAMPLER, state.samplers[unit] != (long long)sampler)) {
+        glBindSampler((GLuint)unit, sampler);
+        state.samplers[unit] = sampler;
+    }
+}
+
+void gl_state_set_enabled(GLenum capability, bool enabled) {
+    int index = 0;
+    while (index < GL_STATE_CAPABILITY_COUNT && trackedCapabilities[index] != capability) {
+        index++;
+    }
+    
+    // Untracked capabilities always pass through
+    bool tracked = index < GL_STATE_CAPABILITY_COUNT;
+    if (changed(GL_STATE_CAPABILITY, !tracked || state.enabled[index] != (int)enabled)) {
+        if (enabled) {
+            glEnable(capability);
+        } else {
+            glDisable(capability);
+        }
+        if (tracked) {
+            state.enabled[index] = (int)enabled;
+        }
+    }
+}
+
+void gl_state_blend_func(GLenum source, GLenum destination) {
+    if (changed(GL_STATE_BLEND_FUNC, state.blendSource != (long long)source ||
+                                     state.blendDestination != (long long)destination)) {
+        glBlendFunc(source, destination);
+        state.blendSource = source;
+        state.blendDestination = destination;
+    }
+}
+
+void gl_state_depth_mask(bool write) {
+    if (changed(GL_STATE_DEPTH_MASK, state.depthMask != (int)write)) {
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+        state.depthMask = (int)write;
+    }
+}
+
+void gl_state_delete_textures(GLsizei count, const GLuint* textures) {
+    for (GLsizei i = 0; i < count; i++) {
+        for (int unit = 0; unit < GL_STATE_TEXTURE_UNITS; unit++) {
+            if (state.textures[unit] == (long long)textures[i]) {
+                state.textures[unit] = 0;
+            }
+        }
+    }
+    glDeleteTextures(count, textures);
+}
+
+void gl_state_delete_vertex_arrays(GLsizei count, const GLuint* vertexArrays) {
+    for (GLsizei i = 0; i < count; i++) {
+        if (state.vertexArray == (long long)vertexArrays[i]) {
+            state.vertexArray = 0;
+        }
+    }
+    glDeleteVertexArrays(count, vertexArrays);
+}
+
+GLStateStats gl_state_get_stats(void) {
+    return stats;
+}
+
+void gl_state_reset_stats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
@@ -1,311 +1,136 @@
 #define CGLTF_IMPLEMENTATION
 #include "cgltf.h"
 #include <stdio.h>
-#include "glb_loader.h"
-#include <GLFW/glfw3.h>
 #include <stdlib.h>
+#include <string.h>
+#include "glb_loader.h"
+#include "gl_state.h"
+
+// One uploaded file
+typedef struct {
+    char* path;
+    Model model;
+} GLBCacheEntry;
 
-// Global variable to store the loaded model
-static cgltf_data* model = NULL;
+static GLBCacheEntry glbCache[GLB_CACHE_SIZE];
+static int glbCacheCount = 0;
 
-// Global variables for textures
-static GLuint* texture_ids = NULL;
-static size_t texture_count = 0;
+// Model drawn by renderGLBModel
+static Model* currentModel = NULL;
+
+// Fallback cube (positions and normals), created on first use
+static unsigned int cubeVAO = 0;
+static unsigned int cubeVBO = 0;
 
 // Function to load a GLB file
-void loadGLB(const char* filename) {
-    cgltf_options options = {0};
-    cgltf_result result = cgltf_parse_file(&options, filename, &model);
+Model* loadGLB(const char* filename) {
+    for (int i = 0; i < glbCacheCount; i++) {
+        if (strcmp(glbCache[i].path, filename) == 0) {
+            currentModel = &glbCache[i].model;
+            return currentModel;
+        }
+    }
     
-    if (result != cgltf_result_success) {
-        printf("Failed to load GLB file: %s\n", filename);
-        return;
+    if (glbCacheCount == GLB_CACHE_SIZE) {
+        printf("ERROR: GLB cache full, cannot load %s\n", filename);
+        return NULL;
     }
     
-    // Load buffers
-    result = cgltf_load_buffers(&options, model, filename);
-    if (result != cgltf_result_success) {
-        printf("Failed to load GLB buffers\n");
-        cgltf_free(model);
-        model = NULL;
-        return;
+    GLBCacheEntry* entry = &glbCache[glbCacheCount];
+    model_load(&entry->model, filename);
+    if (entry->model.meshCount == 0) {
+        printf("Failed to load GLB file: %s\n", filename);
+        model_cleanup(&entry->model);
+        return NULL;
     }
     
+    size_t length = strlen(filename) + 1;
+    entry->path = (char*)malloc(length);
+    memcpy(entry->path, filename, length);
+    glbCacheCount++;
+    
     printf("Successfully loaded GLB file: %s\n", filename);
+    currentModel = &entry->model;
+    return currentModel;
 }
 
-// Function to load textures from the model
-void loadTextures() {
-    if (!model || texture_ids) return; // Already loaded or no model
+// Build the unit cube drawn when no model is loaded
+static void create_fallback_cube(void) {
+    // One face per row: normal, then the 4 corners as (sign x, sign y, sign z)
+    static const float faces[6][15] = {
+        { 0,  0,  1,  -1, -1,  1,   1, -1,  1,   1,  1,  1,  -1,  1,  1},  // Front
+        { 0,  0, -1,  -1, -1, -1,  -1,  1, -1,   1,  1, -1,   1, -1, -1},  // Back
+        { 0,  1,  0,  -1,  1, -1,  -1,  1,  1,   1,  1,  1,   1,  1, -1},  // Top
+        { 0, -1,  0,  -1, -1, -1,   1, -1, -1,   1, -1,  1,  -1, -1,  1},  // Bottom
+        { 1,  0,  0,   1, -1, -1,   1,  1, -1,   1,  1,  1,   1, -1,  1},  // Right
+        {-1,  0,  0,  -1, -1, -1,  -1, -1,  1,  -1,  1,  1,  -1,  1, -1}   // Left
+    };
+    static const int corners[6] = {0, 1, 2, 0, 2, 3};
     
-    // Count images
-    texture_count = model->images_count;
-    if (texture_count == 0) {
-        // If no textures in the model, we'll create a default yellow texture
-        texture_count = 1;
-        texture_ids = (GLuint*)malloc(texture_count * sizeof(GLuint));
-        glGenTextures(texture_count, texture_ids);
-        
-        // Create a simple yellow texture
-        glBindTexture(GL_TEXTURE_2D, texture_ids[0]);
-        
-        // Set texture parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        // Create a simple 2x2 yellow texture
-        unsigned char yellowTexture[4 * 3] = {
-            255, 255, 0,  255, 255, 0,  // Yellow pixels
-            255, 255, 0,  255, 255, 0
-        };
-        
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 2, 2, 0, GL_RGB, GL_UNSIGNED_BYTE, yellowTexture);
-        
-        // Unbind texture
-        glBindTexture(GL_TEXTURE_2D, 0);
-        return;
+    // Two triangles per face, position + normal per vertex
+    float vertices[6 * 6 * 6];
+    int index = 0;
+    for (int face = 0; face < 6; face++) {
+        for (int k = 0; k < 6; k++) {
+            const float* corner = &faces[face][3 + corners[k] * 3];
+            for (int axis = 0; axis < 3; axis++) {
+                vertices[index++] = corner[axis] * 0.5f;
+            }
+            for (int axis = 0; axis < 3; axis++) {
+                vertices[index++] = faces[face][axis];
+            }
+        }
     }
     
-    // If we have images in the model, process them
-    texture_ids = (GLuint*)malloc(texture_count * sizeof(GLuint));
-    glGenTextures(texture_count, texture_ids);
-    
-    // Load each texture
-    for (size_t i = 0; i < texture_count; i++) {
-        cgltf_image* image = &model->images[i];
-        
-        // Bind texture
-        glBindTexture(GL_TEXTURE_2D, texture_ids[i]);
-        
-        // Set texture parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        // For now, just create a yellow texture since we don't know how to parse the image data
-        unsigned char yellowTexture[4 * 3] = {
-            255, 255, 0,  255, 255, 0,  // Yellow pixels
-            255, 255, 0,  255, 255, 0
-        };
-        
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 2, 2, 0, GL_RGB, GL_UNSIGNED_BYTE, yellowTexture);
-        
-        // Unbind texture
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &cubeVBO);
+    gl_state_bind_vertex_array(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    gl_state_bind_vertex_array(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 // Function to render the loaded GLB model
-void renderGLBModel() {
-    if (model == NULL) {
-        // Model not loaded, render a simple cube as fallback
-        glColor3f(1.0f, 1.0f, 0.0f); // Yellow color
-        
-        // Draw a cube
-        glBegin(GL_QUADS);
-        // Front face
-        glVertex3f(-0.5f, -0.5f, 0.5f);
-        glVertex3f(0.5f, -0.5f, 0.5f);
-        glVertex3f(0.5f, 0.5f, 0.5f);
-        glVertex3f(-0.5f, 0.5f, 0.5f);
-        
-        // Back face
-        glVertex3f(-0.5f, -0.5f, -0.5f);
-        glVertex3f(-0.5f, 0.5f, -0.5f);
-        glVertex3f(0.5f, 0.5f, -0.5f);
-        glVertex3f(0.5f, -0.5f, -0.5f);
-        
-        // Top face
-        glVertex3f(-0.5f, 0.5f, -0.5f);
-        glVertex3f(-0.5f, 0.5f, 0.5f);
-        glVertex3f(0.5f, 0.5f, 0.5f);
-        glVertex3f(0.5f, 0.5f, -0.5f);
-        
-        // Bottom face
-        glVertex3f(-0.5f, -0.5f, -0.5f);
-        glVertex3f(0.5f, -0.5f, -0.5f);
-        glVertex3f(0.5f, -0.5f, 0.5f);
-        glVertex3f(-0.5f, -0.5f, 0.5f);
-        
-        // Right face
-        glVertex3f(0.5f, -0.5f, -0.5f);
-        glVertex3f(0.5f, 0.5f, -0.5f);
-        glVertex3f(0.5f, 0.5f, 0.5f);
-        glVertex3f(0.5f, -0.5f, 0.5f);
-        
-        // Left face
-        glVertex3f(-0.5f, -0.5f, -0.5f);
-        glVertex3f(-0.5f, -0.5f, 0.5f);
-        glVertex3f(-0.5f, 0.5f, 0.5f);
-        glVertex3f(-0.5f, 0.5f, -0.5f);
-        glEnd();
-        
+void renderGLBModel(Shader* shader) {
+    if (currentModel != NULL) {
+        // Materials were resolved to colors at load: a few draw calls, no per-vertex work
+        model_render(currentModel, shader);
         return;
     }
     
-    // Load textures if not already loaded
-    if (!texture_ids && model->images_count > 0) {
-        loadTextures();
+    // Model not loaded, render a simple cube as fallback
+    if (cubeVAO == 0) {
+        create_fallback_cube();
     }
     
-    // Enable texturing
-    glEnable(GL_TEXTURE_2D);
-    
-    // Iterate through all meshes in the model
-    for (size_t i = 0; i < model->meshes_count; i++) {
-        cgltf_mesh* mesh = &model->meshes[i];
-        
-        // Iterate through all primitives in the mesh
-        for (size_t j = 0; j < mesh->primitives_count; j++) {
-            cgltf_primitive* primitive = &mesh->primitives[j];
-            
-            // Apply material if available
-            if (primitive->material) {
-                // Set material properties for yellow hazmat suit
-                float yellow[] = {1.0f, 1.0f, 0.0f, 1.0f};
-                float black[] = {0.0f, 0.0f, 0.0f, 1.0f};
-                float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
-                float shininess = 30.0f;
-                
-                // Check if this is the visor part (usually has a different material)
-                if (primitive->material->name && strstr(primitive->material->name, "visor")) {
-                    // Set visor to black
-                    glColor4f(0.1f, 0.1f, 0.1f, 0.8f);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, black);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, black);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, white);
-                    glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, 100.0f);
-                } else if (primitive->material->name && strstr(primitive->material->name, "glove")) {
-                    // Set gloves to gray
-                    glColor4f(0.5f, 0.5f, 0.5f, 1.0f);
-                    float gray[] = {0.5f, 0.5f, 0.5f, 1.0f};
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, gray);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, gray);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, white);
-                    glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
-                } else {
-                    // Default yellow for the suit
-                    glColor4f(1.0f, 1.0f, 0.0f, 1.0f);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, yellow);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, yellow);
-                    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, white);
-                    glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
-                }
-                
-                // Bind the yellow texture if available
-                if (texture_ids && texture_count > 0) {
-                    glBindTexture(GL_TEXTURE_2D, texture_ids[0]);
-                }
-            } else {
-                // Default material properties
-                float yellow[] = {1.0f, 1.0f, 0.0f, 1.0f};
-                float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
-                glColor4f(1.0f, 1.0f, 0.0f, 1.0f);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, yellow);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, yellow);
-                glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, white);
-                glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, 30.0f);
-            }
-            
-            // Begin drawing triangles
-            glBegin(GL_TRIANGLES);
-            
-            // Get indices if available
-            cgltf_accessor* indices = primitive->indices;
-            size_t index_count = indices ? indices->count : 0;
-            
-            // Get position accessor
-            cgltf_accessor* positions = NULL;
-            cgltf_accessor* texcoords = NULL;
-            cgltf_accessor* normals = NULL;
-            
-            // Find all required attributes
-            for (size_t k = 0; k < primitive->attributes_count; k++) {
-                if (primitive->attributes[k].type == cgltf_attribute_type_position) {
-                    positions = primitive->attributes[k].data;
-                } else if (primitive->attributes[k].type == cgltf_attribute_type_texcoord) {
-                    texcoords = primitive->attributes[k].data;
-                } else if (primitive->attributes[k].type == cgltf_attribute_type_normal) {
-                    normals = primitive->attributes[k].data;
-                }
-            }
-            
-            if (positions) {
-                // If we have indices, use them
-                if (indices) {
-                    for (size_t k = 0; k < index_count; k++) {
-                        uint32_t idx = cgltf_accessor_read_index(indices, k);
-                        
-                        // Set texture coordinate if available
-                        if (texcoords) {
-                            float tc[2];
-                            cgltf_accessor_read_float(texcoords, idx, tc, 2);
-                            glTexCoord2f(tc[0], tc[1]);
-                        }
-                        
-                        // Set normal if available
-                        if (normals) {
-                            float n[3];
-                            cgltf_accessor_read_float(normals, idx, n, 3);
-                            glNormal3f(n[0], n[1], n[2]);
-                        }
-                        
-                        // Set vertex position
-                        float pos[3];
-                        cgltf_accessor_read_float(positions, idx, pos, 3);
-                        glVertex3f(pos[0], pos[1], pos[2]);
-                    }
-                } else {
-                    // Otherwise, use vertices directly
-                    for (size_t k = 0; k < positions->count; k++) {
-                        // Set texture coordinate if available
-                        if (texcoords) {
-                            float tc[2];
-                            cgltf_accessor_read_float(texcoords, k, tc, 2);
-                            glTexCoord2f(tc[0], tc[1]);
-                        }
-                        
-                        // Set normal if available
-                        if (normals) {
-                            float n[3];
-                            cgltf_accessor_read_float(normals, k, n, 3);
-                            glNormal3f(n[0], n[1], n[2]);
-                        }
-                        
-                        // Set vertex position
-                        float pos[3];
-                        cgltf_accessor_read_float(positions, k, pos, 3);
-                        glVertex3f(pos[0], pos[1], pos[2]);
-                    }
-                }
-            }
-            
-            glEnd();
-            
-            // Unbind texture
-            glBindTexture(GL_TEXTURE_2D, 0);
-        }
-    }
+    shader_uniform_vec3(shader, shader_uniform(shader, "objectColor"), (vec3){1.0f, 1.0f, 0.0f}); // Yellow color
+    shader_uniform_bool(shader, shader_uniform(shader, "useTexture"), false);
+    glVertexAttrib2f(2, 0.0f, 0.0f);
     
-    // Disable texturing
-    glDisable(GL_TEXTURE_2D);
+    gl_state_bind_vertex_array(cubeVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    gl_state_bind_vertex_array(0);
 }
 
 // Function to clean up resources
-void cleanupGLB() {
-    if (model) {
-        cgltf_free(model);
-        model = NULL;
+void cleanupGLB(void) {
+    for (int i = 0; i < glbCacheCount; i++) {
+        model_cleanup(&glbCache[i].model);
+        free(glbCache[i].path);
     }
+    memset(glbCache, 0, sizeof(glbCache));
+    glbCacheCount = 0;
+    currentModel = NULL;
     
-    // Free texture resources
-    if (texture_ids) {
-        glDeleteTextures(texture_count, texture_ids);
-        free(texture_ids);
-        texture_ids = NULL;
-        texture_count = 0;
+    if (cubeVAO != 0) {
+        gl_state_delete_vertex_arrays(1, &cubeVAO);
+        glDeleteBuffers(1, &cubeVBO);
+        cubeVAO = 0;
+        cubeVBO = 0;
     }
-} 
\ No newline at end of file
+}
@@ -0,0 +1,590 @@
+#include "job_system.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "profiler.h"
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#ifdef _MSC_VER
+#define JOB_THREAD_LOCAL __declspec(thread)
+#else
+#define JOB_THREAD_LOCAL _Thread_local
+#endif
+
+// Per-thread deque size and job pool size (both powers of two)
+#define JOB_DEQUE_CAPACITY 4096
+#define JOB_POOL_CAPACITY 4096
+
+// Idle spins before a worker goes to sleep
+#define JOB_IDLE_SPINS 64
+
+typedef struct Job {
+    JobFunc func;
+    void* data;
+    int begin;
+    int end;
+    JobCounter* counter;
+    struct Job* next;          // Link in a counter's waiter list
+    atomic_bool inUse;         // Set from allocation until the job has run
+    bool heapAllocated;        // Taken from the heap because the whole ring was busy
+} Job;
+
+// Chase-Lev work-stealing deque: the owner pushes and pops at the bottom,
+// other threads steal from the top.
+typedef struct {
+    atomic_llong top;
+    atomic_llong bottom;
+    _Atomic(Job*) slots[JOB_DEQUE_CAPACITY];
+} JobDeque;
+
+// Everything one thread owns
+typedef struct {
+    JobDeque deque;
+    Job pool[JOB_POOL_CAPACITY];    // Ring of job records, only allocated by the owner
+    unsigned int poolNext;
+    unsigned int stealSeed;
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+} JobWorker;
+
+static JobWorker* workers = NULL;
+static int threadCount = 1;
+static atomic_bool running = false;
+
+// Jobs sitting in deques, used to decide whether idle workers may sleep
+static atomic_int queuedJobs = 0;
+static atomic_int sleepingWorkers = 0;
+
+// Background jobs: one shared FIFO under jobLock, linked through Job.next.
+// Only worker threads take from it, and only when they found nothing else.
+static Job* backgroundHead = NULL;
+static Job* backgroundTail = NULL;
+static atomic_int backgroundJobs = 0;
+
+// Index of the calling thread (main thread is 0)
+static JOB_THREAD_LOCAL int workerIndex = 0;
+
+// Sleep/wake and dependency bookkeeping share one lock; both are rare paths
+#ifdef _WIN32
+static CRITICAL_SECTION jobLock;
+static CONDITION_VARIABLE jobWake;
+#define JOB_LOCK() EnterCriticalSection(&jobLock)
+#define JOB_UNLOCK() LeaveCriticalSection(&jobLock)
+#define JOB_SLEEP() SleepConditionVariableCS(&jobWake, &jobLock, INFINITE)
+#define JOB_WAKE_ALL() WakeAllConditionVariable(&jobWake)
+#define JOB_YIELD() SwitchToThread()
+#else
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobWake = PTHREAD_COND_INITIALIZER;
+#define JOB_LOCK() pthread_mutex_lock(&jobLock)
+#define JOB_UNLOCK() pthread_mutex_unlock(&jobLock)
+#define JOB_SLEEP() pthread_cond_wait(&jobWake, &jobLock)
+#define JOB_WAKE_ALL() pthread_cond_broadcast(&jobWake)
+#define JOB_YIELD() sched_yield()
+#endif
+
+// Owner side: push a job at the bottom. Returns false when full
+static bool deque_push(JobDeque* deque, Job* job) {
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) {
+        return false;
+    }
+
+    atomic_store_explicit(&deque->slots[bottom & (JOB_DEQUE_CAPACITY - 1)], job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return true;
+}
+
+// Owner side: pop the most recently pushed job
+static Job* deque_pop(JobDeque* deque) {
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        // Empty
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    Job* job = atomic_load_explicit(&deque->slots[bottom & (JOB_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (top == bottom) {
+        // Last job: race thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed)) {
+            job = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+// Thief side: take the oldest job
+static Job* deque_steal(JobDeque* deque) {
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    Job* job = atomic_load_explicit(&deque->slots[top & (JOB_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+    return job;
+}
+
+// Grab a job record from the calling thread's ring. Records whose job is
+// still queued, parked on a dependency or running are skipped (asset decodes
+// can stay queued for many ticks); if the whole ring is busy the record comes
+// from the heap. Returns NULL only if that fails too.
+static Job* job_alloc(void) {
+    JobWorker* worker = &workers[workerIndex];
+    for (int probe = 0; probe < JOB_POOL_CAPACITY; probe++) {
+        Job* job = &worker->pool[worker->poolNext & (JOB_POOL_CAPACITY - 1)];
+        worker->poolNext++;
+        if (!atomic_load_explicit(&job->inUse, memory_order_acquire)) {
+            job->heapAllocated = false;
+            atomic_store_explicit(&job->inUse, true, memory_order_relaxed);
+            return job;
+        }
+    }
+
+    LOG("All %d job records of worker %d are busy, allocating one", JOB_POOL_CAPACITY, workerIndex);
+    Job* job = (Job*)calloc(1, sizeof(Job));
+    if (job) {
+        job->heapAllocated = true;
+        atomic_init(&job->inUse, true);
+    }
+    return job;
+}
+
+// Hand a record back once its job has run
+static void job_release(Job* job) {
+    if (job->heapAllocated) {
+        free(job);
+    } else {
+        atomic_store_explicit(&job->inUse, false, memory_order_release);
+    }
+}
+
+static void execute_job(Job* job);
+
+// Make a job runnable on the calling thread, waking sleepers if needed
+static void enqueue_job(Job* job) {
+    if (!deque_push(&workers[workerIndex].deque, job)) {
+        // Deque full: run it right here rather than dropping it
+        execute_job(job);
+        return;
+    }
+
+    atomic_fetch_add(&queuedJobs, 1);
+    if (atomic_load(&sleepingWorkers) > 0) {
+        JOB_LOCK();
+        JOB_WAKE_ALL();
+        JOB_UNLOCK();
+    }
+}
+
+// Count one job on counter as finished, releasing deferred jobs when it drains
+static void finish_job(JobCounter* counter) {
+    // Fast path: not the last job, nobody can be released
+    int pending = atomic_load(&counter->pending);
+    while (pending > 1) {
+        if (atomic_compare_exchange_weak(&counter->pending, &pending, pending - 1)) {
+            return;
+        }
+    }
+
+    // Possibly the last job. The waiter list is taken before the decrement
+    // because a thread in job_wait may free the counter once it reads zero.
+    JOB_LOCK();
+    Job* waiters = counter->waiters;
+    counter->waiters = NULL;
+    if (atomic_fetch_sub(&counter->pending, 1) != 1) {
+        // More work was submitted meanwhile; the counter is still alive
+        counter->waiters = waiters;
+        waiters = NULL;
+    }
+    JOB_UNLOCK();
+
+    while (waiters) {
+        Job* next = waiters->next;
+        enqueue_job(waiters);
+        waiters = next;
+    }
+}
+
+static void execute_job(Job* job) {
+    JobCounter* counter = job->counter;
+    job->func(job->data, job->begin, job->end);
+    job_release(job);
+    finish_job(counter);
+}
+
+// No record could be had: wait for the dependency and run on this thread
+static void run_unrecorded(JobCounter* counter, JobCounter* dependency, JobFunc func, void* data,
+                           int begin, int end) {
+    if (dependency) {
+        job_wait(dependency);
+    }
+    func(data, begin, end);
+    finish_job(counter);
+}
+
+// Queue a job now, or park it on dependency until that counter drains
+static void schedule_job(Job* job, JobCounter* dependency) {
+    if (dependency && atomic_load(&dependency->pending) > 0) {
+        JOB_LOCK();
+        // Re-check under the lock so we can't miss the release
+        if (atomic_load(&dependency->pending) > 0) {
+            job->next = dependency->waiters;
+            dependency->waiters = job;
+            JOB_UNLOCK();
+            return;
+        }
+        JOB_UNLOCK();
+    }
+
+    enqueue_job(job);
+}
+
+// Oldest background job, or NULL
+static Job* take_background_job(void) {
+    if (atomic_load(&backgroundJobs) == 0) {
+        return NULL;
+    }
+
+    JOB_LOCK();
+    Job* job = backgroundHead;
+    if (job) {
+        backgroundHead = job->next;
+        if (!backgroundHead) {
+            backgroundTail = NULL;
+        }
+        atomic_fetch_sub(&backgroundJobs, 1);
+    }
+    JOB_UNLOCK();
+    return job;
+}
+
+// Pop local work first, then steal from a random victim. Worker threads fall
+// back to the background queue; the main thread never runs background jobs.
+static Job* find_job(void) {
+    JobWorker* self = &workers[workerIndex];
+    Job* job = deque_pop(&self->deque);
+
+    if (!job) {
+        for (int attempt = 0; attempt < threadCount && !job; attempt++) {
+            self->stealSeed = self->stealSeed * 1664525u + 1013904223u;
+            int victim = (int)((self->stealSeed >> 16) % (unsigned int)threadCount);
+            if (victim != workerIndex) {
+                job = deque_steal(&workers[victim].deque);
+            }
+        }
+    }
+
+    if (job) {
+        atomic_fetch_sub(&queuedJobs, 1);
+        return job;
+    }
+
+    return workerIndex != 0 ? take_background_job() : NULL;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID arg)
+#else
+static void* worker_main(void* arg)
+#endif
+{
+    workerIndex = (int)(intptr_t)arg;
+    int idleSpins = 0;
+
+#ifdef PROFILER_ENABLED
+    char threadName[32];
+    snprintf(threadName, sizeof(threadName), "worker %d", workerIndex);
+    PROFILE_THREAD_NAME(threadName);
+#endif
+
+    while (atomic_load(&running)) {
+        Job* job = find_job();
+        if (job) {
+            execute_job(job);
+            idleSpins = 0;
+            continue;
+        }
+
+        if (++idleSpins < JOB_IDLE_SPINS) {
+            JOB_YIELD();
+            continue;
+        }
+
+        // Nothing to do: sleep until a push or shutdown
+        JOB_LOCK();
+        atomic_fetch_add(&sleepingWorkers, 1);
+        while (atomic_load(&running) && atomic_load(&queuedJobs) == 0 &&
+               atomic_load(&backgroundJobs) == 0) {
+            JOB_SLEEP();
+        }
+        atomic_fetch_sub(&sleepingWorkers, 1);
+        JOB_UNLOCK();
+        idleSpins = 0;
+    }
+
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+// Number of logical cores
+static int hardware_thread_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+// Start the pool
+bool job_system_init(int requestedThreads) {
+    if (workers) {
+        job_system_shutdown();
+    }
+
+    if (requestedThreads <= 0) {
+        requestedThreads = hardware_thread_count();
+    }
+    if (requestedThreads > JOB_MAX_THREADS) {
+        requestedThreads = JOB_MAX_THREADS;
+    }
+
+    workers = (JobWorker*)calloc((size_t)requestedThreads, sizeof(JobWorker));
+    if (!workers) {
+        LOG("Failed to allocate %d job workers", requestedThreads);
+        threadCount = 1;
+        return false;
+    }
+
+    threadCount = requestedThreads;
+    workerIndex = 0;
+    backgroundHead = NULL;
+    backgroundTail = NULL;
+    atomic_store(&backgroundJobs, 0);
+    atomic_store(&queuedJobs, 0);
+    atomic_store(&sleepingWorkers, 0);
+    atomic_store(&running, true);
+
+#ifdef _WIN32
+    InitializeCriticalSection(&jobLock);
+    InitializeConditionVariable(&jobWake);
+#endif
+
+    for (int i = 0; i < threadCount; i++) {
+        workers[i].stealSeed = 0x9E3779B9u * (unsigned int)(i + 1);
+    }
+
+    // Worker 0 is the calling (main) thread
+    for (int i = 1; i < threadCount; i++) {
+#ifdef _WIN32
+        workers[i].thread = CreateThread(NULL, 0, worker_main, (LPVOID)(intptr_t)i, 0, NULL);
+        bool started = workers[i].thread != NULL;
+#else
+        bool started = pthread_create(&workers[i].thread, NULL, worker_main, (void*)(intptr_t)i) == 0;
+#endif
+        if (!started) {
+            LOG("Failed to start job worker %d, continuing with %d threads", i, i);
+            threadCount = i;
+            break;
+        }
+    }
+
+    LOG("Job system started with %d threads", threadCount);
+    return true;
+}
+
+// Stop and join all worker threads
+void job_system_shutdown(void) {
+    if (!workers) {
+        return;
+    }
+
+    JOB_LOCK();
+    atomic_store(&running, false);
+    JOB_WAKE_ALL();
+    JOB_UNLOCK();
+
+    for (int i = 1; i < threadCount; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(workers[i].thread, INFINITE);
+        CloseHandle(workers[i].thread);
+#else
+        pthread_join(workers[i].thread, NULL);
+#endif
+    }
+
+#ifdef _WIN32
+    DeleteCriticalSection(&jobLock);
+#endif
+
+    free(workers);
+    workers = NULL;
+    threadCount = 1;
+}
+
+// Number of threads executing jobs (1 in single-threaded mode)
+int job_system_thread_count(void) {
+    return threadCount;
+}
+
+// Index of the calling thread
+int job_system_worker_index(void) {
+    return workerIndex;
+}
+
+// Reset a counter before submitting against it
+void job_counter_init(JobCounter* counter) {
+    atomic_init(&counter->pending, 0);
+    counter->waiters = NULL;
+}
+
+// Single-threaded mode: everything runs inline, so dependencies are already done
+static bool run_inline(void) {
+    return workers == NULL || threadCount <= 1;
+}
+
+// Run func(data, 0, 1) once dependency reaches zero
+void job_submit(JobCounter* counter, JobCounter* dependency, JobFunc func, void* data) {
+    if (run_inline()) {
+        func(data, 0, 1);
+        return;
+    }
+
+    atomic_fetch_add(&counter->pending, 1);
+
+    Job* job = job_alloc();
+    if (!job) {
+        run_unrecorded(counter, dependency, func, data, 0, 1);
+        return;
+    }
+    job->func = func;
+    job->data = data;
+    job->begin = 0;
+    job->end = 1;
+    job->counter = counter;
+    job->next = NULL;
+    schedule_job(job, dependency);
+}
+
+// Run func(data, 0, 1) on a worker thread, never the main thread
+void job_submit_background(JobCounter* counter, JobFunc func, void* data) {
+    if (run_inline()) {
+        func(data, 0, 1);
+        return;
+    }
+
+    atomic_fetch_add(&counter->pending, 1);
+
+    Job* job = job_alloc();
+    if (!job) {
+        run_unrecorded(counter, NULL, func, data, 0, 1);
+        return;
+    }
+    job->func = func;
+    job->data = data;
+    job->begin = 0;
+    job->end = 1;
+    job->counter = counter;
+    job->next = NULL;
+
+    JOB_LOCK();
+    if (backgroundTail) {
+        backgroundTail->next = job;
+    } else {
+        backgroundHead = job;
+    }
+    backgroundTail = job;
+    atomic_fetch_add(&backgroundJobs, 1);
+    JOB_WAKE_ALL();
+    JOB_UNLOCK();
+}
+
+// Split [0, count) into chunks of grainSize and run func on each chunk
+void job_parallel_for(JobCounter* counter, JobCounter* dependency, int count, int grainSize,
+                      JobFunc func, void* data) {
+    if (count <= 0) {
+        return;
+    }
+    if (grainSize < 1) {
+        grainSize = 1;
+    }
+
+    if (run_inline()) {
+        for (int begin = 0; begin < count; begin += grainSize) {
+            int end = begin + grainSize < count ? begin + grainSize : count;
+            func(data, begin, end);
+        }
+        return;
+    }
+
+    // Count every chunk up front so the counter can't hit zero mid-submission
+    int chunks = (count + grainSize - 1) / grainSize;
+    atomic_fetch_add(&counter->pending, chunks);
+
+    for (int begin = 0; begin < count; begin += grainSize) {
+        int end = begin + grainSize < count ? begin + grainSize : count;
+        Job* job = job_alloc();
+        if (!job) {
+            run_unrecorded(counter, dependency, func, data, begin, end);
+            continue;
+        }
+        job->func = func;
+        job->data = data;
+        job->begin = begin;
+        job->end = end;
+        job->counter = counter;
+        job->next = NULL;
+        schedule_job(job, dependency);
+    }
+}
+
+// Block until counter reaches zero, running queued jobs on this thread meanwhile
+void job_wait(JobCounter* counter) {
+    if (run_inline()) {
+        return;
+    }
+
+    while (atomic_load(&counter->pending) > 0) {
+        Job* job = find_job();
+        if (job) {
+            execute_job(job);
+        } else {
+            JOB_YIELD();
+        }
+    }
+}
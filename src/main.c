@@ -5,10 +5,16 @@
 #include <glad/glad.h> // GLAD must come before GLFW
 #include <GLFW/glfw3.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "input.h"
 #include "world.h"
 #include "camera.h"
 #include "cgltf.h"
+#include "job_system.h"
+#include "asset_loader.h"
+#include "texture.h"
+#include "texture_stream.h"
+#include "profiler.h"
 
 // Window dimensions
 const int WINDOW_WIDTH = 800;
@@ -40,17 +46,44 @@ int main() {
         return -1;
     }
     
+    // Start the job system. PLATFORMER_THREADS sets the thread count
+    // (0 or unset = one per core, 1 = single-threaded for debugging)
+    const char* threadsEnv = getenv("PLATFORMER_THREADS");
+    job_system_init(threadsEnv ? atoi(threadsEnv) : 0);
+    PROFILE_THREAD_NAME("main");
+    
+    // Images are decoded on the job system and uploaded here, a few per frame
+    asset_loader_init();
+    double startTime = glfwGetTime();
+    bool assetsReported = false;
+    
     // Initialize input system
     initInput(window);
     
     // Initialize world
     initWorld(window);
     
-    // Timing variables
-    const double fixedTimeStep = 1.0 / 60.0;
+    // Timing variables. The simulation always advances in fixed steps;
+    // PLATFORMER_TICK_HZ changes the step rate (default 60)
+    const char* tickRateEnv = getenv("PLATFORMER_TICK_HZ");
+    double tickRate = tickRateEnv ? atof(tickRateEnv) : 60.0;
+    if (tickRate <= 0.0) {
+        tickRate = 60.0;
+    }
+    const double fixedTimeStep = 1.0 / tickRate;
+    
+    // Most ticks run per frame. A longer stall slows the game down instead
+    // of queueing more and more catch-up ticks
+    const int maxCatchUpTicks = 5;
+    
     double previousTime = glfwGetTime();
     double accumulator = 0.0;
     
+#ifdef PROFILER_ENABLED
+    // F9 writes the recorded zones to a Chrome trace / Perfetto file
+    bool traceKeyWasPressed = false;
+#endif
+    
     // Main game loop
     while (!glfwWindowShouldClose(window)) {
         // Calculate elapsed time
@@ -60,29 +93,63 @@ int main() {
         accumulator += frameTime;
         
         // Update game logic at fixed intervals
-        while (accumulator >= fixedTimeStep) {
-            updateInput();
-            updateWorld();
+        int ticks = 0;
+        while (accumulator >= fixedTimeStep && ticks < maxCatchUpTicks) {
+            PROFILE_SCOPE("updateInput") updateInput();
+            PROFILE_SCOPE("updateWorld") updateWorld((float)fixedTimeStep);
             accumulator -= fixedTimeStep;
+            ticks++;
         }
         
+        // Drop the time we couldn't catch up on, keeping the sub-step remainder
+        if (accumulator >= fixedTimeStep) {
+            accumulator = fmod(accumulator, fixedTimeStep);
+        }
+        
+        // How far we are between the last tick and the next one
+        float alpha = (float)(accumulator / fixedTimeStep);
+        
         // Get window size for aspect ratio
         int width, height;
         glfwGetFramebufferSize(window, &width, &height);
         float aspectRatio = (float)width / (float)height;
         
+        // Upload whatever the loader threads have finished, within budget
+        PROFILE_SCOPE("asset_loader_pump") asset_loader_pump(ASSET_LOADER_FRAME_BUDGET_NS);
+        if (!assetsReported && asset_loader_pending() == 0) {
+            TextureStats textureStats = texture_get_stats();
+            printf("Assets ready after %.1f ms. Textures: %d cached (%d refs, %d decoded, %d shared), %.1f KiB resident\n",
+                   (glfwGetTime() - startTime) * 1000.0, textureStats.cachedTextures, textureStats.references,
+                   textureStats.loads, textureStats.hits, (double)textureStats.residentBytes / 1024.0);
+            assetsReported = true;
+        }
+        
         // Render the scene
-        renderWorld(aspectRatio);
+        PROFILE_SCOPE("renderWorld") renderWorld(aspectRatio, alpha, (float)frameTime);
         
         // Swap buffers and poll events
-        glfwSwapBuffers(window);
+        PROFILE_SCOPE("glfwSwapBuffers") glfwSwapBuffers(window);
         glfwPollEvents();
         
+#ifdef PROFILER_ENABLED
+        bool traceKeyIsPressed = isKeyPressed(GLFW_KEY_F9);
+        if (traceKeyIsPressed && !traceKeyWasPressed) {
+            if (profiler_write_trace("profile_trace.json")) {
+                printf("Wrote profile_trace.json\n");
+            }
+        }
+        traceKeyWasPressed = traceKeyIsPressed;
+#endif
+        
         glfwSwapInterval(1); // Enable VSync to limit frame rate to monitor refresh rate
     }
     
     // Clean up resources
     cleanupWorld();
+    asset_loader_shutdown();
+    texture_stream_cleanup();
+    job_system_shutdown();
+    profiler_shutdown();
     
     // Clean up and exit
     glfwDestroyWindow(window);
@@ -0,0 +1,459 @@
+#include "mesh_optimizer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Forsyth's scoring constants
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+
+// Remaining-triangle counts with a precomputed valence boost
+#define FORSYTH_VALENCE_TABLE_SIZE 32
+
+static uint32_t hash_vertex(const unsigned char* vertex, size_t stride) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < stride; i++) {
+        hash = (hash ^ vertex[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Give identical vertices one index
+size_t mesh_generate_remap(uint32_t* remap, const uint32_t* indices, size_t indexCount,
+                           const void* vertices, size_t vertexCount, size_t stride) {
+    const unsigned char* bytes = (const unsigned char*)vertices;
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2) {
+        tableSize *= 2;
+    }
+
+    // Open addressing; slots hold a vertex index, UINT32_MAX when empty
+    uint32_t* table = (uint32_t*)malloc(tableSize * sizeof(uint32_t));
+    memset(table, 0xff, tableSize * sizeof(uint32_t));
+    memset(remap, 0xff, vertexCount * sizeof(uint32_t));
+
+    size_t uniqueCount = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        uint32_t vertex = indices ? indices[i] : (uint32_t)i;
+        if (remap[vertex] != UINT32_MAX) {
+            continue;
+        }
+
+        const unsigned char* data = bytes + vertex * stride;
+        size_t slot = hash_vertex(data, stride) & (tableSize - 1);
+        while (table[slot] != UINT32_MAX && memcmp(bytes + table[slot] * stride, data, stride) != 0) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (table[slot] == UINT32_MAX) {
+            table[slot] = vertex;
+            remap[vertex] = (uint32_t)uniqueCount++;
+        } else {
+            remap[vertex] = remap[table[slot]];
+        }
+    }
+
+    free(table);
+    return uniqueCount;
+}
+
+void mesh_remap_indices(uint32_t* indices, size_t indexCount, const uint32_t* remap) {
+    for (size_t i = 0; i < indexCount; i++) {
+        indices[i] = remap[indices[i]];
+    }
+}
+
+void mesh_remap_vertices(void* destination, const void* vertices, size_t vertexCount,
+                         size_t stride, const uint32_t* remap) {
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (remap[i] != UINT32_MAX) {
+            memcpy((unsigned char*)destination + remap[i] * stride,
+                   (const unsigned char*)vertices + i * stride, stride);
+        }
+    }
+}
+
+// Score of a vertex at cachePosition (-1 when not cached) still used by remaining triangles
+static float forsyth_vertex_score(int cachePosition, unsigned int remaining, const float* valenceScores) {
+    if (remaining == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // The last triangle's vertices score a fixed amount so it isn't simply repeated
+            score = FORSYTH_LAST_TRIANGLE_SCORE;
+        } else {
+            float scaler = 1.0f / (MESH_OPTIMIZER_CACHE_SIZE - 3);
+            score = powf(1.0f - (cachePosition - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+
+    // Favour vertices with few triangles left, so lone triangles aren't stranded
+    if (remaining < FORSYTH_VALENCE_TABLE_SIZE) {
+        score += valenceScores[remaining];
+    } else {
+        score += FORSYTH_VALENCE_BOOST_SCALE * powf((float)remaining, -FORSYTH_VALENCE_BOOST_POWER);
+    }
+    return score;
+}
+
+// Reorder a triangle list for the post-transform vertex cache
+void mesh_optimize_vertex_cache(uint32_t* destination, const uint32_t* indices,
+                                size_t indexCount, size_t vertexCount) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    float valenceScores[FORSYTH_VALENCE_TABLE_SIZE];
+    for (int i = 1; i < FORSYTH_VALENCE_TABLE_SIZE; i++) {
+        valenceScores[i] = FORSYTH_VALENCE_BOOST_SCALE * powf((float)i, -FORSYTH_VALENCE_BOOST_POWER);
+    }
+    valenceScores[0] = 0.0f;
+
+    // destination may alias indices
+    uint32_t* source = (uint32_t*)malloc(indexCount * sizeof(uint32_t));
+    memcpy(source, indices, indexCount * sizeof(uint32_t));
+
+    // Triangles using each vertex; the first remaining[v] are not yet emitted
+    unsigned int* remaining = (unsigned int*)calloc(vertexCount, sizeof(unsigned int));
+    size_t* adjacencyOffsets = (size_t*)malloc((vertexCount + 1) * sizeof(size_t));
+    uint32_t* adjacency = (uint32_t*)malloc(indexCount * sizeof(uint32_t));
+
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        remaining[source[i]]++;
+    }
+    size_t offset = 0;
+    for (size_t v = 0; v < vertexCount; v++) {
+        adjacencyOffsets[v] = offset;
+        offset += remaining[v];
+        remaining[v] = 0;
+    }
+    adjacencyOffsets[vertexCount] = offset;
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            uint32_t vertex = source[t * 3 + k];
+            adjacency[adjacencyOffsets[vertex] + remaining[vertex]++] = (uint32_t)t;
+        }
+    }
+
+    int* cachePositions = (int*)malloc(vertexCount * sizeof(int));
+    float* vertexScores = (float*)malloc(vertexCount * sizeof(float));
+    bool* emitted = (bool*)calloc(triangleCount, sizeof(bool));
+
+    for (size_t v = 0; v < vertexCount; v++) {
+        cachePositions[v] = -1;
+        vertexScores[v] = forsyth_vertex_score(-1, remaining[v], valenceScores);
+    }
+
+    // Start with the triangle of the least connected vertices
+    size_t best = 0;
+    float bestScore = -1.0f;
+    for (size_t t = 0; t < triangleCount; t++) {
+        const uint32_t* corners = &source[t * 3];
+        float score = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+        if (score > bestScore) {
+            bestScore = score;
+            best = t;
+        }
+    }
+
+    // Most recently used first; the extra 3 slots hold entries being evicted
+    uint32_t cache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+    uint32_t newCache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+    int cacheCount = 0;
+    size_t cursor = 0;
+
+    for (size_t out = 0; out < triangleCount; out++) {
+        if (best == SIZE_MAX) {
+            // Nothing adjacent to the cache is left: restart at the next unemitted triangle
+            while (emitted[cursor]) {
+                cursor++;
+            }
+            best = cursor;
+        }
+
+        const uint32_t* corners = &source[best * 3];
+        memcpy(&destination[out * 3], corners, 3 * sizeof(uint32_t));
+        emitted[best] = true;
+
+        // Drop the triangle from its vertices' remaining lists
+        for (int k = 0; k < 3; k++) {
+            uint32_t vertex = corners[k];
+            uint32_t* list = &adjacency[adjacencyOffsets[vertex]];
+            for (unsigned int i = 0; i < remaining[vertex]; i++) {
+                if (list[i] == best) {
+                    list[i] = list[remaining[vertex] - 1];
+                    remaining[vertex]--;
+                    break;
+                }
+            }
+        }
+
+        // The triangle's vertices move to the front of the cache
+        int newCount = 0;
+        for (int k = 0; k < 3; k++) {
+            bool present = false;
+            for (int i = 0; i < newCount; i++) {
+                present = present || newCache[i] == corners[k];
+            }
+            if (!present) {
+                newCache[newCount++] = corners[k];
+            }
+        }
+        for (int i = 0; i < cacheCount; i++) {
+            uint32_t vertex = cache[i];
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+                newCache[newCount++] = vertex;
+            }
+        }
+
+        // Rescore everything that moved, evicted entries included
+        for (int i = 0; i < newCount; i++) {
+            uint32_t vertex = newCache[i];
+            cachePositions[vertex] = i < MESH_OPTIMIZER_CACHE_SIZE ? i : -1;
+            vertexScores[vertex] = forsyth_vertex_score(cachePositions[vertex], remaining[vertex], valenceScores);
+        }
+
+        // The next triangle is the best one touching the cache
+        best = SIZE_MAX;
+        bestScore = -1.0f;
+        for (int i = 0; i < newCount; i++) {
+            uint32_t vertex = newCache[i];
+            const uint32_t* list = &adjacency[adjacencyOffsets[vertex]];
+            for (unsigned int j = 0; j < remaining[vertex]; j++) {
+                uint32_t triangle = list[j];
+                const uint32_t* triangleCorners = &source[triangle * 3];
+                float score = vertexScores[triangleCorners[0]] + vertexScores[triangleCorners[1]] +
+                              vertexScores[triangleCorners[2]];
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = triangle;
+                }
+            }
+        }
+
+        cacheCount = newCount < MESH_OPTIMIZER_CACHE_SIZE ? newCount : MESH_OPTIMIZER_CACHE_SIZE;
+        memcpy(cache, newCache, (size_t)cacheCount * sizeof(uint32_t));
+    }
+
+    free(source);
+    free(remaining);
+    free(adjacencyOffsets);
+    free(adjacency);
+    free(cachePositions);
+    free(vertexScores);
+    free(emitted);
+}
+
+// A run of triangles moved as a unit by the overdraw pass
+typedef struct {
+    size_t start;     // First triangle
+    size_t count;
+    float sortKey;    // How far the cluster faces out of the mesh
+} TriangleCluster;
+
+// Most outward-facing first, original order on ties
+static int compare_clusters(const void* a, const void* b) {
+    const TriangleCluster* clusterA = (const TriangleCluster*)a;
+    const TriangleCluster* clusterB = (const TriangleCluster*)b;
+    if (clusterA->sortKey != clusterB->sortKey) {
+        return clusterA->sortKey > clusterB->sortKey ? -1 : 1;
+    }
+    return clusterA->start < clusterB->start ? -1 : 1;
+}
+
+static const float* vertex_position(const float* positions, size_t positionStride, uint32_t vertex) {
+    return (const float*)((const unsigned char*)positions + vertex * positionStride);
+}
+
+// Run one triangle through the FIFO cache and return its vertex misses
+static int cache_triangle(unsigned int* timestamps, unsigned int* time, const uint32_t* triangle) {
+    int misses = 0;
+    for (int k = 0; k < 3; k++) {
+        if (*time - timestamps[triangle[k]] > MESH_OPTIMIZER_ANALYZE_CACHE_SIZE) {
+            timestamps[triangle[k]] = (*time)++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+// Age every entry out of the cache without touching the timestamps
+static void cache_flush(unsigned int* time) {
+    *time += MESH_OPTIMIZER_ANALYZE_CACHE_SIZE + 1;
+}
+
+// Reorder clusters of a cache-optimized list to reduce overdraw
+void mesh_optimize_overdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+                            const float* positions, size_t vertexCount, size_t positionStride,
+                            float threshold) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    uint32_t* source = (uint32_t*)malloc(indexCount * sizeof(uint32_t));
+    memcpy(source, indices, indexCount * sizeof(uint32_t));
+
+    unsigned int* timestamps = (unsigned int*)calloc(vertexCount, sizeof(unsigned int));
+    unsigned int time = MESH_OPTIMIZER_ANALYZE_CACHE_SIZE + 1;
+    TriangleCluster* clusters = (TriangleCluster*)malloc(triangleCount * sizeof(TriangleCluster));
+    size_t clusterCount = 0;
+
+    // Hard boundaries: a triangle missing on all three corners in the
+    // original order. Recorded as cluster starts, then split further below.
+    size_t* hardStarts = (size_t*)malloc((triangleCount + 1) * sizeof(size_t));
+    size_t hardCount = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (cache_triangle(timestamps, &time, &source[t * 3]) == 3 || t == 0) {
+            hardStarts[hardCount++] = t;
+        }
+    }
+    hardStarts[hardCount] = triangleCount;
+
+    // Soft boundaries (Tipsify): measure each hard cluster's ACMR from a cold
+    // cache, then cut it wherever the running ACMR of the current piece, also
+    // from a cold cache, has come down to threshold times that. Every piece
+    // then costs at most about threshold times its share wherever the sort
+    // puts it, instead of the split relying on the cache state it had.
+    for (size_t h = 0; h < hardCount; h++) {
+        size_t start = hardStarts[h];
+        size_t end = hardStarts[h + 1];
+
+        cache_flush(&time);
+        size_t clusterMisses = 0;
+        for (size_t t = start; t < end; t++) {
+            clusterMisses += (size_t)cache_triangle(timestamps, &time, &source[t * 3]);
+        }
+        float target = threshold * (float)clusterMisses / (float)(end - start);
+
+        cache_flush(&time);
+        size_t pieceStart = start;
+        size_t pieceMisses = 0;
+        for (size_t t = start; t < end; t++) {
+            pieceMisses += (size_t)cache_triangle(timestamps, &time, &source[t * 3]);
+
+            size_t pieceCount = t + 1 - pieceStart;
+            if (t + 1 == end || (float)pieceMisses <= target * (float)pieceCount) {
+                clusters[clusterCount].start = pieceStart;
+                clusters[clusterCount].count = pieceCount;
+                clusterCount++;
+
+                cache_flush(&time);
+                pieceStart = t + 1;
+                pieceMisses = 0;
+            }
+        }
+    }
+    free(hardStarts);
+
+    // Area-weighted centroid of the whole mesh
+    float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+    float* clusterData = (float*)calloc(clusterCount * 7, sizeof(float)); // centroid, normal, area
+
+    for (size_t c = 0; c < clusterCount; c++) {
+        float* data = &clusterData[c * 7];
+        for (size_t t = clusters[c].start; t < clusters[c].start + clusters[c].count; t++) {
+            const float* p0 = vertex_position(positions, positionStride, source[t * 3 + 0]);
+            const float* p1 = vertex_position(positions, positionStride, source[t * 3 + 1]);
+            const float* p2 = vertex_position(positions, positionStride, source[t * 3 + 2]);
+
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float normal[3] = {
+                e1[1] * e2[2] - e1[2] * e2[1],
+                e1[2] * e2[0] - e1[0] * e2[2],
+                e1[0] * e2[1] - e1[1] * e2[0]
+            };
+            // The cross product's length is twice the area, so summing it weights by area
+            float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+            for (int axis = 0; axis < 3; axis++) {
+                float center = (p0[axis] + p1[axis] + p2[axis]) / 3.0f;
+                data[axis] += center * area;
+                data[3 + axis] += normal[axis];
+                meshCentroid[axis] += center * area;
+            }
+            data[6] += area;
+            meshArea += area;
+        }
+    }
+
+    if (meshArea > 0.0f) {
+        for (int axis = 0; axis < 3; axis++) {
+            meshCentroid[axis] /= meshArea;
+        }
+    }
+
+    for (size_t c = 0; c < clusterCount; c++) {
+        const float* data = &clusterData[c * 7];
+        float normalLength = sqrtf(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+        float key = 0.0f;
+        if (data[6] > 0.0f && normalLength > 0.0f) {
+            for (int axis = 0; axis < 3; axis++) {
+                key += (data[axis] / data[6] - meshCentroid[axis]) * (data[3 + axis] / normalLength);
+            }
+        }
+        clusters[c].sortKey = key;
+    }
+
+    qsort(clusters, clusterCount, sizeof(TriangleCluster), compare_clusters);
+
+    size_t out = 0;
+    for (size_t c = 0; c < clusterCount; c++) {
+        size_t count = clusters[c].count * 3;
+        memcpy(&destination[out], &source[clusters[c].start * 3], count * sizeof(uint32_t));
+        out += count;
+    }
+
+    free(source);
+    free(timestamps);
+    free(clusters);
+    free(clusterData);
+}
+
+// Number vertices in first-use order
+size_t mesh_optimize_vertex_fetch(uint32_t* remap, const uint32_t* indices, size_t indexCount,
+                                  size_t vertexCount) {
+    memset(remap, 0xff, vertexCount * sizeof(uint32_t));
+
+    size_t next = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        if (remap[indices[i]] == UINT32_MAX) {
+            remap[indices[i]] = (uint32_t)next++;
+        }
+    }
+    return next;
+}
+
+// Vertex shader runs per triangle on a FIFO cache
+float mesh_analyze_acmr(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                        int cacheSize) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return 0.0f;
+    }
+
+    // A vertex is cached while fewer than cacheSize misses came after its own
+    unsigned int* timestamps = (unsigned int*)calloc(vertexCount, sizeof(unsigned int));
+    unsigned int time = (unsigned int)cacheSize + 1;
+    size_t misses = 0;
+
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        uint32_t vertex = indices[i];
+        if (time - timestamps[vertex] > (unsigned int)cacheSize) {
+            timestamps[vertex] = time++;
+            misses++;
+        }
+    }
+
+    free(timestamps);
+    return (float)misses / (float)triangleCount;
+}
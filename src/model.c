@@ -2,182 +2,621 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "cgltf.h"
+#include "file_map.h"
+#include "mesh_optimizer.h"
+#include "gl_state.h"
+#include "sampler.h"
+
+// Vertex attribute locations used by basic.vert
+#define MODEL_ATTRIB_POSITION 0
+#define MODEL_ATTRIB_NORMAL 1
+#define MODEL_ATTRIB_TEXCOORD 2
+
+// A triangle list rebuilt by the mesh optimizer: one interleaved float vertex
+// stream (position, then normal and texcoord when present) and its indices
+typedef struct {
+    float* vertices;
+    size_t vertexCount;
+    int stride;                // Bytes per vertex
+    void* indices;
+    GLenum indexType;          // 16-bit whenever the vertices fit
+    int indexCount;
+} OptimizedPrimitive;
+
+// A parsed file waiting for its GL upload. Built without GL calls, so it can
+// be prepared on a worker.
+typedef struct {
+    MappedFile file;
+    cgltf_data* data;          // Buffers point into the mapping for GLB files
+    void** unpacked;           // Per accessor: tightly packed copy when its layout can't be drawn from, else NULL
+    size_t* unpackedSizes;
+    int unpackedCount;
+    OptimizedPrimitive* optimized;   // Per primitive in model order; vertices NULL if drawn as stored
+    int primitiveCount;
+    int optimizedCount;
+    double trianglesOptimized;       // Triangle-weighted ACMR totals for the load report
+    double acmrBefore;
+    double acmrAfter;
+} ModelSource;
+
+// First attribute of a type (set 0 for texcoords), or NULL
+static const cgltf_accessor* find_attribute(const cgltf_primitive* primitive, cgltf_attribute_type type) {
+    for (size_t i = 0; i < primitive->attributes_count; i++) {
+        if (primitive->attributes[i].type == type && primitive->attributes[i].index == 0) {
+            return primitive->attributes[i].data;
+        }
+    }
+    return NULL;
+}
+
+// Vertex data GL can read in place: a plain view (any component type, any
+// stride). Sparse accessors and accessors without a view need unpacking.
+static bool vertex_layout_usable(const cgltf_accessor* accessor) {
+    return accessor->buffer_view != NULL && !accessor->is_sparse &&
+           cgltf_buffer_view_data(accessor->buffer_view) != NULL;
+}
+
+// Indices GL can read in place. 8-bit indices are widened; GPUs handle them poorly.
+static bool index_layout_usable(const cgltf_accessor* accessor) {
+    return vertex_layout_usable(accessor) &&
+           (accessor->component_type == cgltf_component_type_r_16u ||
+            accessor->component_type == cgltf_component_type_r_32u);
+}
+
+// Bulk-unpack an accessor that can't be drawn from as stored
+static void unpack_accessor(ModelSource* source, const cgltf_accessor* accessor, bool isIndex) {
+    size_t index = (size_t)(accessor - source->data->accessors);
+    if (source->unpacked[index] != NULL) {
+        return;
+    }
+
+    size_t size;
+    if (isIndex) {
+        size = accessor->count * sizeof(uint32_t);
+        source->unpacked[index] = malloc(size);
+        cgltf_accessor_unpack_indices(accessor, source->unpacked[index], sizeof(uint32_t), accessor->count);
+    } else {
+        size_t floatCount = accessor->count * cgltf_num_components(accessor->type);
+        size = floatCount * sizeof(float);
+        source->unpacked[index] = malloc(size);
+        cgltf_accessor_unpack_floats(accessor, (cgltf_float*)source->unpacked[index], floatCount);
+    }
+    source->unpackedSizes[index] = size;
+    source->unpackedCount++;
+}
+
+// Unpack an attribute in one pass into scratch, then copy it into its slot
+// of each interleaved vertex
+static void interleave_attribute(float* vertices, int floatsPerVertex, int offset,
+                                 const cgltf_accessor* accessor, int components, float* scratch) {
+    cgltf_accessor_unpack_floats(accessor, scratch, accessor->count * (size_t)components);
+    for (size_t v = 0; v < accessor->count; v++) {
+        memcpy(vertices + v * floatsPerVertex + offset, scratch + v * components,
+               (size_t)components * sizeof(float));
+    }
+}
+
+// Rebuild a triangle list for the post-transform cache: deduplicate its
+// vertices, reorder triangles for cache reuse then overdraw, and renumber
+// vertices in fetch order. Returns false to draw the primitive as stored.
+static bool optimize_primitive(ModelSource* source, const cgltf_primitive* primitive,
+                               OptimizedPrimitive* optimized) {
+    const cgltf_accessor* positions = find_attribute(primitive, cgltf_attribute_type_position);
+    const cgltf_accessor* normals = find_attribute(primitive, cgltf_attribute_type_normal);
+    const cgltf_accessor* texcoords = find_attribute(primitive, cgltf_attribute_type_texcoord);
+    if (primitive->type != cgltf_primitive_type_triangles || !positions || positions->count == 0) {
+        return false;
+    }
+
+    size_t vertexCount = positions->count;
+    size_t indexCount = primitive->indices ? primitive->indices->count : vertexCount;
+    if (indexCount % 3 != 0 ||
+        cgltf_num_components(positions->type) != 3 ||
+        (normals && (normals->count != vertexCount || cgltf_num_components(normals->type) != 3)) ||
+        (texcoords && (texcoords->count != vertexCount || cgltf_num_components(texcoords->type) != 2))) {
+        return false;
+    }
+
+    // Interleave the attributes as floats
+    int floatsPerVertex = 3 + (normals ? 3 : 0) + (texcoords ? 2 : 0);
+    size_t stride = (size_t)floatsPerVertex * sizeof(float);
+    float* vertices = (float*)malloc(vertexCount * stride);
+    float* scratch = (float*)malloc(vertexCount * 3 * sizeof(float));
+    interleave_attribute(vertices, floatsPerVertex, 0, positions, 3, scratch);
+    if (normals) {
+        interleave_attribute(vertices, floatsPerVertex, 3, normals, 3, scratch);
+    }
+    if (texcoords) {
+        interleave_attribute(vertices, floatsPerVertex, floatsPerVertex - 2, texcoords, 2, scratch);
+    }
+    free(scratch);
+
+    uint32_t* indices = (uint32_t*)malloc(indexCount * sizeof(uint32_t));
+    uint32_t* remap = (uint32_t*)malloc(vertexCount * sizeof(uint32_t));
+    float acmrBefore;
+
+    // Unindexed lists get an index buffer out of deduplication
+    if (primitive->indices) {
+        cgltf_accessor_unpack_indices(primitive->indices, indices, sizeof(uint32_t), indexCount);
+        acmrBefore = mesh_analyze_acmr(indices, indexCount, vertexCount, MESH_OPTIMIZER_ANALYZE_CACHE_SIZE);
+    } else {
+        acmrBefore = 3.0f;
+    }
+    size_t uniqueCount = mesh_generate_remap(remap, primitive->indices ? indices : NULL, indexCount,
+                                             vertices, vertexCount, stride);
+    if (primitive->indices) {
+        mesh_remap_indices(indices, indexCount, remap);
+    } else {
+        memcpy(indices, remap, indexCount * sizeof(uint32_t));
+    }
+    float* unique = (float*)malloc(uniqueCount * stride);
+    mesh_remap_vertices(unique, vertices, vertexCount, stride, remap);
+
+    mesh_optimize_vertex_cache(indices, indices, indexCount, uniqueCount);
+    mesh_optimize_overdraw(indices, indices, indexCount, unique, uniqueCount, stride,
+                           MESH_OPTIMIZER_OVERDRAW_THRESHOLD);
+
+    size_t fetchCount = mesh_optimize_vertex_fetch(remap, indices, indexCount, uniqueCount);
+    mesh_remap_indices(indices, indexCount, remap);
+    mesh_remap_vertices(vertices, unique, uniqueCount, stride, remap);
+    free(unique);
+    free(remap);
+
+    float acmrAfter = mesh_analyze_acmr(indices, indexCount, fetchCount, MESH_OPTIMIZER_ANALYZE_CACHE_SIZE);
+
+    if (fetchCount <= MESH_OPTIMIZER_MAX_SHORT_VERTICES) {
+        uint16_t* shortIndices = (uint16_t*)malloc(indexCount * sizeof(uint16_t));
+        for (size_t i = 0; i < indexCount; i++) {
+            shortIndices[i] = (uint16_t)indices[i];
+        }
+        free(indices);
+        optimized->indices = shortIndices;
+        optimized->indexType = GL_UNSIGNED_SHORT;
+    } else {
+        optimized->indices = indices;
+        optimized->indexType = GL_UNSIGNED_INT;
+    }
+    optimized->vertices = vertices;
+    optimized->vertexCount = fetchCount;
+    optimized->stride = (int)stride;
+    optimized->indexCount = (int)indexCount;
+
+    double triangles = (double)(indexCount / 3);
+    source->trianglesOptimized += triangles;
+    source->acmrBefore += acmrBefore * triangles;
+    source->acmrAfter += acmrAfter * triangles;
+    source->optimizedCount++;
+    return true;
+}
+
+// Free everything a source holds, unmapping the file
+static void model_source_free(ModelSource* source) {
+    if (source->data) {
+        for (size_t i = 0; i < source->data->accessors_count; i++) {
+            free(source->unpacked[i]);
+        }
+        cgltf_free(source->data);
+    }
+    for (int i = 0; source->optimized && i < source->primitiveCount; i++) {
+        free(source->optimized[i].vertices);
+        free(source->optimized[i].indices);
+    }
+    free(source->optimized);
+    free(source->unpacked);
+    free(source->unpackedSizes);
+    file_map_close(&source->file);
+    memset(source, 0, sizeof(*source));
+}
+
+// Map and parse the file and unpack the accessors GL can't read as stored (no GL calls)
+static bool model_parse(ModelSource* source, const char* filename) {
+    memset(source, 0, sizeof(*source));
+
+    if (!file_map_open(&source->file, filename)) {
+        printf("Failed to open model file: %s\n", filename);
+        return false;
+    }
 
-void model_load(Model* model, const char* filename) {
     // Parse the GLB file
     cgltf_options options = {0};
-    cgltf_result result = cgltf_parse_file(&options, filename, &model->data);
-    
+    cgltf_result result = cgltf_parse(&options, source->file.data, source->file.size, &source->data);
+
     if (result != cgltf_result_success) {
         printf("Failed to parse GLB file: %s\n", filename);
-        return;
+        model_source_free(source);
+        return false;
+    }
+
+    // A GLB's buffer is its binary chunk, used in place inside the mapping;
+    // only external .bin files of a text glTF are read
+    result = cgltf_load_buffers(&options, source->data, filename);
+    if (result == cgltf_result_success) {
+        result = cgltf_validate(source->data);
     }
-    
-    // Load buffers
-    result = cgltf_load_buffers(&options, model->data, filename);
     if (result != cgltf_result_success) {
         printf("Failed to load GLB buffers\n");
-        cgltf_free(model->data);
-        model->data = NULL;
-        return;
+        model_source_free(source);
+        return false;
     }
-    
-    // Count meshes
-    model->meshCount = model->data->meshes_count;
-    model->meshes = (Mesh*)malloc(model->meshCount * sizeof(Mesh));
-    
-    // Process each mesh
-    for (int i = 0; i < model->meshCount; i++) {
-        cgltf_mesh* mesh = &model->data->meshes[i];
-        
-        // For simplicity, we'll only process the first primitive of each mesh
-        if (mesh->primitives_count > 0) {
-            cgltf_primitive* primitive = &mesh->primitives[0];
-            
-            // Find position, normal, and texcoord attributes
-            cgltf_accessor* positions = NULL;
-            cgltf_accessor* normals = NULL;
-            cgltf_accessor* texcoords = NULL;
-            
-            for (size_t j = 0; j < primitive->attributes_count; j++) {
-                if (primitive->attributes[j].type == cgltf_attribute_type_position) {
-                    positions = primitive->attributes[j].data;
-                } else if (primitive->attributes[j].type == cgltf_attribute_type_normal) {
-                    normals = primitive->attributes[j].data;
-                } else if (primitive->attributes[j].type == cgltf_attribute_type_texcoord) {
-                    texcoords = primitive->attributes[j].data;
-                }
+
+    size_t accessorCount = source->data->accessors_count;
+    source->unpacked = (void**)calloc(accessorCount ? accessorCount : 1, sizeof(void*));
+    source->unpackedSizes = (size_t*)calloc(accessorCount ? accessorCount : 1, sizeof(size_t));
+
+    for (size_t m = 0; m < source->data->meshes_count; m++) {
+        source->primitiveCount += (int)source->data->meshes[m].primitives_count;
+    }
+    source->optimized = (OptimizedPrimitive*)calloc(source->primitiveCount ? (size_t)source->primitiveCount : 1,
+                                                    sizeof(OptimizedPrimitive));
+
+    int primitiveIndex = 0;
+    for (size_t m = 0; m < source->data->meshes_count; m++) {
+        const cgltf_mesh* mesh = &source->data->meshes[m];
+        for (size_t p = 0; p < mesh->primitives_count; p++) {
+            const cgltf_primitive* primitive = &mesh->primitives[p];
+            // Triangle lists are rebuilt; everything else is drawn from the file
+            if (optimize_primitive(source, primitive, &source->optimized[primitiveIndex++])) {
+                continue;
             }
-            
-            if (positions) {
-                // Get indices
-                cgltf_accessor* indices = primitive->indices;
-                
-                // Allocate vertex data
-                int vertexCount = positions->count;
-                int stride = 8; // 3 for position, 3 for normal, 2 for texcoord
-                model->meshes[i].vertexCount = vertexCount;
-                model->meshes[i].vertices = (float*)malloc(vertexCount * stride * sizeof(float));
-                
-                // Fill vertex data
-                for (int j = 0; j < vertexCount; j++) {
-                    // Position
-                    cgltf_accessor_read_float(positions, j, &model->meshes[i].vertices[j * stride], 3);
-                    
-                    // Normal (if available)
-                    if (normals) {
-                        cgltf_accessor_read_float(normals, j, &model->meshes[i].vertices[j * stride + 3], 3);
-                    } else {
-                        model->meshes[i].vertices[j * stride + 3] = 0.0f;
-                        model->meshes[i].vertices[j * stride + 4] = 1.0f;
-                        model->meshes[i].vertices[j * stride + 5] = 0.0f;
-                    }
-                    
-                    // Texcoord (if available)
-                    if (texcoords) {
-                        cgltf_accessor_read_float(texcoords, j, &model->meshes[i].vertices[j * stride + 6], 2);
-                    } else {
-                        model->meshes[i].vertices[j * stride + 6] = 0.0f;
-                        model->meshes[i].vertices[j * stride + 7] = 0.0f;
-                    }
-                }
-                
-                // Process indices
-                if (indices) {
-                    model->meshes[i].indexCount = indices->count;
-                    model->meshes[i].indices = (unsigned int*)malloc(indices->count * sizeof(unsigned int));
-                    
-                    for (int j = 0; j < indices->count; j++) {
-                        model->meshes[i].indices[j] = cgltf_accessor_read_index(indices, j);
-                    }
-                } else {
-                    // If no indices, create sequential indices
-                    model->meshes[i].indexCount = vertexCount;
-                    model->meshes[i].indices = (unsigned int*)malloc(vertexCount * sizeof(unsigned int));
-                    
-                    for (int j = 0; j < vertexCount; j++) {
-                        model->meshes[i].indices[j] = j;
-                    }
+
+            const cgltf_accessor* attributes[3] = {
+                find_attribute(primitive, cgltf_attribute_type_position),
+                find_attribute(primitive, cgltf_attribute_type_normal),
+                find_attribute(primitive, cgltf_attribute_type_texcoord)
+            };
+
+            for (int a = 0; a < 3; a++) {
+                if (attributes[a] && !vertex_layout_usable(attributes[a])) {
+                    unpack_accessor(source, attributes[a], false);
                 }
-                
-                // Set default color (yellow for hazmat suit)
-                model->meshes[i].color[0] = 1.0f;
-                model->meshes[i].color[1] = 1.0f;
-                model->meshes[i].color[2] = 0.0f;
-                
-                // Create VAO, VBO, EBO
-                glGenVertexArrays(1, &model->meshes[i].VAO);
-                glGenBuffers(1, &model->meshes[i].VBO);
-                glGenBuffers(1, &model->meshes[i].EBO);
-                
-                // Bind VAO
-                glBindVertexArray(model->meshes[i].VAO);
-                
-                // Bind VBO and copy vertex data
-                glBindBuffer(GL_ARRAY_BUFFER, model->meshes[i].VBO);
-                glBufferData(GL_ARRAY_BUFFER, vertexCount * stride * sizeof(float), model->meshes[i].vertices, GL_STATIC_DRAW);
-                
-                // Bind EBO and copy index data
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->meshes[i].EBO);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, model->meshes[i].indexCount * sizeof(unsigned int), model->meshes[i].indices, GL_STATIC_DRAW);
-                
-                // Set vertex attribute pointers
-                // Position attribute
-                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)0);
-                glEnableVertexAttribArray(0);
-                
-                // Normal attribute
-                glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(3 * sizeof(float)));
-                glEnableVertexAttribArray(1);
-                
-                // Texcoord attribute
-                glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(6 * sizeof(float)));
-                glEnableVertexAttribArray(2);
-                
-                // Unbind VAO
-                glBindVertexArray(0);
-                
-                // Set texture flag (for now, no textures)
-                model->meshes[i].hasTexture = false;
             }
+            if (primitive->indices && !index_layout_usable(primitive->indices)) {
+                unpack_accessor(source, primitive->indices, true);
+            }
+        }
+    }
+    return true;
+}
+
+// GL type of a vertex component
+static GLenum gl_component_type(cgltf_component_type type) {
+    switch (type) {
+        case cgltf_component_type_r_8:   return GL_BYTE;
+        case cgltf_component_type_r_8u:  return GL_UNSIGNED_BYTE;
+        case cgltf_component_type_r_16:  return GL_SHORT;
+        case cgltf_component_type_r_16u: return GL_UNSIGNED_SHORT;
+        case cgltf_component_type_r_32u: return GL_UNSIGNED_INT;
+        default:                         return GL_FLOAT;
+    }
+}
+
+// GL draw mode of a primitive
+static GLenum gl_primitive_mode(cgltf_primitive_type type) {
+    switch (type) {
+        case cgltf_primitive_type_points:         return GL_POINTS;
+        case cgltf_primitive_type_lines:          return GL_LINES;
+        case cgltf_primitive_type_line_loop:      return GL_LINE_LOOP;
+        case cgltf_primitive_type_line_strip:     return GL_LINE_STRIP;
+        case cgltf_primitive_type_triangle_strip: return GL_TRIANGLE_STRIP;
+        case cgltf_primitive_type_triangle_fan:   return GL_TRIANGLE_FAN;
+        default:                                  return GL_TRIANGLES;
+    }
+}
+
+// GL buffers created while uploading one model, each made at most once
+typedef struct {
+    Model* model;
+    ModelSource* source;
+    unsigned int* viewBuffers;       // Per buffer view
+    unsigned int* accessorBuffers;   // Per unpacked accessor
+} ModelUpload;
+
+// Create a static buffer holding size bytes of data
+static unsigned int create_buffer(ModelUpload* upload, const void* data, size_t size) {
+    unsigned int buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)size, data, GL_STATIC_DRAW);
+
+    upload->model->buffers[upload->model->bufferCount++] = buffer;
+    upload->model->gpuBytes += (long long)size;
+    return buffer;
+}
+
+// Buffer holding an accessor's data and the byte offset of its first element
+static unsigned int accessor_buffer(ModelUpload* upload, const cgltf_accessor* accessor, size_t* offset) {
+    size_t index = (size_t)(accessor - upload->source->data->accessors);
+
+    if (upload->source->unpacked[index] != NULL) {
+        if (upload->accessorBuffers[index] == 0) {
+            upload->accessorBuffers[index] = create_buffer(upload, upload->source->unpacked[index],
+                                                           upload->source->unpackedSizes[index]);
         }
+        *offset = 0;
+        return upload->accessorBuffers[index];
+    }
+
+    // Straight from the mapped file: the whole view, once per model
+    const cgltf_buffer_view* view = accessor->buffer_view;
+    size_t viewIndex = (size_t)(view - upload->source->data->buffer_views);
+    if (upload->viewBuffers[viewIndex] == 0) {
+        upload->viewBuffers[viewIndex] = create_buffer(upload, cgltf_buffer_view_data(view), view->size);
     }
-    
+    *offset = accessor->offset;
+    return upload->viewBuffers[viewIndex];
+}
+
+// Point a vertex attribute at an accessor (the primitive's VAO must be bound)
+static void bind_attribute(ModelUpload* upload, GLuint location, const cgltf_accessor* accessor) {
+    size_t offset;
+    unsigned int buffer = accessor_buffer(upload, accessor, &offset);
+    size_t index = (size_t)(accessor - upload->source->data->accessors);
+    GLint components = (GLint)cgltf_num_components(accessor->type);
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (upload->source->unpacked[index] != NULL) {
+        glVertexAttribPointer(location, components, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    } else {
+        glVertexAttribPointer(location, components, gl_component_type(accessor->component_type),
+                              accessor->normalized ? GL_TRUE : GL_FALSE, (GLsizei)accessor->stride,
+                              (void*)offset);
+    }
+    glEnableVertexAttribArray(location);
+}
+
+// Resolve a material to the flat color model_render uploads, once at load.
+// The hazmat suit's visor and gloves are recognised by name; other materials
+// use their base color, and plain white (the glTF default) stays suit yellow.
+static void resolve_material_color(const cgltf_material* material, vec3 color) {
+    glm_vec3_copy((vec3){1.0f, 1.0f, 0.0f}, color);
+    if (!material) {
+        return;
+    }
+
+    if (material->name && strstr(material->name, "visor")) {
+        glm_vec3_copy((vec3){0.1f, 0.1f, 0.1f}, color);
+    } else if (material->name && strstr(material->name, "glove")) {
+        glm_vec3_copy((vec3){0.5f, 0.5f, 0.5f}, color);
+    } else if (material->has_pbr_metallic_roughness) {
+        const cgltf_float* factor = material->pbr_metallic_roughness.base_color_factor;
+        if (factor[0] != 1.0f || factor[1] != 1.0f || factor[2] != 1.0f) {
+            glm_vec3_copy((vec3){factor[0], factor[1], factor[2]}, color);
+        }
+    }
+}
+
+// Point the bound VAO at an optimized primitive's own vertex and index buffers
+static void bind_optimized(ModelUpload* upload, const OptimizedPrimitive* optimized, Mesh* mesh) {
+    create_buffer(upload, optimized->vertices, optimized->vertexCount * (size_t)optimized->stride);
+
+    // create_buffer leaves the vertex buffer bound
+    size_t offset = 0;
+    glVertexAttribPointer(MODEL_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, optimized->stride, (void*)offset);
+    glEnableVertexAttribArray(MODEL_ATTRIB_POSITION);
+    offset += 3 * sizeof(float);
+    if (mesh->hasNormals) {
+        glVertexAttribPointer(MODEL_ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, optimized->stride, (void*)offset);
+        glEnableVertexAttribArray(MODEL_ATTRIB_NORMAL);
+        offset += 3 * sizeof(float);
+    }
+    if (mesh->hasTexCoords) {
+        glVertexAttribPointer(MODEL_ATTRIB_TEXCOORD, 2, GL_FLOAT, GL_FALSE, optimized->stride, (void*)offset);
+        glEnableVertexAttribArray(MODEL_ATTRIB_TEXCOORD);
+    }
+
+    size_t indexSize = optimized->indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+    unsigned int indexBuffer = create_buffer(upload, optimized->indices, (size_t)optimized->indexCount * indexSize);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    mesh->indexType = optimized->indexType;
+    mesh->indexOffset = 0;
+    mesh->count = optimized->indexCount;
+}
+
+// Create one primitive's VAO
+static void upload_primitive(ModelUpload* upload, const cgltf_primitive* primitive,
+                             const OptimizedPrimitive* optimized, Mesh* mesh) {
+    const cgltf_accessor* positions = find_attribute(primitive, cgltf_attribute_type_position);
+    const cgltf_accessor* normals = find_attribute(primitive, cgltf_attribute_type_normal);
+    const cgltf_accessor* texcoords = find_attribute(primitive, cgltf_attribute_type_texcoord);
+    if (!positions) {
+        return;
+    }
+
+    mesh->mode = gl_primitive_mode(primitive->type);
+    mesh->hasNormals = normals != NULL;
+    mesh->hasTexCoords = texcoords != NULL;
+
+    resolve_material_color(primitive->material, mesh->color);
+
+    glGenVertexArrays(1, &mesh->VAO);
+    gl_state_bind_vertex_array(mesh->VAO);
+
+    if (optimized->vertices != NULL) {
+        bind_optimized(upload, optimized, mesh);
+        gl_state_bind_vertex_array(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        mesh->hasTexture = false;
+        return;
+    }
+
+    bind_attribute(upload, MODEL_ATTRIB_POSITION, positions);
+    if (normals) {
+        bind_attribute(upload, MODEL_ATTRIB_NORMAL, normals);
+    }
+    if (texcoords) {
+        bind_attribute(upload, MODEL_ATTRIB_TEXCOORD, texcoords);
+    }
+
+    if (primitive->indices) {
+        const cgltf_accessor* indices = primitive->indices;
+        size_t index = (size_t)(indices - upload->source->data->accessors);
+        size_t offset;
+        unsigned int buffer = accessor_buffer(upload, indices, &offset);
+
+        // The element binding is VAO state
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+        mesh->indexType = upload->source->unpacked[index] != NULL ? GL_UNSIGNED_INT
+                                                                   : gl_component_type(indices->component_type);
+        mesh->indexOffset = offset;
+        mesh->count = (int)indices->count;
+    } else {
+        mesh->indexType = 0;
+        mesh->count = (int)positions->count;
+    }
+
+    gl_state_bind_vertex_array(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Set texture flag (for now, no textures)
+    mesh->hasTexture = false;
+}
+
+// Create the GL objects for every primitive, then free the source
+static void model_upload(Model* model, ModelSource* source) {
+    const cgltf_data* data = source->data;
+    memset(model, 0, sizeof(*model));
+
+    int primitiveCount = 0;
+    for (size_t m = 0; m < data->meshes_count; m++) {
+        primitiveCount += (int)data->meshes[m].primitives_count;
+    }
+
+    model->meshes = (Mesh*)calloc(primitiveCount ? (size_t)primitiveCount : 1, sizeof(Mesh));
+    // Views and unpacked accessors are shared; optimized primitives own two buffers each
+    model->buffers = (unsigned int*)calloc(data->buffer_views_count + data->accessors_count +
+                                           2 * (size_t)primitiveCount + 1, sizeof(unsigned int));
+
+    ModelUpload upload = {
+        model,
+        source,
+        (unsigned int*)calloc(data->buffer_views_count + 1, sizeof(unsigned int)),
+        (unsigned int*)calloc(data->accessors_count + 1, sizeof(unsigned int))
+    };
+
+    for (size_t m = 0; m < data->meshes_count; m++) {
+        for (size_t p = 0; p < data->meshes[m].primitives_count; p++) {
+            upload_primitive(&upload, &data->meshes[m].primitives[p], &source->optimized[model->meshCount],
+                             &model->meshes[model->meshCount]);
+            model->meshCount++;
+        }
+    }
+
+    free(upload.viewBuffers);
+    free(upload.accessorBuffers);
+
+    printf("Model uploaded: %d primitives, %d buffers (%d unpacked accessors), %.1f KiB on the GPU\n",
+           model->meshCount, model->bufferCount, source->unpackedCount, (double)model->gpuBytes / 1024.0);
+    if (source->trianglesOptimized > 0.0) {
+        printf("Mesh optimizer: %d primitives, %.0f triangles, ACMR %.3f -> %.3f (FIFO %d)\n",
+               source->optimizedCount, source->trianglesOptimized,
+               source->acmrBefore / source->trianglesOptimized, source->acmrAfter / source->trianglesOptimized,
+               MESH_OPTIMIZER_ANALYZE_CACHE_SIZE);
+    }
+
+    // Nothing on the CPU outlives the upload
+    model_source_free(source);
+}
+
+void model_load(Model* model, const char* filename) {
+    memset(model, 0, sizeof(*model));
+
+    ModelSource source;
+    if (!model_parse(&source, filename)) {
+        return;
+    }
+    model_upload(model, &source);
     printf("Successfully loaded model: %s with %d meshes\n", filename, model->meshCount);
 }
 
+// A model being loaded by model_load_async
+typedef struct {
+    Model* model;
+    char* filename;
+    ModelSource source;
+} ModelLoad;
+
+static bool decode_model(void* payload) {
+    ModelLoad* load = (ModelLoad*)payload;
+    return model_parse(&load->source, load->filename);
+}
+
+static bool upload_model(void* payload, bool decoded) {
+    ModelLoad* load = (ModelLoad*)payload;
+    if (decoded) {
+        model_upload(load->model, &load->source);
+        printf("Successfully loaded model: %s with %d meshes\n", load->filename, load->model->meshCount);
+    }
+    free(load->filename);
+    free(load);
+    return decoded;
+}
+
+void model_load_async(Model* model, const char* filename, AssetState* state) {
+    memset(model, 0, sizeof(*model));
+
+    ModelLoad* load = (ModelLoad*)calloc(1, sizeof(ModelLoad));
+    size_t length = strlen(filename) + 1;
+    load->model = model;
+    load->filename = (char*)malloc(length);
+    memcpy(load->filename, filename, length);
+    asset_loader_submit(decode_model, upload_model, load, state);
+}
+
 void model_render(Model* model, Shader* shader) {
+    int colorUniform = shader_uniform(shader, "objectColor");
+    int useTextureUniform = shader_uniform(shader, "useTexture");
+
     for (int i = 0; i < model->meshCount; i++) {
+        const Mesh* mesh = &model->meshes[i];
+        if (mesh->VAO == 0) {
+            continue;
+        }
+
         // Set material properties
-        shader_set_vec3(shader, "objectColor", model->meshes[i].color);
-        shader_set_bool(shader, "useTexture", model->meshes[i].hasTexture);
-        
-        if (model->meshes[i].hasTexture) {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, model->meshes[i].texture);
+        shader_uniform_vec3(shader, colorUniform, (float*)mesh->color);
+        shader_uniform_bool(shader, useTextureUniform, mesh->hasTexture);
+
+        if (mesh->hasTexture) {
+            gl_state_bind_texture(0, mesh->texture);
+            gl_state_bind_sampler(0, sampler_get(SAMPLER_MIPMAPPED));
+        }
+
+        // Constant values for attributes the primitive doesn't have
+        if (!mesh->hasNormals) {
+            glVertexAttrib3f(MODEL_ATTRIB_NORMAL, 0.0f, 1.0f, 0.0f);
         }
-        
+        if (!mesh->hasTexCoords) {
+            glVertexAttrib2f(MODEL_ATTRIB_TEXCOORD, 0.0f, 0.0f);
+        }
+
         // Draw mesh
-        glBindVertexArray(model->meshes[i].VAO);
-        glDrawElements(GL_TRIANGLES, model->meshes[i].indexCount, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        gl_state_bind_vertex_array(mesh->VAO);
+        if (mesh->indexType != 0) {
+            glDrawElements(mesh->mode, mesh->count, mesh->indexType, (void*)mesh->indexOffset);
+        } else {
+            glDrawArrays(mesh->mode, 0, mesh->count);
+        }
+        gl_state_bind_vertex_array(0);
     }
 }
 
 void model_cleanup(Model* model) {
     for (int i = 0; i < model->meshCount; i++) {
-        glDeleteVertexArrays(1, &model->meshes[i].VAO);
-        glDeleteBuffers(1, &model->meshes[i].VBO);
-        glDeleteBuffers(1, &model->meshes[i].EBO);
-        
+        if (model->meshes[i].VAO != 0) {
+            gl_state_delete_vertex_arrays(1, &model->meshes[i].VAO);
+        }
+
         if (model->meshes[i].hasTexture) {
-            glDeleteTextures(1, &model->meshes[i].texture);
+            gl_state_delete_textures(1, &model->meshes[i].texture);
         }
-        
-        free(model->meshes[i].vertices);
-        free(model->meshes[i].indices);
     }
-    
+
+    if (model->bufferCount > 0) {
+        glDeleteBuffers(model->bufferCount, model->buffers);
+    }
+
     free(model->meshes);
-    cgltf_free(model->data);
-} 
\ No newline at end of file
+    free(model->buffers);
+    memset(model, 0, sizeof(*model));
+}
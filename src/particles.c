@@ -0,0 +1,310 @@
+#include "particles.h"
+#include "shader.h"
+#include "renderer.h"
+#include "gl_state.h"
+#include "physics.h"
+#include "profiler.h"
+#include <stddef.h>
+#include <string.h>
+
+#include "logging.h"
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Smallest ring worth creating
+#define PARTICLES_MIN_CAPACITY 1024
+
+// Motion shared by every particle
+#define PARTICLE_GRAVITY 6.0f
+#define PARTICLE_DRAG 1.5f
+
+// One particle as the update shader reads and writes it (three attributes,
+// interleaved in the order of the captured varyings)
+typedef struct {
+    float position[3];
+    float age;             // Seconds alive
+    float velocity[3];
+    float lifetime;        // Seconds to live; dead once age reaches it
+    float hue;             // [0, 1), drifts as the particle ages
+    float size;            // World units
+} Particle;
+
+// Look and motion of an effect
+typedef struct {
+    int count;             // Particles per emitter
+    float speed;           // Launch speed, randomized down to 35%
+    float spread;          // 0 launches along the direction, 1 in any direction
+    float hue;
+    float hueSpread;       // Hue range around hue (1 for the full rainbow)
+    float size;
+    float lifetime;        // Longest life, randomized down to half
+    float lift;            // Added to the emitter height
+} ParticleEffectDesc;
+
+static const ParticleEffectDesc effects[PARTICLE_EFFECT_COUNT] = {
+    [PARTICLE_EFFECT_HIT]   = {  600, 2.5f, 0.60f, 0.08f, 0.10f, 0.05f, 0.6f, 0.0f},
+    [PARTICLE_EFFECT_DEATH] = { 6000, 4.0f, 1.00f, 0.00f, 1.00f, 0.06f, 1.6f, 0.0f},
+    [PARTICLE_EFFECT_SLASH] = { 3000, 5.0f, 0.35f, 0.55f, 0.15f, 0.04f, 0.5f, 0.5f},
+    [PARTICLE_EFFECT_SPIN]  = { 2000, 3.0f, 1.00f, 0.13f, 0.05f, 0.04f, 0.9f, 0.0f},
+};
+
+// An effect waiting for an update pass
+typedef struct {
+    ParticleEffect effect;
+    vec3 position;
+    vec3 direction;
+} PendingEmitter;
+
+static Shader updateShader;
+static Shader renderShader;
+static struct {
+    int deltaTime, gravity, drag, groundLevel, capacity, seed;
+    int emitterCount, emitterRange, emitterOrigin, emitterShape, emitterLook;
+} updateUniforms;
+static int viewportHeightUniform = -1;
+
+// Ping-pong particle buffers and a vertex array reading each
+static GLuint buffers[2] = {0, 0};
+static GLuint vaos[2] = {0, 0};
+static int source = 0;             // Buffer holding the current particles
+
+// Ring of slots: emitters claim runs from cursor on. Only slots below
+// highWater have ever held a particle and need simulating.
+static int capacity = 0;
+static int cursor = 0;
+static int highWater = 0;
+static float quietIn = 0.0f;       // Seconds until every particle has died
+static unsigned int passSeed = 0;
+
+static PendingEmitter queue[PARTICLES_QUEUE_CAPACITY];
+static int queueCount = 0;
+
+static ParticleStats stats;
+
+// Viewport height for the queued draw
+static float drawViewportHeight = 0.0f;
+
+// Describe a particle buffer to a vertex array
+static void bind_particle_attributes(GLuint vao, GLuint buffer) {
+    gl_state_bind_vertex_array(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, velocity));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, hue));
+    glEnableVertexAttribArray(2);
+    
+    gl_state_bind_vertex_array(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Create the particle buffers and compile the update and render programs
+bool particles_init(int requestedCapacity) {
+    capacity = requestedCapacity < PARTICLES_MIN_CAPACITY ? PARTICLES_MIN_CAPACITY : requestedCapacity;
+    cursor = 0;
+    highWater = 0;
+    quietIn = 0.0f;
+    queueCount = 0;
+    source = 0;
+    memset(&stats, 0, sizeof(stats));
+    stats.capacity = capacity;
+    
+    static const char* const varyings[] = {"outPositionAge", "outVelocityLife", "outHueSize"};
+    shader_init_feedback(&updateShader, "assets/shaders/particle_update.vert", varyings, 3);
+    shader_init(&renderShader, "assets/shaders/particle.vert", "assets/shaders/particle.frag");
+    if (updateShader.ID == 0 || renderShader.ID == 0) {
+        LOG("Particle shaders failed to load, particles disabled");
+        particles_cleanup();
+        return false;
+    }
+    
+    updateUniforms.deltaTime = shader_uniform(&updateShader, "deltaTime");
+    updateUniforms.gravity = shader_uniform(&updateShader, "gravity");
+    updateUniforms.drag = shader_uniform(&updateShader, "drag");
+    updateUniforms.groundLevel = shader_uniform(&updateShader, "groundLevel");
+    updateUniforms.capacity = shader_uniform(&updateShader, "capacity");
+    updateUniforms.seed = shader_uniform(&updateShader, "seed");
+    updateUniforms.emitterCount = shader_uniform(&updateShader, "emitterCount");
+    updateUniforms.emitterRange = shader_uniform(&updateShader, "emitterRange");
+    updateUniforms.emitterOrigin = shader_uniform(&updateShader, "emitterOrigin");
+    updateUniforms.emitterShape = shader_uniform(&updateShader, "emitterShape");
+    updateUniforms.emitterLook = shader_uniform(&updateShader, "emitterLook");
+    viewportHeightUniform = shader_uniform(&renderShader, "viewportHeight");
+    
+    // No initial contents: a slot is only read after an emitter has seeded it
+    glGenBuffers(2, buffers);
+    glGenVertexArrays(2, vaos);
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(Particle), NULL, GL_DYNAMIC_COPY);
+        bind_particle_attributes(vaos[i], buffers[i]);
+    }
+    
+    LOG("Particle ring: %d particles, %.1f MB per buffer", capacity,
+        (double)capacity * sizeof(Particle) / (1024.0 * 1024.0));
+    return true;
+}
+
+// Queue an effect at position
+void particles_emit(ParticleEffect effect, const vec3 position, const vec3 direction) {
+    if (capacity == 0 || queueCount >= PARTICLES_QUEUE_CAPACITY) {
+        return;
+    }
+    
+    PendingEmitter* emitter = &queue[queueCount++];
+    emitter->effect = effect;
+    glm_vec3_copy((float*)position, emitter->position);
+    if (direction) {
+        glm_vec3_copy((float*)direction, emitter->direction);
+    } else {
+        glm_vec3_zero(emitter->direction);
+    }
+}
+
+// Start the queued emitters and advance every particle
+void particles_update(float deltaTime) {
+    if (capacity == 0) {
+        return;
+    }
+    
+    stats.simulated = 0;
+    stats.spawned = 0;
+    stats.emitters = 0;
+    
+    // Once everything has died the ring starts over and costs nothing
+    quietIn -= deltaTime;
+    if (quietIn <= 0.0f && queueCount == 0) {
+        cursor = 0;
+        highWater = 0;
+        stats.pendingEmitters = 0;
+        return;
+    }
+    
+    // Claim slots for as many emitters as one pass takes, never more than
+    // the ring holds so runs don't overlap
+    int ranges[PARTICLES_MAX_EMITTERS][2];
+    float origins[PARTICLES_MAX_EMITTERS][4];
+    float shapes[PARTICLES_MAX_EMITTERS][4];
+    float looks[PARTICLES_MAX_EMITTERS][4];
+    int emitterCount = 0;
+    int budget = capacity;
+    
+    while (emitterCount < queueCount && emitterCount < PARTICLES_MAX_EMITTERS && budget > 0) {
+        const PendingEmitter* emitter = &queue[emitterCount];
+        const ParticleEffectDesc* desc = &effects[emitter->effect];
+        int count = desc->count < budget ? desc->count : budget;
+        
+        ranges[emitterCount][0] = cursor;
+        ranges[emitterCount][1] = count;
+        origins[emitterCount][0] = emitter->position[0];
+        origins[emitterCount][1] = emitter->position[1] + desc->lift;
+        origins[emitterCount][2] = emitter->position[2];
+        origins[emitterCount][3] = desc->speed;
+        shapes[emitterCount][0] = emitter->direction[0];
+        shapes[emitterCount][1] = emitter->direction[1];
+        shapes[emitterCount][2] = emitter->direction[2];
+        shapes[emitterCount][3] = desc->spread;
+        looks[emitterCount][0] = desc->hue;
+        looks[emitterCount][1] = desc->hueSpread;
+        looks[emitterCount][2] = desc->size;
+        looks[emitterCount][3] = desc->lifetime;
+        
+        cursor = (cursor + count) % capacity;
+        highWater = highWater + count < capacity ? highWater + count : capacity;
+        if (quietIn < desc->lifetime) {
+            quietIn = desc->lifetime;
+        }
+        budget -= count;
+        stats.spawned += count;
+        emitterCount++;
+    }
+    
+    // Emitters that missed this pass move to the front for the next one
+    queueCount -= emitterCount;
+    memmove(queue, queue + emitterCount, (size_t)queueCount * sizeof(PendingEmitter));
+    stats.emitters = emitterCount;
+    stats.pendingEmitters = queueCount;
+    stats.simulated = highWater;
+    
+    shader_use(&updateShader);
+    shader_uniform_float(&updateShader, updateUniforms.deltaTime, deltaTime);
+    shader_uniform_float(&updateShader, updateUniforms.gravity, PARTICLE_GRAVITY);
+    shader_uniform_float(&updateShader, updateUniforms.drag, PARTICLE_DRAG);
+    shader_uniform_float(&updateShader, updateUniforms.groundLevel, GROUND_LEVEL);
+    shader_uniform_int(&updateShader, updateUniforms.capacity, capacity);
+    shader_uniform_int(&updateShader, updateUniforms.seed, (int)(passSeed++));
+    shader_uniform_int(&updateShader, updateUniforms.emitterCount, emitterCount);
+    shader_uniform_ivec2v(&updateShader, updateUniforms.emitterRange, emitterCount, &ranges[0][0]);
+    shader_uniform_vec4v(&updateShader, updateUniforms.emitterOrigin, emitterCount, &origins[0][0]);
+    shader_uniform_vec4v(&updateShader, updateUniforms.emitterShape, emitterCount, &shapes[0][0]);
+    shader_uniform_vec4v(&updateShader, updateUniforms.emitterLook, emitterCount, &looks[0][0]);
+    
+    // Vertex shader only: every particle goes from one buffer to the other
+    gl_state_set_enabled(GL_RASTERIZER_DISCARD, true);
+    gl_state_bind_vertex_array(vaos[source]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers[1 - source]);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, highWater);
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    gl_state_set_enabled(GL_RASTERIZER_DISCARD, false);
+    
+    source = 1 - source;
+}
+
+// Render queue callback: the queue has bound the program, the current
+// particle buffer's vertex array and additive blending
+static void draw_particles_item(void* data) {
+    (void)data;
+    shader_uniform_float(&renderShader, viewportHeightUniform, drawViewportHeight);
+    
+    // Glows add up in any order, so they test depth but don't write it
+    gl_state_set_enabled(GL_PROGRAM_POINT_SIZE, true);
+    gl_state_depth_mask(false);
+    glDrawArrays(GL_POINTS, 0, highWater);
+    gl_state_depth_mask(true);
+}
+
+// Queue the particles as one additive draw
+void particles_render(const vec3 eye, float viewportHeight) {
+    if (capacity == 0 || highWater == 0) {
+        return;
+    }
+    
+    drawViewportHeight = viewportHeight;
+    RenderItem item = {
+        RENDER_LAYER_TRANSPARENT,
+        RENDER_BLEND_ADDITIVE,
+        &renderShader,
+        0,
+        SAMPLER_NONE,
+        vaos[source],
+        {eye[0], eye[1], eye[2]},
+        draw_particles_item,
+        NULL
+    };
+    renderer_submit(&item);
+}
+
+// Counters for the last update
+ParticleStats particles_get_stats(void) {
+    return stats;
+}
+
+// Release the buffers and shaders
+void particles_cleanup(void) {
+    if (vaos[0] != 0) {
+        gl_state_delete_vertex_arrays(2, vaos);
+        vaos[0] = vaos[1] = 0;
+    }
+    if (buffers[0] != 0) {
+        glDeleteBuffers(2, buffers);
+        buffers[0] = buffers[1] = 0;
+    }
+    shader_cleanup(&updateShader);
+    shader_cleanup(&renderShader);
+    capacity = 0;
+    highWater = 0;
+    queueCount = 0;
+}
@@ -0,0 +1,38 @@
+#include "physics.h"
+
+// Place a grounded body at rest
+void physics_body_init(PhysicsBody* body, float x, float y, float z) {
+    body->x = x;
+    body->y = y;
+    body->z = z;
+    body->velocityY = 0.0f;
+    body->isGrounded = true;
+}
+
+// Start a jump if grounded, otherwise apply gravity and land on the ground
+bool physics_update_jump(PhysicsBody* body, bool jumpPressed) {
+    if (body->isGrounded) {
+        if (jumpPressed) {
+            body->velocityY = PHYSICS_JUMP_FORCE;
+            body->isGrounded = false;
+            return true;
+        }
+        return false;
+    }
+    
+    // Apply gravity and update vertical position
+    body->velocityY -= PHYSICS_GRAVITY;
+    float newY = body->y + body->velocityY;
+    
+    // Check if landed
+    if (newY <= GROUND_LEVEL) {
+        body->y = GROUND_LEVEL;
+        body->velocityY = 0.0f;
+        body->isGrounded = true;
+        return false;
+    }
+    
+    // Only update if we haven't landed
+    body->y = newY;
+    return true;
+}
@@ -0,0 +1,173 @@
+#include "profiler.h"
+#include "timer.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+#ifdef _MSC_VER
+#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define PROFILER_THREAD_LOCAL _Thread_local
+#endif
+
+// When a ring has wrapped, skip this many of its oldest zones while
+// dumping; the owning thread may be overwriting them right now
+#define PROFILER_DUMP_SLACK 1024
+
+// One closed zone
+typedef struct {
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs;
+} ProfileEvent;
+
+// Everything one thread records. Only the owner writes; the dump reads
+// events older than the published write count.
+typedef struct {
+    ProfileEvent events[PROFILER_RING_SIZE];
+    atomic_ullong written;                        // Zones closed so far
+    const char* openNames[PROFILER_MAX_DEPTH];
+    uint64_t openStartNs[PROFILER_MAX_DEPTH];
+    int depth;                                    // Open zones, may exceed PROFILER_MAX_DEPTH
+    int threadId;
+    char threadName[32];
+} ProfileThread;
+
+static ProfileThread* profileThreads[PROFILER_MAX_THREADS];
+static atomic_int profileThreadCount = 0;
+
+static PROFILER_THREAD_LOCAL ProfileThread* currentThread = NULL;
+static PROFILER_THREAD_LOCAL bool currentThreadFailed = false;
+
+// Buffer of the calling thread, registered on first use
+static ProfileThread* get_thread(void) {
+    if (currentThread || currentThreadFailed) {
+        return currentThread;
+    }
+    
+    int index = atomic_fetch_add(&profileThreadCount, 1);
+    if (index >= PROFILER_MAX_THREADS) {
+        atomic_fetch_sub(&profileThreadCount, 1);
+        currentThreadFailed = true;
+        return NULL;
+    }
+    
+    ProfileThread* thread = (ProfileThread*)calloc(1, sizeof(ProfileThread));
+    if (!thread) {
+        // Leave the slot empty; the dump skips it
+        currentThreadFailed = true;
+        return NULL;
+    }
+    
+    thread->threadId = index;
+    snprintf(thread->threadName, sizeof(thread->threadName), "thread %d", index);
+    profileThreads[index] = thread;
+    currentThread = thread;
+    return thread;
+}
+
+// Open a zone on the calling thread
+void profiler_begin(const char* name) {
+    ProfileThread* thread = get_thread();
+    if (!thread) {
+        return;
+    }
+    
+    if (thread->depth < PROFILER_MAX_DEPTH) {
+        thread->openNames[thread->depth] = name;
+        thread->openStartNs[thread->depth] = timer_now_ns();
+    }
+    thread->depth++;
+}
+
+// Close the innermost open zone on the calling thread
+void profiler_end(void) {
+    ProfileThread* thread = currentThread;
+    if (!thread || thread->depth == 0) {
+        return;
+    }
+    
+    thread->depth--;
+    if (thread->depth >= PROFILER_MAX_DEPTH) {
+        return;
+    }
+    
+    unsigned long long index = atomic_load_explicit(&thread->written, memory_order_relaxed);
+    ProfileEvent* event = &thread->events[index & (PROFILER_RING_SIZE - 1)];
+    event->name = thread->openNames[thread->depth];
+    event->startNs = thread->openStartNs[thread->depth];
+    event->durationNs = timer_now_ns() - event->startNs;
+    atomic_store_explicit(&thread->written, index + 1, memory_order_release);
+}
+
+// Label the calling thread in the trace
+void profiler_set_thread_name(const char* name) {
+    ProfileThread* thread = get_thread();
+    if (thread) {
+        snprintf(thread->threadName, sizeof(thread->threadName), "%s", name);
+    }
+}
+
+// Write every thread's recorded zones to path as Chrome trace JSON
+bool profiler_write_trace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        LOG("Failed to open trace file %s", path);
+        return false;
+    }
+    
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    unsigned long long total = 0;
+    
+    int threadCount = atomic_load(&profileThreadCount);
+    for (int t = 0; t < threadCount; t++) {
+        ProfileThread* thread = profileThreads[t];
+        if (!thread) {
+            continue;
+        }
+        
+        fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", thread->threadId, thread->threadName);
+        first = false;
+        
+        unsigned long long written = atomic_load_explicit(&thread->written, memory_order_acquire);
+        unsigned long long begin = 0;
+        if (written > PROFILER_RING_SIZE) {
+            begin = written - PROFILER_RING_SIZE + PROFILER_DUMP_SLACK;
+        }
+        
+        for (unsigned long long i = begin; i < written; i++) {
+            const ProfileEvent* event = &thread->events[i & (PROFILER_RING_SIZE - 1)];
+            
+            // Timestamps and durations are in microseconds
+            fprintf(file, ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    event->name, thread->threadId,
+                    (double)event->startNs / 1000.0, (double)event->durationNs / 1000.0);
+        }
+        total += written - begin;
+    }
+    
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    
+    LOG("Wrote %llu zones from %d threads to %s", total, threadCount, path);
+    return true;
+}
+
+// Free all thread buffers
+void profiler_shutdown(void) {
+    int threadCount = atomic_load(&profileThreadCount);
+    for (int t = 0; t < threadCount; t++) {
+        free(profileThreads[t]);
+        profileThreads[t] = NULL;
+    }
+    atomic_store(&profileThreadCount, 0);
+    currentThread = NULL;
+}
@@ -1,6 +1,6 @@
-#include "pch.h"
 #include "projectile.h"
-#include "texture.h"
+#include "job_system.h"
+#include "profiler.h"
 #include <stdio.h>
 #include <math.h>
 #include "logging.h"
@@ -8,18 +8,18 @@
 // Define this module for logging
 LOG_MODULE_DEFINE(__FILE__, false);
 
-// Function declarations
-void create_projectile_model(void);
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
 
 // Projectile array
 static Projectile projectiles[MAX_PROJECTILES];
 
-// Projectile texture
-static unsigned int daggerTextureID = 0;
+// Projectiles per integration job
+#define PROJECTILE_UPDATE_GRAIN 8
 
-// Projectile rendering data
-static unsigned int projectileVAO = 0;
-static unsigned int projectileVBO = 0;
+// Tick length used by the integration jobs of the current tick
+static float projectileDeltaTime = 0.0f;
 
 // Add these variables at the top of the file
 static bool orbitMode = false;
@@ -27,22 +27,15 @@ static float orbitRadius = 1.2f;
 static float orbitSpeed = 5.0f;
 static float orbitAngle = 0.0f;
 
-// Initialize the projectile system
+// Initialize the projectile system (simulation state only; see projectile_render.c)
 void projectile_system_init(void) {
     // Initialize all projectiles as inactive
     for (int i = 0; i < MAX_PROJECTILES; i++) {
         projectiles[i].active = false;
     }
     
-    // Load the dagger texture
-    daggerTextureID = texture_load_png("assets/Terrible Knight/Projectiles/dagger.png");
-    
-    if (daggerTextureID == 0) {
-        LOG("Failed to load dagger texture!");
-    }
-    
-    // Create a 3D model for the projectile
-    create_projectile_model();
+    orbitMode = false;
+    orbitAngle = 0.0f;
 }
 
 // Spawn a new projectile
@@ -68,11 +61,14 @@ void spawn_projectile(float x, float y, float z, float dirX, float dirZ, float s
                     projectiles[j].velocityX = 0.0f;
                     projectiles[j].velocityZ = 0.0f;
                     projectiles[j].rotation = angle;
+                    projectiles[j].prevX = projectiles[j].x;
+                    projectiles[j].prevY = projectiles[j].y;
+                    projectiles[j].prevZ = projectiles[j].z;
+                    projectiles[j].prevRotation = angle;
                     projectiles[j].scale = 0.3f;  // Increased from 0.25f to 0.3f for better visibility
                     projectiles[j].lifetime = lifetime;
                     projectiles[j].maxLifetime = lifetime;
                     projectiles[j].active = true;
-                    projectiles[j].textureID = daggerTextureID;
                     projectiles[j].orbitAngle = angle;
                     projectiles[j].orbitMode = true;
                     projectiles[j].orbitCenterX = x;
@@ -95,11 +91,14 @@ void spawn_projectile(float x, float y, float z, float dirX, float dirZ, float s
                 projectiles[i].velocityX = dirX * speed;
                 projectiles[i].velocityZ = dirZ * speed;
                 projectiles[i].rotation = atan2f(dirZ, dirX);
+                projectiles[i].prevX = x;
+                projectiles[i].prevY = y;
+                projectiles[i].prevZ = z;
+                projectiles[i].prevRotation = projectiles[i].rotation;
                 projectiles[i].scale = 0.3f;
                 projectiles[i].lifetime = lifetime;
                 projectiles[i].maxLifetime = lifetime;
                 projectiles[i].active = true;
-                projectiles[i].textureID = daggerTextureID;
                 projectiles[i].orbitMode = false;
                 projectiles[i].radius = 0.2f; // Set hitbox radius for regular projectiles
                 
@@ -109,16 +108,19 @@ void spawn_projectile(float x, float y, float z, float dirX, float dirZ, float s
     }
 }
 
-// Update all projectiles
-void update_projectiles(float deltaTime) {
-    // Update global orbit angle
-    orbitAngle += orbitSpeed * deltaTime;
-    if (orbitAngle > 2.0f * M_PI) {
-        orbitAngle -= 2.0f * M_PI;
-    }
+// Job: integrate one chunk of projectile slots
+static void update_projectile_range(void* data, int begin, int end) {
+    (void)data;
+    float deltaTime = projectileDeltaTime;
     
-    for (int i = 0; i < MAX_PROJECTILES; i++) {
+    PROFILE_SCOPE("projectiles.update") for (int i = begin; i < end; i++) {
         if (projectiles[i].active) {
+            // Keep the pre-step transform for render interpolation
+            projectiles[i].prevX = projectiles[i].x;
+            projectiles[i].prevY = projectiles[i].y;
+            projectiles[i].prevZ = projectiles[i].z;
+            projectiles[i].prevRotation = projectiles[i].rotation;
+            
             if (projectiles[i].orbitMode) {
                 // Update orbit position
                 projectiles[i].orbitAngle += orbitSpeed * deltaTime;
@@ -149,111 +151,31 @@ void update_projectiles(float deltaTime) {
     }
 }
 
-// Render all projectiles
-void render_projectiles(Shader* shader) {
-    if (projectileVAO == 0) {
-        LOG("Error: Projectile system not initialized!");
-        return;
-    }
-    
-    // Bind the VAO
-    glBindVertexArray(projectileVAO);
-    
-    // Enable texture and set parameters
-    shader_set_bool(shader, "useTexture", true);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    
-    // Render each active projectile
-    for (int i = 0; i < MAX_PROJECTILES; i++) {
-        if (projectiles[i].active) {
-            // Create model matrix
-            mat4 model = GLM_MAT4_IDENTITY_INIT;
-            
-            // Translate to position
-            glm_translate(model, (vec3){projectiles[i].x, projectiles[i].y, projectiles[i].z});
-            
-            // Rotate based on projectile type
-            if (projectiles[i].orbitMode) {
-                // For orbit mode, rotate based on orbit angle
-                glm_rotate(model, projectiles[i].rotation, (vec3){0.0f, 1.0f, 0.0f});
-            } else {
-                // Calculate rotation from velocity
-                float angle = atan2f(projectiles[i].velocityZ, projectiles[i].velocityX);
-                glm_rotate(model, angle, (vec3){0.0f, 1.0f, 0.0f});
-            }
-            
-            // Scale
-            glm_scale(model, (vec3){projectiles[i].scale, projectiles[i].scale, projectiles[i].scale});
-            
-            // Set model matrix
-            shader_set_mat4(shader, "model", model);
-            
-            // Set color (white for normal rendering)
-            vec3 color = {1.0f, 1.0f, 1.0f};
-            shader_set_vec3(shader, "objectColor", color);
-            
-            // Bind texture
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, projectiles[i].textureID);
-            
-            // Draw the projectile (simple quad)
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-        }
+// Start updating all projectiles as jobs; finished when counter reaches zero
+void update_projectiles_async(float deltaTime, JobCounter* counter) {
+    // Update global orbit angle
+    orbitAngle += orbitSpeed * deltaTime;
+    if (orbitAngle > 2.0f * M_PI) {
+        orbitAngle -= 2.0f * M_PI;
     }
     
-    // Unbind VAO
-    glBindVertexArray(0);
+    projectileDeltaTime = deltaTime;
+    job_parallel_for(counter, NULL, MAX_PROJECTILES, PROJECTILE_UPDATE_GRAIN, update_projectile_range, NULL);
 }
 
-// Clean up projectile resources
-void projectile_system_cleanup(void) {
-    if (projectileVAO != 0) {
-        glDeleteVertexArrays(1, &projectileVAO);
-        projectileVAO = 0;
-    }
-    
-    if (projectileVBO != 0) {
-        glDeleteBuffers(1, &projectileVBO);
-        projectileVBO = 0;
-    }
+// Update all projectiles
+void update_projectiles(float deltaTime) {
+    JobCounter done;
+    job_counter_init(&done);
+    update_projectiles_async(deltaTime, &done);
+    job_wait(&done);
 }
 
-// Simplify the create_projectile_model function to just create a simple quad
-void create_projectile_model(void) {
-    // Create a simple quad for the projectile
-    float vertices[] = {
-        // Position (XYZ), TexCoord (UV)
-        -0.5f, -0.5f, 0.0f,  0.0f, 0.0f,
-         0.5f, -0.5f, 0.0f,  1.0f, 0.0f,
-         0.5f,  0.5f, 0.0f,  1.0f, 1.0f,
-         0.5f,  0.5f, 0.0f,  1.0f, 1.0f,
-        -0.5f,  0.5f, 0.0f,  0.0f, 1.0f,
-        -0.5f, -0.5f, 0.0f,  0.0f, 0.0f
-    };
-    
-    // Create VAO and VBO
-    glGenVertexArrays(1, &projectileVAO);
-    glGenBuffers(1, &projectileVBO);
-    
-    glBindVertexArray(projectileVAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, projectileVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Texture coord attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+// Clean up projectile state
+void projectile_system_cleanup(void) {
+    for (int i = 0; i < MAX_PROJECTILES; i++) {
+        projectiles[i].active = false;
+    }
 }
 
 // Function to set orbit mode
@@ -305,4 +227,9 @@ void handle_projectile_collision(int projectileIndex) {
     
     // You could add visual effects here, like a small flash or particle effect
     LOG("Projectile %d hit something!", projectileIndex);
-} 
\ No newline at end of file
+}
+
+// Read-only access to the projectile slots
+const Projectile* get_projectiles(void) {
+    return projectiles;
+}
@@ -0,0 +1,88 @@
+#include "pch.h"
+#include "projectile_render.h"
+#include "projectile.h"
+#include "texture.h"
+#include "renderer.h"
+#include "culling.h"
+#include "gl_state.h"
+#include <stdio.h>
+#include <math.h>
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Projectile texture
+static unsigned int daggerTextureID = 0;
+
+// Bounding sphere radius of the unit quad per unit of scale (half its diagonal)
+#define PROJECTILE_CULL_RADIUS 0.70710678f
+
+// The dagger texture is stored upside down relative to the sprite sheets
+static const vec4 daggerUV = {0.0f, 1.0f, 1.0f, 0.0f};
+
+// Load the dagger texture
+void projectile_render_init(void) {
+    // Decoded in the background; the name draws nothing until the image arrives
+    daggerTextureID = texture_acquire_async("assets/Terrible Knight/Projectiles/dagger.png");
+    
+    if (daggerTextureID == 0) {
+        LOG("Failed to load dagger texture!");
+        return;
+    }
+}
+
+// Queue the projectiles inside the camera frustum
+void render_projectiles(Shader* shader, float alpha) {
+    if (daggerTextureID == 0) {
+        return;
+    }
+    
+    // Render each active projectile
+    const Projectile* projectiles = get_projectiles();
+    for (int i = 0; i < MAX_PROJECTILES; i++) {
+        if (projectiles[i].active) {
+            // Create model matrix
+            mat4 model = GLM_MAT4_IDENTITY_INIT;
+            
+            // Translate to the position interpolated between the last two ticks
+            const Projectile* projectile = &projectiles[i];
+            vec3 position = {
+                projectile->prevX + (projectile->x - projectile->prevX) * alpha,
+                projectile->prevY + (projectile->y - projectile->prevY) * alpha,
+                projectile->prevZ + (projectile->z - projectile->prevZ) * alpha
+            };
+            // Skip daggers outside the camera frustum
+            if (!culling_sphere_visible(position, projectile->scale * PROJECTILE_CULL_RADIUS)) {
+                continue;
+            }
+            glm_translate(model, position);
+            
+            // Rotate based on projectile type
+            if (projectiles[i].orbitMode) {
+                // For orbit mode, rotate based on orbit angle
+                float rotation = projectile->prevRotation +
+                                 (projectile->rotation - projectile->prevRotation) * alpha;
+                glm_rotate(model, rotation, (vec3){0.0f, 1.0f, 0.0f});
+            } else {
+                // Calculate rotation from velocity
+                float angle = atan2f(projectiles[i].velocityZ, projectiles[i].velocityX);
+                glm_rotate(model, angle, (vec3){0.0f, 1.0f, 0.0f});
+            }
+            
+            // Scale
+            glm_scale(model, (vec3){projectiles[i].scale, projectiles[i].scale, projectiles[i].scale});
+            
+            // Queue the quad; every dagger lands in the same batch
+            renderer_submit_quad(shader, daggerTextureID, SAMPLER_PIXEL_ART, model, daggerUV, NULL);
+        }
+    }
+}
+
+// Release the dagger texture
+void projectile_render_cleanup(void) {
+    if (daggerTextureID != 0) {
+        texture_release(daggerTextureID);
+        daggerTextureID = 0;
+    }
+}
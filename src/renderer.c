@@ -0,0 +1,511 @@
+#include "renderer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "gl_state.h"
+#include "profiler.h"
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Sort key layout, most significant first:
+//   layer (2) | 40 bits ordered per layer | blend (2) | item index (20)
+// Opaque items order the 40 bits as shader (8) | texture (12) | depth (20),
+// so state changes are rare and nearer items draw first; transparent items
+// as inverted depth (20) | shader (8) | texture (12), back to front with
+// equal-depth runs still grouped by state. Overlays leave the state and
+// blend bits zero and draw in submission order. The item index makes every key unique and finds the
+// item again after sorting.
+#define RENDERER_KEY_LAYER_SHIFT 62
+#define RENDERER_KEY_STATE_SHIFT 22
+#define RENDERER_KEY_BLEND_SHIFT 20
+#define RENDERER_KEY_INDEX_MASK 0xFFFFFu
+#define RENDERER_KEY_SHADER_BITS 8
+#define RENDERER_KEY_TEXTURE_BITS 12
+#define RENDERER_KEY_DEPTH_BITS 20
+
+// Radix digit width and the number of passes over a 64-bit key
+#define RENDERER_RADIX_BITS 8
+#define RENDERER_RADIX_PASSES (64 / RENDERER_RADIX_BITS)
+
+// A queued item; quads carry their vertices, already in world space
+typedef struct {
+    RenderItem item;
+    int quad;                 // Index into quads, or -1 for a callback item
+} RendererCommand;
+
+static unsigned int batchVAO = 0;
+static unsigned int batchVBO = 0;
+static unsigned int quadEBO = 0;
+
+// Items and quads submitted since the last flush. The arrays only grow, so
+// a frame of any size sorts as one queue.
+static RendererCommand* commands = NULL;
+static uint64_t* commandKeys = NULL;
+static uint64_t* sortScratch = NULL;
+static int commandCount = 0;
+static int commandCapacity = 0;
+static RendererVertex (*quads)[4] = NULL;
+static int quadCount = 0;
+static int quadCapacity = 0;
+
+// Vertex staging copy in sorted order, and where each command's quad landed in it
+static RendererVertex* staging = NULL;
+static int* stagingSlots = NULL;
+
+// Camera of the frame being collected
+static mat4 frameView = GLM_MAT4_IDENTITY_INIT;
+
+static RendererStats frameStats;
+static RendererStats lastStats;
+
+// Unit quad corners, counter-clockwise from bottom left
+static const float quadCorners[4][2] = {
+    {-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}
+};
+
+// Grow the per-item arrays to hold capacity items
+static bool reserve_commands(int capacity) {
+    RendererCommand* grownCommands = (RendererCommand*)realloc(commands, (size_t)capacity * sizeof(RendererCommand));
+    if (!grownCommands) {
+        return false;
+    }
+    commands = grownCommands;
+    
+    uint64_t* grownKeys = (uint64_t*)realloc(commandKeys, (size_t)capacity * sizeof(uint64_t));
+    if (!grownKeys) {
+        return false;
+    }
+    commandKeys = grownKeys;
+    
+    uint64_t* grownScratch = (uint64_t*)realloc(sortScratch, (size_t)capacity * sizeof(uint64_t));
+    if (!grownScratch) {
+        return false;
+    }
+    sortScratch = grownScratch;
+    
+    int* grownSlots = (int*)realloc(stagingSlots, (size_t)capacity * sizeof(int));
+    if (!grownSlots) {
+        return false;
+    }
+    stagingSlots = grownSlots;
+    
+    commandCapacity = capacity;
+    return true;
+}
+
+// Grow the quad vertex arrays to hold capacity quads
+static bool reserve_quads(int capacity) {
+    RendererVertex (*grownQuads)[4] = (RendererVertex(*)[4])realloc(quads, (size_t)capacity * sizeof(*quads));
+    if (!grownQuads) {
+        return false;
+    }
+    quads = grownQuads;
+    
+    RendererVertex* grownStaging = (RendererVertex*)realloc(staging, (size_t)capacity * 4 * sizeof(RendererVertex));
+    if (!grownStaging) {
+        return false;
+    }
+    staging = grownStaging;
+    
+    quadCapacity = capacity;
+    return true;
+}
+
+// Create the streamed vertex buffer and the shared quad index buffer
+void renderer_init(void) {
+    reserve_commands(RENDERER_INITIAL_ITEMS);
+    reserve_quads(RENDERER_MAX_QUADS);
+    commandCount = 0;
+    quadCount = 0;
+    
+    // Every quad uses the same 6 indices offset by 4 vertices, so they are built once
+    unsigned short* indices = (unsigned short*)malloc(RENDERER_MAX_QUADS * 6 * sizeof(unsigned short));
+    for (int i = 0; i < RENDERER_MAX_QUADS; i++) {
+        unsigned short base = (unsigned short)(i * 4);
+        indices[i * 6 + 0] = base + 0;
+        indices[i * 6 + 1] = base + 1;
+        indices[i * 6 + 2] = base + 2;
+        indices[i * 6 + 3] = base + 2;
+        indices[i * 6 + 4] = base + 3;
+        indices[i * 6 + 5] = base + 0;
+    }
+    
+    glGenVertexArrays(1, &batchVAO);
+    glGenBuffers(1, &batchVBO);
+    glGenBuffers(1, &quadEBO);
+    
+    gl_state_bind_vertex_array(batchVAO);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, batchVBO);
+    glBufferData(GL_ARRAY_BUFFER, RENDERER_MAX_QUADS * 4 * sizeof(RendererVertex), NULL, GL_STREAM_DRAW);
+    
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, RENDERER_MAX_QUADS * 6 * sizeof(unsigned short), indices, GL_STATIC_DRAW);
+    
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RendererVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    
+    // Texture coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(RendererVertex), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    
+    // Color attribute
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(RendererVertex), (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    
+    // Unbind (the element buffer stays attached to the VAO)
+    gl_state_bind_vertex_array(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    
+    free(indices);
+}
+
+// Start collecting draws for a new frame
+void renderer_begin(mat4 view) {
+    commandCount = 0;
+    quadCount = 0;
+    glm_mat4_copy(view, frameView);
+    frameStats = (RendererStats){0};
+    gl_state_reset_stats();
+}
+
+// Distance of a world-space point in front of this frame's camera
+float renderer_view_depth(const vec3 position) {
+    vec4 world = {position[0], position[1], position[2], 1.0f};
+    vec4 eye;
+    glm_mat4_mulv(frameView, world, eye);
+    return -eye[2];
+}
+
+// Quantized view distance of a world-space point, 0 nearest
+static uint64_t depth_bits(const vec3 position) {
+    float distance = renderer_view_depth(position) / RENDERER_MAX_DEPTH;
+    distance = distance < 0.0f ? 0.0f : (distance > 1.0f ? 1.0f : distance);
+    return (uint64_t)(distance * (float)((1u << RENDERER_KEY_DEPTH_BITS) - 1));
+}
+
+// Build the sort key of command index
+static uint64_t make_key(const RenderItem* item, int index) {
+    uint64_t shader = (uint64_t)(item->shader->ID & ((1u << RENDERER_KEY_SHADER_BITS) - 1));
+    uint64_t texture = (uint64_t)(item->textureID & ((1u << RENDERER_KEY_TEXTURE_BITS) - 1));
+    uint64_t state = 0;
+    uint64_t blend = (uint64_t)item->blend;
+    
+    switch (item->layer) {
+        case RENDER_LAYER_OPAQUE:
+            state = (shader << (RENDERER_KEY_TEXTURE_BITS + RENDERER_KEY_DEPTH_BITS)) |
+                    (texture << RENDERER_KEY_DEPTH_BITS) |
+                    depth_bits(item->position);
+            break;
+        case RENDER_LAYER_TRANSPARENT: {
+            uint64_t farFirst = ((1u << RENDERER_KEY_DEPTH_BITS) - 1) - depth_bits(item->position);
+            state = (farFirst << (RENDERER_KEY_SHADER_BITS + RENDERER_KEY_TEXTURE_BITS)) |
+                    (shader << RENDERER_KEY_TEXTURE_BITS) |
+                    texture;
+            break;
+        }
+        default:
+            // Overlays: only the index orders them, whatever their blend
+            blend = 0;
+            break;
+    }
+    
+    return ((uint64_t)item->layer << RENDERER_KEY_LAYER_SHIFT) |
+           (state << RENDERER_KEY_STATE_SHIFT) |
+           (blend << RENDERER_KEY_BLEND_SHIFT) |
+           (uint64_t)index;
+}
+
+// Queue a command, growing the frame's arrays when they are full. Returns
+// NULL (and drops the item) only past RENDERER_MAX_ITEMS or out of memory.
+static RendererCommand* push_command(const RenderItem* item, bool isQuad) {
+    if (commandCount == commandCapacity) {
+        if (commandCapacity == RENDERER_MAX_ITEMS) {
+            LOG("Render queue holds %d items, dropping the rest of the frame", RENDERER_MAX_ITEMS);
+            return NULL;
+        }
+        int capacity = commandCapacity * 2 > RENDERER_MAX_ITEMS ? RENDERER_MAX_ITEMS : commandCapacity * 2;
+        if (!reserve_commands(capacity)) {
+            LOG("Failed to grow the render queue to %d items", capacity);
+            return NULL;
+        }
+    }
+    
+    if (isQuad && quadCount == quadCapacity && !reserve_quads(quadCapacity * 2)) {
+        LOG("Failed to grow the render queue to %d quads", quadCapacity * 2);
+        return NULL;
+    }
+    
+    RendererCommand* command = &commands[commandCount];
+    command->item = *item;
+    command->quad = isQuad ? quadCount++ : -1;
+    commandKeys[commandCount] = make_key(item, commandCount);
+    commandCount++;
+    return command;
+}
+
+// Queue a draw item
+void renderer_submit(const RenderItem* item) {
+    push_command(item, false);
+}
+
+// Queue a unit quad transformed by model
+void renderer_submit_quad(Shader* shader, unsigned int textureID, SamplerKind sampler, mat4 model,
+                          const vec4 uvRect, const vec4 color) {
+    RenderItem item = {
+        RENDER_LAYER_TRANSPARENT,
+        RENDER_BLEND_PREMULTIPLIED,
+        shader,
+        textureID,
+        sampler,
+        batchVAO,
+        {model[3][0], model[3][1], model[3][2]},
+        NULL,
+        NULL
+    };
+    RendererCommand* command = push_command(&item, true);
+    if (!command) {
+        return;
+    }
+    RendererVertex* vertices = quads[command->quad];
+    
+    float u0 = uvRect ? uvRect[0] : 0.0f;
+    float v0 = uvRect ? uvRect[1] : 0.0f;
+    float u1 = uvRect ? uvRect[2] : 1.0f;
+    float v1 = uvRect ? uvRect[3] : 1.0f;
+    const float uvs[4][2] = {{u0, v1}, {u1, v1}, {u1, v0}, {u0, v0}};
+    
+    unsigned char rgba[4] = {255, 255, 255, 255};
+    if (color) {
+        for (int c = 0; c < 4; c++) {
+            float value = color[c] < 0.0f ? 0.0f : (color[c] > 1.0f ? 1.0f : color[c]);
+            rgba[c] = (unsigned char)(value * 255.0f + 0.5f);
+        }
+    }
+    
+    // Transform on the CPU so quads with different models share one draw
+    for (int i = 0; i < 4; i++) {
+        vec4 corner = {quadCorners[i][0], quadCorners[i][1], 0.0f, 1.0f};
+        vec4 world;
+        glm_mat4_mulv(model, corner, world);
+        
+        RendererVertex* vertex = &vertices[i];
+        vertex->x = world[0];
+        vertex->y = world[1];
+        vertex->z = world[2];
+        vertex->u = uvs[i][0];
+        vertex->v = uvs[i][1];
+        vertex->color[0] = rgba[0];
+        vertex->color[1] = rgba[1];
+        vertex->color[2] = rgba[2];
+        vertex->color[3] = rgba[3];
+    }
+}
+
+// Sort keys ascending, least significant byte first
+void renderer_sort_keys(uint64_t* keys, uint64_t* scratch, int count) {
+    uint64_t* source = keys;
+    uint64_t* destination = scratch;
+    
+    for (int pass = 0; pass < RENDERER_RADIX_PASSES; pass++) {
+        int shift = pass * RENDERER_RADIX_BITS;
+        int offsets[1 << RENDERER_RADIX_BITS] = {0};
+        
+        for (int i = 0; i < count; i++) {
+            offsets[(source[i] >> shift) & ((1 << RENDERER_RADIX_BITS) - 1)]++;
+        }
+        
+        // A digit every key shares leaves the order as it is
+        if (count > 0 && offsets[(source[0] >> shift) & ((1 << RENDERER_RADIX_BITS) - 1)] == count) {
+            continue;
+        }
+        
+        int total = 0;
+        for (int digit = 0; digit < (1 << RENDERER_RADIX_BITS); digit++) {
+            int digitCount = offsets[digit];
+            offsets[digit] = total;
+            total += digitCount;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            destination[offsets[(source[i] >> shift) & ((1 << RENDERER_RADIX_BITS) - 1)]++] = source[i];
+        }
+        
+        uint64_t* swap = source;
+        source = destination;
+        destination = swap;
+    }
+    
+    if (source != keys) {
+        memcpy(keys, source, (size_t)count * sizeof(uint64_t));
+    }
+}
+
+// Switch blending to mode
+static void apply_blend(RenderBlend blend) {
+    gl_state_set_enabled(GL_BLEND, blend != RENDER_BLEND_OPAQUE);
+    if (blend == RENDER_BLEND_PREMULTIPLIED) {
+        gl_state_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    } else if (blend == RENDER_BLEND_ADDITIVE) {
+        gl_state_blend_func(GL_ONE, GL_ONE);
+    }
+}
+
+// True if command can be drawn in the same call as the quad run starting at first
+static bool extends_quad_run(const RendererCommand* first, const RendererCommand* command) {
+    return command->quad >= 0 &&
+           command->item.shader == first->item.shader &&
+           command->item.textureID == first->item.textureID &&
+           command->item.sampler == first->item.sampler &&
+           command->item.blend == first->item.blend;
+}
+
+// Sort queued items by key and draw them
+void renderer_flush(void) {
+    if (commandCount == 0) {
+        lastStats = frameStats;
+        return;
+    }
+    
+    PROFILE_BEGIN("renderer.flush");
+    
+    renderer_sort_keys(commandKeys, sortScratch, commandCount);
+    
+    // Stage quads in draw order so each run is one contiguous range
+    int staged = 0;
+    for (int i = 0; i < commandCount; i++) {
+        const RendererCommand* command = &commands[commandKeys[i] & RENDERER_KEY_INDEX_MASK];
+        if (command->quad >= 0) {
+            memcpy(&staging[staged * 4], quads[command->quad], sizeof(quads[0]));
+            stagingSlots[i] = staged++;
+        }
+    }
+    
+    if (staged > 0) {
+        // Orphan the old storage so the driver doesn't stall on last frame's draws
+        glBindBuffer(GL_ARRAY_BUFFER, batchVBO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)quadCapacity * 4 * sizeof(RendererVertex), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)staged * 4 * sizeof(RendererVertex), staging);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    
+    // Quad vertices are already in world space
+    mat4 identity = GLM_MAT4_IDENTITY_INIT;
+    Shader* boundShader = NULL;
+    unsigned int boundTexture = 0;
+    bool textureBound = false;
+    
+    int runStart = 0;
+    while (runStart < commandCount) {
+        const RendererCommand* command = &commands[commandKeys[runStart] & RENDERER_KEY_INDEX_MASK];
+        const RenderItem* item = &command->item;
+        
+        int runEnd = runStart + 1;
+        if (command->quad >= 0) {
+            while (runEnd < commandCount &&
+                   extends_quad_run(command, &commands[commandKeys[runEnd] & RENDERER_KEY_INDEX_MASK])) {
+                runEnd++;
+            }
+        }
+        
+        apply_blend(item->blend);
+        
+        if (item->shader != boundShader) {
+            shader_use(item->shader);
+            boundShader = item->shader;
+            frameStats.shaderChanges++;
+        }
+        
+        if (item->textureID != 0) {
+            if (!textureBound || item->textureID != boundTexture) {
+                gl_state_bind_texture(0, item->textureID);
+                boundTexture = item->textureID;
+                textureBound = true;
+                frameStats.textureChanges++;
+            }
+            gl_state_bind_sampler(0, sampler_get(item->sampler));
+        }
+        
+        gl_state_bind_vertex_array(item->vao);
+        
+        if (command->quad >= 0) {
+            shader_set_mat4(item->shader, "model", identity);
+            shader_set_int(item->shader, "texture1", 0);
+            
+            // Staged quad k sits at vertices 4k..; the shared 16-bit indices
+            // reach RENDERER_MAX_QUADS quads past the base vertex
+            int first = stagingSlots[runStart];
+            int count = runEnd - runStart;
+            for (int done = 0; done < count; done += RENDERER_MAX_QUADS) {
+                int chunk = count - done < RENDERER_MAX_QUADS ? count - done : RENDERER_MAX_QUADS;
+                glDrawElementsBaseVertex(GL_TRIANGLES, chunk * 6, GL_UNSIGNED_SHORT, NULL, (first + done) * 4);
+                frameStats.drawCalls++;
+            }
+        } else {
+            item->draw(item->data);
+            frameStats.drawCalls++;
+        }
+        
+        runStart = runEnd;
+    }
+    
+    gl_state_bind_vertex_array(0);
+    
+    frameStats.itemCount += commandCount;
+    frameStats.quadCount += quadCount;
+    lastStats = frameStats;
+    commandCount = 0;
+    quadCount = 0;
+    
+    PROFILE_END();
+}
+
+// Counters for the most recent frame
+RendererStats renderer_get_stats(void) {
+    return lastStats;
+}
+
+// Index buffer holding RENDERER_MAX_QUADS quads as 16-bit indices
+unsigned int renderer_quad_index_buffer(void) {
+    return quadEBO;
+}
+
+// Release the buffers
+void renderer_cleanup(void) {
+    if (batchVAO != 0) {
+        gl_state_delete_vertex_arrays(1, &batchVAO);
+        batchVAO = 0;
+    }
+    
+    if (batchVBO != 0) {
+        glDeleteBuffers(1, &batchVBO);
+        batchVBO = 0;
+    }
+    
+    if (quadEBO != 0) {
+        glDeleteBuffers(1, &quadEBO);
+        quadEBO = 0;
+    }
+    
+    free(commands);
+    free(commandKeys);
+    free(sortScratch);
+    free(stagingSlots);
+    free(quads);
+    free(staging);
+    commands = NULL;
+    commandKeys = NULL;
+    sortScratch = NULL;
+    stagingSlots = NULL;
+    quads = NULL;
+    staging = NULL;
+    commandCount = 0;
+    commandCapacity = 0;
+    quadCount = 0;
+    quadCapacity = 0;
+}
@@ -0,0 +1,50 @@
+#include "sampler.h"
+#include "gl_state.h"
+
+static GLuint samplers[SAMPLER_COUNT];
+
+// Filtering and wrapping of each kind (SAMPLER_NONE is left empty)
+static const struct {
+    GLint minFilter;
+    GLint magFilter;
+    GLint wrap;
+} samplerParameters[SAMPLER_COUNT] = {
+    [SAMPLER_PIXEL_ART]           = {GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE},
+    [SAMPLER_PIXEL_ART_MIPMAPPED] = {GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE},
+    [SAMPLER_LINEAR_REPEAT]       = {GL_LINEAR, GL_LINEAR, GL_REPEAT},
+    [SAMPLER_LINEAR_CLAMP]        = {GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE},
+    [SAMPLER_MIPMAPPED]           = {GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT},
+};
+
+// Create the sampler objects
+void sampler_init(void) {
+    samplers[SAMPLER_NONE] = 0;
+    glGenSamplers(SAMPLER_COUNT - 1, &samplers[1]);
+    
+    for (int kind = 1; kind < SAMPLER_COUNT; kind++) {
+        GLuint sampler = samplers[kind];
+        glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, samplerParameters[kind].minFilter);
+        glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, samplerParameters[kind].magFilter);
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, samplerParameters[kind].wrap);
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, samplerParameters[kind].wrap);
+    }
+}
+
+// GL name of a sampler
+GLuint sampler_get(SamplerKind kind) {
+    return samplers[kind];
+}
+
+// Delete the sampler objects
+void sampler_cleanup(void) {
+    // A deleted sampler unbinds from every unit; make the shadow agree
+    for (int unit = 0; unit < GL_STATE_TEXTURE_UNITS; unit++) {
+        gl_state_bind_sampler(unit, 0);
+    }
+    if (samplers[1] != 0) {
+        glDeleteSamplers(SAMPLER_COUNT - 1, &samplers[1]);
+    }
+    for (int kind = 0; kind < SAMPLER_COUNT; kind++) {
+        samplers[kind] = 0;
+    }
+}
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "gl_state.h"
 
 // Read file content into a string
 char* read_file(const char* filename) {
@@ -29,64 +30,136 @@ char* read_file(const char* filename) {
     return buffer;
 }
 
-void shader_init(Shader* shader, const char* vertexPath, const char* fragmentPath) {
-    // Read vertex shader code
-    char* vertexCode = read_file(vertexPath);
-    if (!vertexCode) {
-        printf("Failed to read vertex shader file\n");
+// FNV-1a hash of a uniform name
+static unsigned int hash_uniform_name(const char* name) {
+    unsigned int hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Enumerate the program's active uniforms into the hashed table
+static void shader_cache_uniforms(Shader* shader) {
+    memset(shader->uniforms, 0, sizeof(shader->uniforms));
+    shader->uniformCount = 0;
+    
+    GLint activeCount = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(shader->ID, GL_ACTIVE_UNIFORMS, &activeCount);
+    glGetProgramiv(shader->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    if (activeCount == 0 || maxLength <= 0) {
         return;
     }
     
-    // Read fragment shader code
-    char* fragmentCode = read_file(fragmentPath);
-    if (!fragmentCode) {
-        free(vertexCode);
-        printf("Failed to read fragment shader file\n");
+    // Read full names so ones too long for the table are rejected, not truncated
+    char* name = (char*)malloc((size_t)maxLength);
+    if (!name) {
+        printf("Failed to allocate memory for uniform names\n");
         return;
     }
     
-    // Compile shaders
-    unsigned int vertex, fragment;
+    for (GLint i = 0; i < activeCount; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(shader->ID, (GLuint)i, maxLength, &length, &size, &type, name);
+        
+        // Uniform block members have no location of their own
+        GLint location = glGetUniformLocation(shader->ID, name);
+        if (location < 0) {
+            continue;
+        }
+        
+        // Arrays are reported as "name[0]"; look them up by the bare name
+        char* bracket = strchr(name, '[');
+        if (bracket) {
+            *bracket = '\0';
+        }
+        
+        // Truncated names could collide or shadow each other; such a
+        // uniform stays unset and shader_uniform reports it as missing
+        if (strlen(name) >= SHADER_UNIFORM_NAME_LENGTH) {
+            printf("WARNING::SHADER::UNIFORM_NAME_TOO_LONG skipping %s (limit %d characters)\n",
+                   name, SHADER_UNIFORM_NAME_LENGTH - 1);
+            continue;
+        }
+        
+        if (shader->uniformCount >= SHADER_UNIFORM_TABLE_SIZE - 1) {
+            printf("WARNING::SHADER::TOO_MANY_UNIFORMS skipping %s\n", name);
+            continue;
+        }
+        
+        unsigned int hash = hash_uniform_name(name);
+        int slot = (int)(hash & (SHADER_UNIFORM_TABLE_SIZE - 1));
+        while (shader->uniforms[slot].name[0] != '\0') {
+            slot = (slot + 1) & (SHADER_UNIFORM_TABLE_SIZE - 1);
+        }
+        
+        ShaderUniform* uniform = &shader->uniforms[slot];
+        snprintf(uniform->name, sizeof(uniform->name), "%s", name);
+        uniform->nameHash = hash;
+        uniform->location = location;
+        uniform->hasValue = false;
+        shader->uniformCount++;
+    }
+    
+    free(name);
+}
+
+// Compile one stage, printing the log (and the source, for vertex shaders) on failure
+static unsigned int compile_stage(GLenum type, const char* code) {
     int success;
     char infoLog[512];
     
-    // Vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, (const char**)&vertexCode, NULL);
-    glCompileShader(vertex);
+    unsigned int stage = glCreateShader(type);
+    glShaderSource(stage, 1, &code, NULL);
+    glCompileShader(stage);
     
     // Check for compilation errors
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(stage, GL_COMPILE_STATUS, &success);
     if (!success) {
-        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-        printf("ERROR::SHADER::VERTEX::COMPILATION_FAILED\n%s\n", infoLog);
-        
-        // Print the shader source for debugging
-        printf("Vertex Shader Source:\n");
-        int i = 0;
-        const char* src = vertexCode;
-        while (*src) {
-            printf("%3d: %c [%d]\n", i++, *src, (int)*src);
-            src++;
+        glGetShaderInfoLog(stage, 512, NULL, infoLog);
+        if (type == GL_VERTEX_SHADER) {
+            printf("ERROR::SHADER::VERTEX::COMPILATION_FAILED\n%s\n", infoLog);
+            
+            // Print the shader source for debugging
+            printf("Vertex Shader Source:\n");
+            int i = 0;
+            const char* src = code;
+            while (*src) {
+                printf("%3d: %c [%d]\n", i++, *src, (int)*src);
+                src++;
+            }
+        } else {
+            printf("ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n%s\n", infoLog);
         }
     }
+    return stage;
+}
+
+// Link the program from sources (fragmentCode may be NULL), capturing
+// varyings with transform feedback if varyingCount is non-zero
+static void shader_build(Shader* shader, const char* vertexCode, const char* fragmentCode,
+                         const char* const* varyings, int varyingCount) {
+    int success;
+    char infoLog[512];
     
-    // Fragment shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, (const char**)&fragmentCode, NULL);
-    glCompileShader(fragment);
-    
-    // Check for compilation errors
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-        printf("ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n%s\n", infoLog);
-    }
+    unsigned int vertex = compile_stage(GL_VERTEX_SHADER, vertexCode);
+    unsigned int fragment = fragmentCode ? compile_stage(GL_FRAGMENT_SHADER, fragmentCode) : 0;
     
     // Shader program
     shader->ID = glCreateProgram();
     glAttachShader(shader->ID, vertex);
-    glAttachShader(shader->ID, fragment);
+    if (fragment != 0) {
+        glAttachShader(shader->ID, fragment);
+    }
+    
+    // Captured outputs must be named before linking
+    if (varyingCount > 0) {
+        glTransformFeedbackVaryings(shader->ID, varyingCount, varyings, GL_INTERLEAVED_ATTRIBS);
+    }
     glLinkProgram(shader->ID);
     
     // Check for linking errors
@@ -98,35 +171,163 @@ void shader_init(Shader* shader, const char* vertexPath, const char* fragmentPat
     
     // Delete shaders as they're linked into the program now
     glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    if (fragment != 0) {
+        glDeleteShader(fragment);
+    }
+    
+    // Point the per-frame block, if the program uses it, at the shared buffer
+    GLuint frameBlock = glGetUniformBlockIndex(shader->ID, SHADER_FRAME_DATA_BLOCK);
+    if (frameBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(shader->ID, frameBlock, SHADER_FRAME_DATA_BINDING);
+    }
+    
+    // Resolve every uniform location up front
+    shader_cache_uniforms(shader);
+}
+
+void shader_init(Shader* shader, const char* vertexPath, const char* fragmentPath) {
+    // Read vertex shader code
+    char* vertexCode = read_file(vertexPath);
+    if (!vertexCode) {
+        printf("Failed to read vertex shader file\n");
+        return;
+    }
+    
+    // Read fragment shader code
+    char* fragmentCode = read_file(fragmentPath);
+    if (!fragmentCode) {
+        free(vertexCode);
+        printf("Failed to read fragment shader file\n");
+        return;
+    }
+    
+    shader_build(shader, vertexCode, fragmentCode, NULL, 0);
     
     // Free memory
     free(vertexCode);
     free(fragmentCode);
 }
 
+void shader_init_feedback(Shader* shader, const char* vertexPath, const char* const* varyings,
+                          int varyingCount) {
+    char* vertexCode = read_file(vertexPath);
+    if (!vertexCode) {
+        printf("Failed to read vertex shader file\n");
+        return;
+    }
+    
+    shader_build(shader, vertexCode, NULL, varyings, varyingCount);
+    free(vertexCode);
+}
+
 void shader_use(Shader* shader) {
-    glUseProgram(shader->ID);
+    gl_state_use_program(shader->ID);
+}
+
+void shader_cleanup(Shader* shader) {
+    if (shader->ID != 0) {
+        glDeleteProgram(shader->ID);
+        // A new program may reuse the name
+        gl_state_invalidate();
+    }
+    memset(shader, 0, sizeof(*shader));
+}
+
+int shader_uniform(const Shader* shader, const char* name) {
+    unsigned int hash = hash_uniform_name(name);
+    
+    for (int probe = 0; probe < SHADER_UNIFORM_TABLE_SIZE; probe++) {
+        int slot = (int)((hash + (unsigned int)probe) & (SHADER_UNIFORM_TABLE_SIZE - 1));
+        const ShaderUniform* uniform = &shader->uniforms[slot];
+        
+        if (uniform->name[0] == '\0') {
+            return -1;
+        }
+        if (uniform->nameHash == hash && strcmp(uniform->name, name) == 0) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+// Remember value as the uniform's contents. Returns false if it already held it
+static bool uniform_changed(Shader* shader, int uniform, const void* value, size_t size) {
+    ShaderUniform* entry = &shader->uniforms[uniform];
+    if (entry->hasValue && memcmp(entry->value, value, size) == 0) {
+        return false;
+    }
+    memcpy(entry->value, value, size);
+    entry->hasValue = true;
+    return true;
+}
+
+void shader_uniform_bool(Shader* shader, int uniform, bool value) {
+    shader_uniform_int(shader, uniform, (int)value);
+}
+
+void shader_uniform_int(Shader* shader, int uniform, int value) {
+    if (uniform < 0 || !uniform_changed(shader, uniform, &value, sizeof(value))) {
+        return;
+    }
+    glUniform1i(shader->uniforms[uniform].location, value);
+}
+
+void shader_uniform_float(Shader* shader, int uniform, float value) {
+    if (uniform < 0 || !uniform_changed(shader, uniform, &value, sizeof(value))) {
+        return;
+    }
+    glUniform1f(shader->uniforms[uniform].location, value);
+}
+
+void shader_uniform_vec3(Shader* shader, int uniform, vec3 value) {
+    if (uniform < 0 || !uniform_changed(shader, uniform, value, 3 * sizeof(float))) {
+        return;
+    }
+    glUniform3fv(shader->uniforms[uniform].location, 1, value);
+}
+
+void shader_uniform_mat4(Shader* shader, int uniform, mat4 value) {
+    if (uniform < 0 || !uniform_changed(shader, uniform, value, 16 * sizeof(float))) {
+        return;
+    }
+    glUniformMatrix4fv(shader->uniforms[uniform].location, 1, GL_FALSE, (float*)value);
+}
+
+// Arrays skip the redundant-upload check; the cached value only covers element 0
+void shader_uniform_vec4v(Shader* shader, int uniform, int count, const float* values) {
+    if (uniform < 0 || count <= 0) {
+        return;
+    }
+    shader->uniforms[uniform].hasValue = false;
+    glUniform4fv(shader->uniforms[uniform].location, count, values);
+}
+
+void shader_uniform_ivec2v(Shader* shader, int uniform, int count, const int* values) {
+    if (uniform < 0 || count <= 0) {
+        return;
+    }
+    shader->uniforms[uniform].hasValue = false;
+    glUniform2iv(shader->uniforms[uniform].location, count, values);
 }
 
 void shader_set_bool(Shader* shader, const char* name, bool value) {
-    glUniform1i(glGetUniformLocation(shader->ID, name), (int)value);
+    shader_uniform_bool(shader, shader_uniform(shader, name), value);
 }
 
 void shader_set_int(Shader* shader, const char* name, int value) {
-    glUniform1i(glGetUniformLocation(shader->ID, name), value);
+    shader_uniform_int(shader, shader_uniform(shader, name), value);
 }
 
 void shader_set_float(Shader* shader, const char* name, float value) {
-    glUniform1f(glGetUniformLocation(shader->ID, name), value);
+    shader_uniform_float(shader, shader_uniform(shader, name), value);
 }
 
 void shader_set_vec3(Shader* shader, const char* name, vec3 value) {
-    glUniform3fv(glGetUniformLocation(shader->ID, name), 1, value);
+    shader_uniform_vec3(shader, shader_uniform(shader, name), value);
 }
 
 void shader_set_mat4(Shader* shader, const char* name, mat4 value) {
-    glUniformMatrix4fv(glGetUniformLocation(shader->ID, name), 1, GL_FALSE, (float*)value);
+    shader_uniform_mat4(shader, shader_uniform(shader, name), value);
 }
 
 void shader_get_mat4(Shader* shader, const char* name, mat4 dest) {
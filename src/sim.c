@@ -0,0 +1,207 @@
+#include "sim.h"
+#include "projectile.h"
+#include "enemy.h"
+#include "job_system.h"
+#include "timer.h"
+#include "profiler.h"
+#include <math.h>
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Player tuning
+#define PLAYER_MOVE_SPEED 0.03f         // Units per tick at full stick
+#define PLAYER_ATTACK_COOLDOWN 0.5f     // Seconds between attacks
+#define SPIN_ATTACK_LIFETIME 5.0f       // Seconds the orbiting daggers last
+#define SPIN_ATTACK_HEIGHT 0.3f         // Dagger height above the player
+
+static SimPlayer player;
+static WaveState waves;
+static SimTimings timings;
+
+// Jobs of the tick in flight between sim_tick_begin and sim_tick_end.
+// Each parallel stage is followed by a marker job that timestamps when it
+// drained, so stage timings hold up however the jobs were scheduled.
+static JobCounter integrated;
+static JobCounter integratedMarked;
+static JobCounter collided;
+static JobCounter collidedMarked;
+static uint64_t integratedAtNs = 0;
+static uint64_t collidedAtNs = 0;
+static uint64_t tickStartNs = 0;
+static uint64_t stageStartNs = 0;
+static bool startWaveRequested = false;
+static float tickDeltaTime = 0.0f;
+
+// Initialize the player, projectiles, enemies and waves
+void sim_init(void) {
+    physics_body_init(&player.body, 0.0f, GROUND_LEVEL, 0.0f);
+    player.prevX = player.body.x;
+    player.prevY = player.body.y;
+    player.prevZ = player.body.z;
+    player.attackCooldown = 0.0f;
+    player.direction = 0.0f;
+    player.facingRight = true;
+    player.isMoving = false;
+    player.isJumping = false;
+    player.attack = SIM_ATTACK_NONE;
+    
+    projectile_system_init();
+    enemy_system_init();
+    wave_init(&waves);
+}
+
+// Release simulation state
+void sim_cleanup(void) {
+    projectile_system_cleanup();
+    enemy_system_cleanup();
+}
+
+// Movement, jumping and attacks for one tick
+static void update_player(const SimInput* input, float deltaTime) {
+    PhysicsBody* body = &player.body;
+    
+    // Move with the stick
+    player.isMoving = false;
+    if (input->moveX != 0.0f || input->moveZ != 0.0f) {
+        body->x += input->moveX * PLAYER_MOVE_SPEED;
+        body->z += input->moveZ * PLAYER_MOVE_SPEED;
+        
+        player.direction = atan2f(input->moveZ, input->moveX);
+        player.facingRight = (input->moveX > 0);
+        player.isMoving = true;
+    }
+    
+    // Handle jumping
+    player.isJumping = physics_update_jump(body, input->jump);
+    
+    // Update attack cooldown
+    player.attack = SIM_ATTACK_NONE;
+    if (player.attackCooldown > 0) {
+        player.attackCooldown -= deltaTime;
+    }
+    
+    // Only check for attacks if cooldown is done
+    if (player.attackCooldown <= 0) {
+        if (input->attack) {
+            player.attack = SIM_ATTACK_SWORD;
+            player.attackCooldown = PLAYER_ATTACK_COOLDOWN;
+            LOG("Attack triggered!");
+            sim_events_push(SIM_EVENT_SWORD_SLASH, body->x, body->y, body->z,
+                            player.facingRight ? 1.0f : -1.0f);
+        } else if (input->spinAttack) {
+            player.attack = SIM_ATTACK_SPIN;
+            player.attackCooldown = PLAYER_ATTACK_COOLDOWN;
+            LOG("Spinning dagger attack triggered!");
+            sim_events_push(SIM_EVENT_SPIN_ATTACK, body->x, body->y + SPIN_ATTACK_HEIGHT, body->z, 0.0f);
+            
+            // Spawn the orbiting daggers (direction doesn't matter in orbit mode)
+            set_projectile_orbit_mode(true);
+            spawn_projectile(body->x, body->y + SPIN_ATTACK_HEIGHT, body->z,
+                             0.0f, 0.0f, 0.0f, SPIN_ATTACK_LIFETIME);
+        }
+    }
+}
+
+// Record the time since the previous stage boundary
+static void end_stage(SimStage stage) {
+    uint64_t now = timer_now_ns();
+    timings.stageNs[stage] = now - stageStartNs;
+    stageStartNs = now;
+}
+
+// Job: remember when the stage it was chained behind finished
+static void mark_stage_job(void* data, int begin, int end) {
+    (void)begin; (void)end;
+    *(uint64_t*)data = timer_now_ns();
+}
+
+// Run the player stage and start the parallel part of the tick
+void sim_tick_begin(const SimInput* input, float deltaTime) {
+    tickStartNs = timer_now_ns();
+    stageStartNs = tickStartNs;
+    startWaveRequested = input->startWave;
+    tickDeltaTime = deltaTime;
+    sim_events_clear();
+    
+    // Keep the pre-step position for render interpolation
+    player.prevX = player.body.x;
+    player.prevY = player.body.y;
+    player.prevZ = player.body.z;
+    
+    PROFILE_SCOPE("sim.player") update_player(input, deltaTime);
+    end_stage(SIM_STAGE_PLAYER);
+    
+    // Projectiles and enemies integrate in parallel, collision detection
+    // starts once both are done
+    job_counter_init(&integrated);
+    job_counter_init(&integratedMarked);
+    job_counter_init(&collided);
+    job_counter_init(&collidedMarked);
+    
+    update_projectiles_async(deltaTime, &integrated);
+    update_enemies_async(deltaTime, player.body.x, player.body.z, &integrated);
+    job_submit(&integratedMarked, &integrated, mark_stage_job, &integratedAtNs);
+    check_enemy_projectile_collisions_async(&integratedMarked, &collided);
+    job_submit(&collidedMarked, &collided, mark_stage_job, &collidedAtNs);
+}
+
+// Wait for the parallel part of the tick, then sweep the dead and run waves
+void sim_tick_end(void) {
+    PROFILE_SCOPE("sim.join") job_wait(&collidedMarked);
+    timings.stageNs[SIM_STAGE_INTEGRATE] = integratedAtNs - stageStartNs;
+    timings.stageNs[SIM_STAGE_COLLIDE] = collidedAtNs - integratedAtNs;
+    stageStartNs = timer_now_ns();
+    
+    // Orbiting daggers follow the player; enemies killed this tick are swept
+    PROFILE_SCOPE("sim.cleanup") {
+        update_orbit_center(player.body.x, player.body.z);
+        remove_dead_enemies();
+    }
+    end_stage(SIM_STAGE_CLEANUP);
+    
+    PROFILE_SCOPE("sim.waves") wave_update(&waves, startWaveRequested, tickDeltaTime);
+    end_stage(SIM_STAGE_WAVES);
+    
+    // Sum of the stages, leaving out whatever the caller did between
+    // sim_tick_begin and sim_tick_end
+    timings.totalNs = 0;
+    for (int stage = 0; stage < SIM_STAGE_COUNT; stage++) {
+        timings.totalNs += timings.stageNs[stage];
+    }
+}
+
+// sim_tick_begin followed by sim_tick_end
+void sim_tick(const SimInput* input, float deltaTime) {
+    sim_tick_begin(input, deltaTime);
+    sim_tick_end();
+}
+
+// Current player state
+const SimPlayer* sim_get_player(void) {
+    return &player;
+}
+
+// Current wave state
+const WaveState* sim_get_waves(void) {
+    return &waves;
+}
+
+// Stage timings of the last completed tick
+const SimTimings* sim_get_timings(void) {
+    return &timings;
+}
+
+// Short name of a stage for reports
+const char* sim_stage_name(SimStage stage) {
+    switch (stage) {
+        case SIM_STAGE_PLAYER:    return "player";
+        case SIM_STAGE_INTEGRATE: return "integrate";
+        case SIM_STAGE_COLLIDE:   return "collide";
+        case SIM_STAGE_CLEANUP:   return "cleanup";
+        case SIM_STAGE_WAVES:     return "waves";
+        case SIM_STAGE_COUNT:     break;
+    }
+    return "unknown";
+}
@@ -0,0 +1,37 @@
+#include "sim_events.h"
+
+static SimEvent events[SIM_EVENTS_CAPACITY];
+static int eventCount = 0;
+static int droppedCount = 0;
+
+// Start a new tick's log
+void sim_events_clear(void) {
+    eventCount = 0;
+    droppedCount = 0;
+}
+
+// Append an event, or count it as dropped when the log is full
+void sim_events_push(SimEventType type, float x, float y, float z, float value) {
+    if (eventCount >= SIM_EVENTS_CAPACITY) {
+        droppedCount++;
+        return;
+    }
+    
+    SimEvent* event = &events[eventCount++];
+    event->type = type;
+    event->x = x;
+    event->y = y;
+    event->z = z;
+    event->value = value;
+}
+
+// Events of the last tick
+const SimEvent* sim_events_get(int* count) {
+    *count = eventCount;
+    return events;
+}
+
+// Events that did not fit during the last tick
+int sim_events_dropped(void) {
+    return droppedCount;
+}
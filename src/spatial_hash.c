@@ -0,0 +1,237 @@
+#include "spatial_hash.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Smallest bucket table we ever allocate
+#define SPATIAL_HASH_MIN_BUCKETS 64
+
+// Most cells a query footprint may cover before it scans the whole table instead
+#define SPATIAL_HASH_MAX_VISITED 64
+
+// Integer cell coordinate for a world coordinate
+static int cell_coord(const SpatialHash* hash, float v) {
+    return (int)floorf(v * hash->invCellSize);
+}
+
+// Map a cell to its bucket
+static int cell_bucket(const SpatialHash* hash, int cx, int cz) {
+    unsigned int h = ((unsigned int)cx * 73856093u) ^ ((unsigned int)cz * 19349663u);
+    return (int)(h & (unsigned int)(hash->bucketCount - 1));
+}
+
+// Initialize an empty hash with the given cell size
+void spatial_hash_init(SpatialHash* hash, float cellSize) {
+    memset(hash, 0, sizeof(*hash));
+
+    if (cellSize <= 0.0f) {
+        cellSize = SPATIAL_HASH_DEFAULT_CELL_SIZE;
+    }
+    hash->cellSize = cellSize;
+    hash->invCellSize = 1.0f / cellSize;
+}
+
+// Make sure the tables fit count items
+static bool spatial_hash_reserve(SpatialHash* hash, int count) {
+    // Keep roughly two buckets per item so chains stay short
+    int bucketCount = SPATIAL_HASH_MIN_BUCKETS;
+    while (bucketCount < count * 2) {
+        bucketCount *= 2;
+    }
+
+    if (bucketCount > hash->bucketCount) {
+        int* starts = (int*)realloc(hash->bucketStart, (size_t)(bucketCount + 1) * sizeof(int));
+        if (!starts) {
+            return false;
+        }
+        hash->bucketStart = starts;
+        hash->bucketCount = bucketCount;
+    }
+
+    if (count > hash->itemCapacity) {
+        int capacity = hash->itemCapacity > 0 ? hash->itemCapacity : SPATIAL_HASH_MIN_BUCKETS;
+        while (capacity < count) {
+            capacity *= 2;
+        }
+
+        int* indices = (int*)realloc(hash->itemIndices, (size_t)capacity * sizeof(int));
+        if (!indices) {
+            return false;
+        }
+        hash->itemIndices = indices;
+
+        int* buckets = (int*)realloc(hash->itemBucket, (size_t)capacity * sizeof(int));
+        if (!buckets) {
+            return false;
+        }
+        hash->itemBucket = buckets;
+        hash->itemCapacity = capacity;
+    }
+
+    return true;
+}
+
+// Rebuild the hash from item positions and radii
+bool spatial_hash_build(SpatialHash* hash, const float* x, const float* z, const float* radius, int count) {
+    if (!spatial_hash_reserve(hash, count)) {
+        LOG("Failed to grow spatial hash to %d items", count);
+        hash->itemCount = 0;
+        return false;
+    }
+
+    hash->itemX = x;
+    hash->itemZ = z;
+    hash->itemRadius = radius;
+    hash->itemCount = count;
+    hash->maxItemRadius = 0.0f;
+
+    // Counting sort: histogram, exclusive prefix sum, scatter
+    memset(hash->bucketStart, 0, (size_t)(hash->bucketCount + 1) * sizeof(int));
+
+    for (int i = 0; i < count; i++) {
+        int bucket = cell_bucket(hash, cell_coord(hash, x[i]), cell_coord(hash, z[i]));
+        hash->itemBucket[i] = bucket;
+        hash->bucketStart[bucket + 1]++;
+
+        if (radius[i] > hash->maxItemRadius) {
+            hash->maxItemRadius = radius[i];
+        }
+    }
+
+    for (int b = 0; b < hash->bucketCount; b++) {
+        hash->bucketStart[b + 1] += hash->bucketStart[b];
+    }
+
+    // Scatter using bucketStart[b] as a cursor, then shift back into place
+    for (int i = 0; i < count; i++) {
+        int bucket = hash->itemBucket[i];
+        hash->itemIndices[hash->bucketStart[bucket]++] = i;
+    }
+
+    for (int b = hash->bucketCount; b > 0; b--) {
+        hash->bucketStart[b] = hash->bucketStart[b - 1];
+    }
+    hash->bucketStart[0] = 0;
+
+    return true;
+}
+
+// Test every item in one bucket against the circle
+static int query_bucket(const SpatialHash* hash, int bucket, float x, float z, float radius,
+                        int queryIndex, ContactList* contacts) {
+    int added = 0;
+
+    for (int k = hash->bucketStart[bucket]; k < hash->bucketStart[bucket + 1]; k++) {
+        int i = hash->itemIndices[k];
+        float dx = hash->itemX[i] - x;
+        float dz = hash->itemZ[i] - z;
+        float combined = hash->itemRadius[i] + radius;
+
+        // Compare squared distances, no sqrt needed
+        if (dx * dx + dz * dz < combined * combined) {
+            if (contact_list_push(contacts, queryIndex, i)) {
+                added++;
+            }
+        }
+    }
+
+    return added;
+}
+
+// Report every item overlapping the circle into contacts
+int spatial_hash_query_circle(const SpatialHash* hash, float x, float z, float radius,
+                              int queryIndex, ContactList* contacts) {
+    if (hash->itemCount == 0) {
+        return 0;
+    }
+
+    // Expand by the largest item radius so items centred in neighbouring cells are found
+    float reach = radius + hash->maxItemRadius;
+    int minX = cell_coord(hash, x - reach);
+    int maxX = cell_coord(hash, x + reach);
+    int minZ = cell_coord(hash, z - reach);
+    int maxZ = cell_coord(hash, z + reach);
+
+    int added = 0;
+
+    // Every item lives in exactly one bucket, so a footprint too big for the
+    // visited list walks each bucket once instead of dropping the dedup
+    long long cellCount = ((long long)maxX - minX + 1) * ((long long)maxZ - minZ + 1);
+    if (cellCount > SPATIAL_HASH_MAX_VISITED || cellCount >= hash->bucketCount) {
+        for (int bucket = 0; bucket < hash->bucketCount; bucket++) {
+            added += query_bucket(hash, bucket, x, z, radius, queryIndex, contacts);
+        }
+        return added;
+    }
+
+    // Distinct cells can share a bucket; visit each bucket once to avoid duplicate pairs
+    int visited[SPATIAL_HASH_MAX_VISITED];
+    int visitedCount = 0;
+
+    for (int cz = minZ; cz <= maxZ; cz++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            int bucket = cell_bucket(hash, cx, cz);
+
+            bool seen = false;
+            for (int v = 0; v < visitedCount; v++) {
+                if (visited[v] == bucket) {
+                    seen = true;
+                    break;
+                }
+            }
+            if (seen) {
+                continue;
+            }
+            visited[visitedCount++] = bucket;
+
+            added += query_bucket(hash, bucket, x, z, radius, queryIndex, contacts);
+        }
+    }
+
+    return added;
+}
+
+// Release the hash tables
+void spatial_hash_free(SpatialHash* hash) {
+    free(hash->bucketStart);
+    free(hash->itemIndices);
+    free(hash->itemBucket);
+
+    float cellSize = hash->cellSize;
+    memset(hash, 0, sizeof(*hash));
+    hash->cellSize = cellSize;
+    hash->invCellSize = cellSize > 0.0f ? 1.0f / cellSize : 0.0f;
+}
+
+// Drop all contacts but keep the allocation
+void contact_list_clear(ContactList* list) {
+    list->count = 0;
+}
+
+// Append a contact, growing the list if needed
+bool contact_list_push(ContactList* list, int queryIndex, int itemIndex) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 64;
+        Contact* grown = (Contact*)realloc(list->contacts, (size_t)capacity * sizeof(Contact));
+        if (!grown) {
+            return false;
+        }
+        list->contacts = grown;
+        list->capacity = capacity;
+    }
+
+    list->contacts[list->count].queryIndex = queryIndex;
+    list->contacts[list->count].itemIndex = itemIndex;
+    list->count++;
+    return true;
+}
+
+// Release the contact storage
+void contact_list_free(ContactList* list) {
+    free(list->contacts);
+    memset(list, 0, sizeof(*list));
+}
@@ -3,69 +3,27 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "texture.h"
+#include "renderer.h"
 #include "logging.h"
 
 // Define this module for logging
 LOG_MODULE_DEFINE(__FILE__, false);
 
-// Initialize a sprite with animation frames
-void sprite_init(Sprite* sprite, const char** texturePaths, int frameCount, float frameTime, bool loop) {
+// Initialize a sprite whose frames are UV rects in one texture
+void sprite_init(Sprite* sprite, unsigned int textureID, const vec4* frameUVs, int frameCount,
+                 float frameTime, bool loop) {
     // Initialize animation properties
+    sprite->textureID = textureID;
+    sprite->frameUVs = frameUVs;
     sprite->frameCount = frameCount;
     sprite->currentFrame = 0;
     sprite->frameDuration = frameTime;
     sprite->timer = 0.0f;
     sprite->loop = loop;
+    sprite->width = 0.0f;
+    sprite->height = 0.0f;
     
-    // Allocate memory for texture IDs
-    sprite->textureIDs = (unsigned int*)malloc(frameCount * sizeof(unsigned int));
-    
-    // Load textures for each frame
-    for (int i = 0; i < frameCount; i++) {
-        sprite->textureIDs[i] = texture_load_png(texturePaths[i]);
-        LOG("Loaded sprite texture %d/%d: %s (ID: %u)", 
-               i+1, frameCount, texturePaths[i], sprite->textureIDs[i]);
-    }
-    
-    // Create a quad for the sprite
-    float vertices[] = {
-        // positions          // texture coords
-        -0.5f, -0.5f, 0.0f,   0.0f, 1.0f,
-         0.5f, -0.5f, 0.0f,   1.0f, 1.0f,
-         0.5f,  0.5f, 0.0f,   1.0f, 0.0f,
-        -0.5f,  0.5f, 0.0f,   0.0f, 0.0f
-    };
-    
-    unsigned int indices[] = {
-        0, 1, 2,
-        2, 3, 0
-    };
-    
-    // Create VAO, VBO, and EBO
-    glGenVertexArrays(1, &sprite->VAO);
-    glGenBuffers(1, &sprite->VBO);
-    glGenBuffers(1, &sprite->EBO);
-    
-    glBindVertexArray(sprite->VAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, sprite->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sprite->EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Texture coord attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    LOG("Sprite uses %d frames of texture %u", frameCount, textureID);
 }
 
 // Update sprite animation with frame-rate independence
@@ -104,20 +62,10 @@ void sprite_update(Sprite* sprite, float deltaTime) {
 
 // Render the sprite with proper flipping
 void sprite_render(Sprite* sprite, Shader* shader, vec3 position, float scale) {
-    shader_use(shader);
-    
     LOG("Rendering sprite at position (%.2f, %.2f, %.2f) with scale %.2f, frame %d/%d", 
            position[0], position[1], position[2], scale, 
            sprite->currentFrame + 1, sprite->frameCount);
     
-    // Enable blending
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    
-    // Bind texture
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, sprite->textureIDs[sprite->currentFrame]);
-    
     // Create model matrix
     mat4 model = GLM_MAT4_IDENTITY_INIT;
     
@@ -139,96 +87,18 @@ void sprite_render(Sprite* sprite, Shader* shader, vec3 position, float scale) {
         glm_rotate(model, glm_rad(180.0f), (vec3){0.0f, 1.0f, 0.0f});
     }
     
-    // Set model matrix in shader
-    shader_set_mat4(shader, "model", model);
-    
-    // Set texture sampler
-    shader_set_int(shader, "texture1", 0);
-    
-    // Draw sprite
-    glBindVertexArray(sprite->VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-    
-    // Disable blending
-    glDisable(GL_BLEND);
+    // Queue the quad; the renderer draws it with others sharing the texture
+    renderer_submit_quad(shader, sprite->textureID, SAMPLER_PIXEL_ART_MIPMAPPED, model, sprite->frameUVs[sprite->currentFrame], NULL);
 }
 
-// Clean up sprite resources
+// Detach the sprite from its frames (the texture belongs to whoever built it)
 void sprite_cleanup(Sprite* sprite) {
-    glDeleteVertexArrays(1, &sprite->VAO);
-    glDeleteBuffers(1, &sprite->VBO);
-    glDeleteBuffers(1, &sprite->EBO);
-    
-    // Delete all textures
-    for (int i = 0; i < sprite->frameCount; i++) {
-        glDeleteTextures(1, &sprite->textureIDs[i]);
-    }
-    
-    // Free the texture IDs array
-    free(sprite->textureIDs);
-    
-    LOG("Sprite resources cleaned up");
-}
-
-// Initialize a sprite with a pre-created texture
-void sprite_init_with_texture(Sprite* sprite, const char** texturePaths, int frameCount, 
-                             float frameTime, bool loop, unsigned int textureID) {
-    // Initialize animation properties
-    sprite->frameCount = frameCount;
+    sprite->textureID = 0;
+    sprite->frameUVs = NULL;
+    sprite->frameCount = 0;
     sprite->currentFrame = 0;
-    sprite->frameDuration = frameTime;
-    sprite->timer = 0.0f;
-    sprite->loop = loop;
-    
-    // Allocate memory for texture IDs
-    sprite->textureIDs = (unsigned int*)malloc(frameCount * sizeof(unsigned int));
-    
-    // Use the provided texture for all frames
-    for (int i = 0; i < frameCount; i++) {
-        sprite->textureIDs[i] = textureID;
-        LOG("Using provided texture for frame %d/%d (ID: %u)", 
-               i+1, frameCount, textureID);
-    }
-    
-    // Create a quad for the sprite with correct texture coordinates
-    float vertices[] = {
-        // positions          // texture coords
-        -0.5f, -0.5f, 0.0f,   0.0f, 1.0f, // bottom left
-         0.5f, -0.5f, 0.0f,   1.0f, 1.0f, // bottom right
-         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, // top right
-        -0.5f,  0.5f, 0.0f,   0.0f, 0.0f  // top left
-    };
-    
-    unsigned int indices[] = {
-        0, 1, 2, // first triangle
-        2, 3, 0  // second triangle
-    };
-    
-    // Create VAO, VBO, and EBO
-    glGenVertexArrays(1, &sprite->VAO);
-    glGenBuffers(1, &sprite->VBO);
-    glGenBuffers(1, &sprite->EBO);
-    
-    glBindVertexArray(sprite->VAO);
     
-    glBindBuffer(GL_ARRAY_BUFFER, sprite->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sprite->EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Texture coord attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
-    // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    LOG("Sprite resources cleaned up");
 }
 
 // Render sprite with bottom at ground level
@@ -0,0 +1,181 @@
+#include "sprite_atlas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../external/stb/stb_image.h"
+#include "texture.h"
+#include "texture_stream.h"
+#include "job_system.h"
+#include "gl_state.h"
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Create the texture from a premultiplied page's mip chain
+static void upload_page(SpriteAtlas* atlas, int width, int height, int mipCount,
+                        const unsigned char* const* mips) {
+    glGenTextures(1, &atlas->textureID);
+    gl_state_bind_texture(0, atlas->textureID);
+    
+    // Pixel art: no filtering within a level. The chain stops while the
+    // padding between frames still separates them.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipCount - 1);
+    
+    atlas->residentBytes = 0;
+    for (int level = 0; level < mipCount; level++) {
+        int levelWidth = width >> level > 0 ? width >> level : 1;
+        int levelHeight = height >> level > 0 ? height >> level : 1;
+        texture_stream_image(level, GL_RGBA, levelWidth, levelHeight, GL_RGBA, mips[level]);
+        atlas->residentBytes += (long long)levelWidth * levelHeight * 4;
+    }
+    
+    gl_state_bind_texture(0, 0);
+    texture_account_bytes(atlas->residentBytes);
+    
+    atlas->width = width;
+    atlas->height = height;
+}
+
+// Allocate the per-frame tables
+static void alloc_frames(SpriteAtlas* atlas, int frameCount) {
+    atlas->frameCount = frameCount;
+    atlas->frameUVs = (vec4*)calloc((size_t)frameCount, sizeof(vec4));
+    atlas->frameWidths = (int*)calloc((size_t)frameCount, sizeof(int));
+    atlas->frameHeights = (int*)calloc((size_t)frameCount, sizeof(int));
+}
+
+// One image decoded by a background job
+typedef struct {
+    const char* path;
+    AtlasImage* image;
+} DecodeTask;
+
+static void decode_image_job(void* data, int begin, int end) {
+    DecodeTask* task = (DecodeTask*)data;
+    AtlasImage* image = task->image;
+    int channels;
+    image->pixels = stbi_load(task->path, &image->width, &image->height, &channels, 4);
+    if (!image->pixels) {
+        LOG("Failed to load atlas frame: %s", task->path);
+    }
+}
+
+// Decode every image in paths on background jobs and pack them into one page
+bool sprite_atlas_decode(SpriteAtlasSource* source, const char* const* paths, int pathCount, int maxSize) {
+    memset(source, 0, sizeof(*source));
+    source->images = (AtlasImage*)calloc((size_t)pathCount, sizeof(AtlasImage));
+    source->imageCount = pathCount;
+    
+    // One frame per background job: the files are small and decode time
+    // dominates. Background jobs never reach a stealable deque, so a main
+    // thread job_wait can't pick up a decode; a worker waiting here runs
+    // them itself.
+    DecodeTask* tasks = (DecodeTask*)malloc((size_t)pathCount * sizeof(DecodeTask));
+    JobCounter decoded;
+    job_counter_init(&decoded);
+    for (int i = 0; i < pathCount; i++) {
+        tasks[i].path = paths[i];
+        tasks[i].image = &source->images[i];
+        job_submit_background(&decoded, decode_image_job, &tasks[i]);
+    }
+    job_wait(&decoded);
+    free(tasks);
+    
+    if (!atlas_pack(source->images, pathCount, maxSize > 0 ? maxSize : 4096, &source->page)) {
+        sprite_atlas_source_free(source);
+        return false;
+    }
+    return true;
+}
+
+// Create the texture and frame table from a decoded source, then free it
+bool sprite_atlas_upload(SpriteAtlas* atlas, SpriteAtlasSource* source) {
+    memset(atlas, 0, sizeof(*atlas));
+    
+    AtlasPage* page = &source->page;
+    upload_page(atlas, page->width, page->height, page->mipCount, (const unsigned char* const*)page->mips);
+    alloc_frames(atlas, source->imageCount);
+    
+    for (int i = 0; i < source->imageCount; i++) {
+        const AtlasImage* image = &source->images[i];
+        atlas->frameWidths[i] = image->width;
+        atlas->frameHeights[i] = image->height;
+        if (image->pixels) {
+            atlas->frameUVs[i][0] = (float)image->x / (float)page->width;
+            atlas->frameUVs[i][1] = (float)image->y / (float)page->height;
+            atlas->frameUVs[i][2] = (float)(image->x + image->width) / (float)page->width;
+            atlas->frameUVs[i][3] = (float)(image->y + image->height) / (float)page->height;
+        }
+    }
+    
+    LOG("Packed %d frames into a %dx%d sprite atlas (ID: %u)",
+        source->imageCount, page->width, page->height, atlas->textureID);
+    sprite_atlas_source_free(source);
+    return true;
+}
+
+// Free a decoded source that won't be uploaded
+void sprite_atlas_source_free(SpriteAtlasSource* source) {
+    for (int i = 0; i < source->imageCount; i++) {
+        if (source->images[i].pixels) {
+            stbi_image_free(source->images[i].pixels);
+        }
+    }
+    free(source->images);
+    atlas_page_free(&source->page);
+    memset(source, 0, sizeof(*source));
+}
+
+// Upload the atlas page and frame table of a cooked pack as-is
+bool sprite_atlas_load_pack(SpriteAtlas* atlas, const AssetPack* pack) {
+    memset(atlas, 0, sizeof(*atlas));
+    
+    const AssetPackHeader* header = pack->header;
+    const unsigned char* mips[ATLAS_MAX_MIP_LEVELS];
+    int width = 0;
+    int height = 0;
+    for (uint32_t level = 0; level < header->mipCount; level++) {
+        int levelWidth, levelHeight;
+        mips[level] = asset_pack_mip(pack, (int)level, &levelWidth, &levelHeight);
+        if (level == 0) {
+            width = levelWidth;
+            height = levelHeight;
+        }
+    }
+    
+    // Straight from the mapping: no decode, no premultiply, no mip generation
+    upload_page(atlas, width, height, (int)header->mipCount, mips);
+    alloc_frames(atlas, (int)header->frameCount);
+    
+    for (uint32_t i = 0; i < header->frameCount; i++) {
+        const AssetPackFrame* frame = &pack->frames[i];
+        atlas->frameUVs[i][0] = frame->u0;
+        atlas->frameUVs[i][1] = frame->v0;
+        atlas->frameUVs[i][2] = frame->u1;
+        atlas->frameUVs[i][3] = frame->v1;
+        atlas->frameWidths[i] = (int)frame->width;
+        atlas->frameHeights[i] = (int)frame->height;
+    }
+    
+    LOG("Uploaded %u cooked frames as a %dx%d sprite atlas (ID: %u)",
+        header->frameCount, width, height, atlas->textureID);
+    return true;
+}
+
+// Release the texture and frame tables
+void sprite_atlas_free(SpriteAtlas* atlas) {
+    if (atlas->textureID != 0) {
+        gl_state_delete_textures(1, &atlas->textureID);
+        texture_account_bytes(-atlas->residentBytes);
+    }
+    free(atlas->frameUVs);
+    free(atlas->frameWidths);
+    free(atlas->frameHeights);
+    memset(atlas, 0, sizeof(*atlas));
+}
@@ -0,0 +1,439 @@
+#include "text.h"
+#include "shader.h"
+#include "renderer.h"
+#include "gl_state.h"
+#include "culling.h"
+#include "file_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../external/stb/stb_truetype.h"
+
+#include "logging.h"
+LOG_MODULE_DEFINE(__FILE__, false);
+
+#define TEXT_CHAR_COUNT (TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1)
+
+// Damage number motion and look
+#define DAMAGE_RISE 0.8f            // World units climbed over the lifetime
+#define DAMAGE_PIXEL_SIZE 22.0f     // Line height once the pop has settled
+#define DAMAGE_POP 0.4f             // Extra size at spawn
+#define DAMAGE_CULL_RADIUS 0.5f
+
+// One glyph quad as the text shader reads it per instance
+typedef struct {
+    float anchor[4];          // xyz world position, w 1 (world) or 0 (screen)
+    float rect[4];            // Offset from the anchor in pixels (y down), size
+    float uv[4];              // Atlas rectangle
+    unsigned char color[4];   // Straight RGBA
+} GlyphInstance;
+
+typedef struct {
+    bool loaded;
+    float bakeHeight;         // Pixel height the atlas was baked at
+    float ascent;             // Baseline below the top of a line, at bakeHeight
+    stbtt_bakedchar chars[TEXT_CHAR_COUNT];
+    GLuint texture;
+    GLuint vao;
+    GLuint instanceVBO;
+    GlyphInstance* glyphs;    // This frame's glyphs, TEXT_MAX_GLYPHS allocated at load
+    int glyphCount;
+    int queuedGlyphs;         // Uploaded for this frame's draw
+} TextFont;
+
+typedef struct {
+    float position[3];
+    float age;
+    float amount;
+    int font;
+} DamageNumber;
+
+static Shader textShader;
+static struct {
+    int viewportWidth, viewportHeight, fontAtlas;
+} textUniforms;
+static GLuint cornerVBO = 0;
+static float drawViewportWidth = 1.0f;
+static float drawViewportHeight = 1.0f;
+
+static TextFont fonts[TEXT_MAX_FONTS];
+
+// Ring of damage numbers. They all live equally long, so the live ones are
+// the count slots before head, oldest first, and expire from the back.
+static DamageNumber damageNumbers[TEXT_MAX_DAMAGE_NUMBERS];
+static int damageHead = 0;
+static int damageCount = 0;
+
+static TextStats stats;
+static int droppedGlyphs = 0;
+
+// Load the glyph shader and the corner buffer every font's quads share
+void text_init(void) {
+    shader_init(&textShader, "assets/shaders/text.vert", "assets/shaders/text.frag");
+    textUniforms.viewportWidth = shader_uniform(&textShader, "viewportWidth");
+    textUniforms.viewportHeight = shader_uniform(&textShader, "viewportHeight");
+    textUniforms.fontAtlas = shader_uniform(&textShader, "fontAtlas");
+
+    // Corners in the order of the renderer's shared quad indices
+    // (bottom-left, bottom-right, top-right, top-left; y points down)
+    float corners[] = {
+        0.0f, 1.0f,
+        1.0f, 1.0f,
+        1.0f, 0.0f,
+        0.0f, 0.0f
+    };
+    glGenBuffers(1, &cornerVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, cornerVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    memset(fonts, 0, sizeof(fonts));
+    damageHead = 0;
+    damageCount = 0;
+}
+
+// Vertex array reading the shared corners and a font's instance buffer
+static void create_font_vertex_array(TextFont* font) {
+    glGenVertexArrays(1, &font->vao);
+    glGenBuffers(1, &font->instanceVBO);
+
+    gl_state_bind_vertex_array(font->vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer_quad_index_buffer());
+
+    glBindBuffer(GL_ARRAY_BUFFER, cornerVBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Per-instance attributes advance once per glyph
+    glBindBuffer(GL_ARRAY_BUFFER, font->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, TEXT_MAX_GLYPHS * sizeof(GlyphInstance), NULL, GL_STREAM_DRAW);
+
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (void*)offsetof(GlyphInstance, anchor));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (void*)offsetof(GlyphInstance, rect));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (void*)offsetof(GlyphInstance, uv));
+    glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GlyphInstance), (void*)offsetof(GlyphInstance, color));
+    for (int attribute = 1; attribute <= 4; attribute++) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+
+    gl_state_bind_vertex_array(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Bake a TrueType font into a glyph atlas
+int text_font_load(const char* path, float pixelHeight) {
+    int handle = 0;
+    while (handle < TEXT_MAX_FONTS && fonts[handle].loaded) {
+        handle++;
+    }
+    if (handle == TEXT_MAX_FONTS) {
+        LOG("No free font slot for %s", path);
+        return -1;
+    }
+
+    MappedFile file;
+    if (!file_map_open(&file, path)) {
+        printf("Failed to load font: %s\n", path);
+        return -1;
+    }
+
+    TextFont* font = &fonts[handle];
+    unsigned char* bitmap = (unsigned char*)malloc(TEXT_ATLAS_SIZE * TEXT_ATLAS_SIZE);
+    stbtt_fontinfo info;
+    int baked = -1;
+    if (bitmap && stbtt_InitFont(&info, file.data, stbtt_GetFontOffsetForIndex(file.data, 0))) {
+        baked = stbtt_BakeFontBitmap(file.data, 0, pixelHeight, bitmap, TEXT_ATLAS_SIZE, TEXT_ATLAS_SIZE,
+                                     TEXT_FIRST_CHAR, TEXT_CHAR_COUNT, font->chars);
+
+        int ascent, descent, lineGap;
+        stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+        font->ascent = (float)ascent * stbtt_ScaleForPixelHeight(&info, pixelHeight);
+    }
+    file_map_close(&file);
+
+    // A negative result is the number of characters that did fit
+    if (baked <= 0) {
+        printf("Failed to bake font %s at %.0f pixels into a %d atlas\n", path, pixelHeight, TEXT_ATLAS_SIZE);
+        free(bitmap);
+        return -1;
+    }
+
+    font->glyphs = (GlyphInstance*)malloc(TEXT_MAX_GLYPHS * sizeof(GlyphInstance));
+    if (!font->glyphs) {
+        free(bitmap);
+        return -1;
+    }
+
+    // Single-channel coverage; rows are tightly packed
+    glGenTextures(1, &font->texture);
+    gl_state_bind_texture(0, font->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, TEXT_ATLAS_SIZE, TEXT_ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, bitmap);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    free(bitmap);
+
+    create_font_vertex_array(font);
+    font->bakeHeight = pixelHeight;
+    font->glyphCount = 0;
+    font->queuedGlyphs = 0;
+    font->loaded = true;
+
+    LOG("Baked font %s at %.0f pixels (atlas rows used: %d)", path, pixelHeight, baked);
+    return handle;
+}
+
+// Font behind a handle, or NULL for -1 and unloaded slots
+static TextFont* get_font(int handle) {
+    if (handle < 0 || handle >= TEXT_MAX_FONTS || !fonts[handle].loaded) {
+        return NULL;
+    }
+    return &fonts[handle];
+}
+
+// Baked glyph of a character (unknown ones show as '?')
+static const stbtt_bakedchar* glyph_of(const TextFont* font, char c) {
+    int code = (unsigned char)c;
+    if (code < TEXT_FIRST_CHAR || code > TEXT_LAST_CHAR) {
+        code = '?';
+    }
+    return &font->chars[code - TEXT_FIRST_CHAR];
+}
+
+// Width in pixels of a string drawn at pixelSize
+float text_measure(int handle, float pixelSize, const char* string) {
+    const TextFont* font = get_font(handle);
+    if (!font) {
+        return 0.0f;
+    }
+
+    float width = 0.0f;
+    for (const char* c = string; *c; c++) {
+        width += glyph_of(font, *c)->xadvance;
+    }
+    return width * pixelSize / font->bakeHeight;
+}
+
+// Append a string's glyphs, the baseline starting at (x, baseline) pixels from the anchor
+static void emit_string(TextFont* font, const float anchor[4], float x, float baseline, float scale,
+                        const unsigned char color[4], const char* string) {
+    float atlasScale = 1.0f / (float)TEXT_ATLAS_SIZE;
+
+    for (const char* c = string; *c; c++) {
+        const stbtt_bakedchar* glyph = glyph_of(font, *c);
+
+        // Spaces advance without a quad
+        if (glyph->x1 > glyph->x0 && glyph->y1 > glyph->y0) {
+            if (font->glyphCount >= TEXT_MAX_GLYPHS) {
+                droppedGlyphs++;
+            } else {
+                GlyphInstance* instance = &font->glyphs[font->glyphCount++];
+                memcpy(instance->anchor, anchor, sizeof(instance->anchor));
+                instance->rect[0] = x + glyph->xoff * scale;
+                instance->rect[1] = baseline + glyph->yoff * scale;
+                instance->rect[2] = (float)(glyph->x1 - glyph->x0) * scale;
+                instance->rect[3] = (float)(glyph->y1 - glyph->y0) * scale;
+                instance->uv[0] = (float)glyph->x0 * atlasScale;
+                instance->uv[1] = (float)glyph->y0 * atlasScale;
+                instance->uv[2] = (float)glyph->x1 * atlasScale;
+                instance->uv[3] = (float)glyph->y1 * atlasScale;
+                memcpy(instance->color, color, sizeof(instance->color));
+            }
+        }
+        x += glyph->xadvance * scale;
+    }
+}
+
+// 0-1 floats to bytes
+static void pack_color(const vec4 color, unsigned char packed[4]) {
+    for (int i = 0; i < 4; i++) {
+        float value = color[i] < 0.0f ? 0.0f : (color[i] > 1.0f ? 1.0f : color[i]);
+        packed[i] = (unsigned char)(value * 255.0f + 0.5f);
+    }
+}
+
+// Queue screen text by its top-left corner
+void text_draw_screen(int handle, float x, float y, float pixelSize, const vec4 color, const char* string) {
+    TextFont* font = get_font(handle);
+    if (!font) {
+        return;
+    }
+
+    float scale = pixelSize / font->bakeHeight;
+    float anchor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    unsigned char packed[4];
+    pack_color(color, packed);
+    emit_string(font, anchor, x, y + font->ascent * scale, scale, packed, string);
+}
+
+// Queue world text centered above position
+void text_draw_world(int handle, const vec3 position, float pixelSize, const vec4 color, const char* string) {
+    TextFont* font = get_font(handle);
+    if (!font) {
+        return;
+    }
+
+    float scale = pixelSize / font->bakeHeight;
+    float anchor[4] = {position[0], position[1], position[2], 1.0f};
+    unsigned char packed[4];
+    pack_color(color, packed);
+    emit_string(font, anchor, -0.5f * text_measure(handle, pixelSize, string), 0.0f, scale, packed, string);
+}
+
+// Start a damage number, replacing the oldest when the ring is full
+void text_spawn_damage(int handle, const vec3 position, float amount) {
+    if (!get_font(handle)) {
+        return;
+    }
+
+    DamageNumber* number = &damageNumbers[damageHead];
+    number->position[0] = position[0];
+    number->position[1] = position[1];
+    number->position[2] = position[2];
+    number->age = 0.0f;
+    number->amount = amount;
+    number->font = handle;
+
+    damageHead = (damageHead + 1) % TEXT_MAX_DAMAGE_NUMBERS;
+    if (damageCount < TEXT_MAX_DAMAGE_NUMBERS) {
+        damageCount++;
+    }
+}
+
+// Age the damage numbers and retire the expired ones from the back
+void text_update(float deltaTime) {
+    int oldest = (damageHead - damageCount + TEXT_MAX_DAMAGE_NUMBERS) % TEXT_MAX_DAMAGE_NUMBERS;
+    for (int n = 0; n < damageCount; n++) {
+        damageNumbers[(oldest + n) % TEXT_MAX_DAMAGE_NUMBERS].age += deltaTime;
+    }
+
+    while (damageCount > 0 && damageNumbers[oldest].age >= TEXT_DAMAGE_LIFETIME) {
+        oldest = (oldest + 1) % TEXT_MAX_DAMAGE_NUMBERS;
+        damageCount--;
+    }
+}
+
+// Queue the visible damage numbers as world text
+static void layout_damage_numbers(void) {
+    int oldest = (damageHead - damageCount + TEXT_MAX_DAMAGE_NUMBERS) % TEXT_MAX_DAMAGE_NUMBERS;
+
+    // Tested against the frame frustum directly; the culling stats count entities only
+    const Frustum* frustum = culling_frame_frustum();
+
+    for (int n = 0; n < damageCount; n++) {
+        const DamageNumber* number = &damageNumbers[(oldest + n) % TEXT_MAX_DAMAGE_NUMBERS];
+        float t = number->age / TEXT_DAMAGE_LIFETIME;
+
+        // Rise quickly and settle; skip the ones off screen
+        vec3 position = {
+            number->position[0],
+            number->position[1] + DAMAGE_RISE * t * (2.0f - t),
+            number->position[2]
+        };
+        if (!frustum_sphere_visible(frustum, position, DAMAGE_CULL_RADIUS)) {
+            continue;
+        }
+        stats.visibleNumbers++;
+
+        // Pop in over the first 15%, fade over the last 40%
+        float pop = t < 0.15f ? DAMAGE_POP * (1.0f - t / 0.15f) : 0.0f;
+        float alpha = t > 0.6f ? (1.0f - t) / 0.4f : 1.0f;
+
+        // Heavier hits read warmer
+        vec4 color = {1.0f, number->amount >= 50.0f ? 0.55f : 0.9f, 0.25f, alpha};
+
+        char digits[16];
+        snprintf(digits, sizeof(digits), "%d", (int)(number->amount + 0.5f));
+        text_draw_world(number->font, position, DAMAGE_PIXEL_SIZE * (1.0f + pop), color, digits);
+    }
+}
+
+// Render queue callback: the text shader, the font's atlas and vertex array are bound
+static void draw_font_item(void* data) {
+    const TextFont* font = (const TextFont*)data;
+    shader_uniform_float(&textShader, textUniforms.viewportWidth, drawViewportWidth);
+    shader_uniform_float(&textShader, textUniforms.viewportHeight, drawViewportHeight);
+    shader_uniform_int(&textShader, textUniforms.fontAtlas, 0);
+
+    // Text sits on top of the scene
+    gl_state_set_enabled(GL_DEPTH_TEST, false);
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0, font->queuedGlyphs);
+    gl_state_set_enabled(GL_DEPTH_TEST, true);
+}
+
+// Upload every font's glyphs and queue one overlay draw per font
+void text_render(float viewportWidth, float viewportHeight) {
+    stats.damageNumbers = damageCount;
+    stats.visibleNumbers = 0;
+    stats.glyphs = 0;
+    stats.drawCalls = 0;
+
+    layout_damage_numbers();
+    drawViewportWidth = viewportWidth;
+    drawViewportHeight = viewportHeight;
+
+    for (int handle = 0; handle < TEXT_MAX_FONTS; handle++) {
+        TextFont* font = &fonts[handle];
+        font->queuedGlyphs = font->glyphCount;
+        font->glyphCount = 0;
+        if (!font->loaded || font->queuedGlyphs == 0) {
+            continue;
+        }
+
+        // Orphan the old storage so the upload doesn't wait on last frame's draw
+        glBindBuffer(GL_ARRAY_BUFFER, font->instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, TEXT_MAX_GLYPHS * sizeof(GlyphInstance), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)font->queuedGlyphs * sizeof(GlyphInstance), font->glyphs);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        RenderItem item = {
+            RENDER_LAYER_OVERLAY,
+            RENDER_BLEND_PREMULTIPLIED,
+            &textShader,
+            font->texture,
+            SAMPLER_LINEAR_CLAMP,
+            font->vao,
+            {0.0f, 0.0f, 0.0f},
+            draw_font_item,
+            font
+        };
+        renderer_submit(&item);
+
+        stats.glyphs += font->queuedGlyphs;
+        stats.drawCalls++;
+    }
+
+    stats.droppedGlyphs = droppedGlyphs;
+    droppedGlyphs = 0;
+}
+
+// Counters for the last text_render
+TextStats text_get_stats(void) {
+    return stats;
+}
+
+// Release the fonts, buffers and shader
+void text_cleanup(void) {
+    for (int handle = 0; handle < TEXT_MAX_FONTS; handle++) {
+        TextFont* font = &fonts[handle];
+        if (!font->loaded) {
+            continue;
+        }
+        gl_state_delete_textures(1, &font->texture);
+        gl_state_delete_vertex_arrays(1, &font->vao);
+        glDeleteBuffers(1, &font->instanceVBO);
+        free(font->glyphs);
+        memset(font, 0, sizeof(*font));
+    }
+
+    if (cornerVBO != 0) {
+        glDeleteBuffers(1, &cornerVBO);
+        cornerVBO = 0;
+    }
+    shader_cleanup(&textShader);
+    damageCount = 0;
+}
@@ -5,6 +5,9 @@
 #include <stdbool.h>
 #include <ctype.h>
 #include "../external/stb/stb_image.h"
+#include "asset_loader.h"
+#include "texture_stream.h"
+#include "gl_state.h"
 #include "logging.h"
 
 // Define this module for logging
@@ -66,99 +69,123 @@ unsigned int texture_load_bmp(const char* path) {
     // Calculate row size (including padding)
     int rowSize = ((infoHeader.width * infoHeader.bitsPerPixel / 8) + 3) & ~3;
     
-    // Allocate memory for the image data
-    unsigned char* data = (unsigned char*)malloc(rowSize * abs(infoHeader.height));
-    if (!data) {
-        LOG("Failed to allocate memory for BMP data: %s", path);
-        fclose(file);
-        return 0;
-    }
+    int width = infoHeader.width;
+    int height = abs(infoHeader.height);
+    size_t imageSize = (size_t)rowSize * height;
     
-    // Seek to the beginning of the pixel data
-    fseek(file, header.dataOffset, SEEK_SET);
-    
-    // Read the pixel data
-    fread(data, rowSize, abs(infoHeader.height), file);
-    fclose(file);
+    // BMP rows are BGR(A) and padded to 4 bytes, which GL_BGR(A) with the
+    // default 4-byte unpack alignment reads as-is: no per-pixel swizzle
+    GLenum format = (infoHeader.bitsPerPixel == 24) ? GL_BGR : GL_BGRA;
+    GLint internalFormat = (infoHeader.bitsPerPixel == 24) ? GL_RGB : GL_RGBA;
     
     // Create OpenGL texture
     unsigned int textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    gl_state_bind_texture(0, textureID);
     
     // Set texture parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, NULL);
     
-    // Convert BGR(A) to RGB(A) and flip vertically
-    int width = infoHeader.width;
-    int height = abs(infoHeader.height);
-    int bytesPerPixel = infoHeader.bitsPerPixel / 8;
-    unsigned char* flippedData = (unsigned char*)malloc(width * height * bytesPerPixel);
+    // Read the rows straight into the upload ring when it has room
+    TextureStreamUpload upload;
+    bool streamed = texture_stream_begin(&upload, imageSize);
+    unsigned char* data = streamed ? upload.pixels : (unsigned char*)malloc(imageSize);
+    if (!data) {
+        LOG("Failed to allocate memory for BMP data: %s", path);
+        gl_state_delete_textures(1, &textureID);
+        fclose(file);
+        return 0;
+    }
     
+    // Seek to the beginning of the pixel data
+    fseek(file, header.dataOffset, SEEK_SET);
+    
+    // Bottom-up files (positive height) are flipped to the top-down row order
+    // the other loaders produce by reading each row into its mirrored slot
+    bool bottomUp = infoHeader.height > 0;
     for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int srcIndex = y * rowSize + x * bytesPerPixel;
-            int destIndex = (height - 1 - y) * width * bytesPerPixel + x * bytesPerPixel;
-            
-            // Swap BGR to RGB
-            flippedData[destIndex + 0] = data[srcIndex + 2]; // R
-            flippedData[destIndex + 1] = data[srcIndex + 1]; // G
-            flippedData[destIndex + 2] = data[srcIndex + 0]; // B
-            
-            // Copy alpha channel if present
-            if (bytesPerPixel == 4) {
-                flippedData[destIndex + 3] = data[srcIndex + 3]; // A
-            }
-        }
+        int row = bottomUp ? height - 1 - y : y;
+        fread(data + (size_t)row * rowSize, rowSize, 1, file);
     }
+    fclose(file);
     
     // Upload texture data
-    GLenum format = (bytesPerPixel == 3) ? GL_RGB : GL_RGBA;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, flippedData);
+    if (streamed) {
+        texture_stream_end(&upload, 0, width, height, format, GL_UNSIGNED_BYTE);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+        free(data);
+    }
     glGenerateMipmap(GL_TEXTURE_2D);
     
-    // Free memory
-    free(data);
-    free(flippedData);
-    
     return textureID;
 }
 
 // Add this function to print texture info
 void texture_print_info(unsigned int textureID) {
     int width, height;
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    gl_state_bind_texture(0, textureID);
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
     
     LOG("Texture ID: %u, Width: %d, Height: %d", textureID, width, height);
 }
 
+// Decode an image to premultiplied RGBA8 (no GL calls, safe on any thread)
+static unsigned char* decode_premultiplied(const char* path, int* width, int* height) {
+    // Always expand to RGBA, which is what gets uploaded
+    int nrChannels;
+    unsigned char* data = stbi_load(path, width, height, &nrChannels, 4);
+    if (!data) {
+        return NULL;
+    }
+    
+    // Premultiply alpha to match the sprite atlas and the renderer's blend mode
+    for (size_t i = 0; i < (size_t)*width * *height; i++) {
+        unsigned int alpha = data[i * 4 + 3];
+        data[i * 4 + 0] = (unsigned char)((data[i * 4 + 0] * alpha + 127) / 255);
+        data[i * 4 + 1] = (unsigned char)((data[i * 4 + 1] * alpha + 127) / 255);
+        data[i * 4 + 2] = (unsigned char)((data[i * 4 + 2] * alpha + 127) / 255);
+    }
+    return data;
+}
+
+// Default sampling for loaded textures; callers may override it after loading
+static void set_default_parameters(void) {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+// Upload RGBA8 pixels as level 0 of textureID and build its mips
+static void upload_rgba(unsigned int textureID, int width, int height, const unsigned char* data) {
+    gl_state_bind_texture(0, textureID);
+    texture_stream_image(0, GL_RGBA, width, height, GL_RGBA, data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    gl_state_bind_texture(0, 0);
+}
+
 // Function to load a PNG texture
 unsigned int texture_load_png(const char* path) {
     LOG("Loading PNG texture: %s", path);
     
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
+    int width, height;
+    unsigned char* data = decode_premultiplied(path, &width, &height);
     
     if (data) {
         // Create OpenGL texture
         unsigned int textureID;
         glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        
-        // Set texture parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gl_state_bind_texture(0, textureID);
+        set_default_parameters();
         
         // Upload texture data
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        upload_rgba(textureID, width, height, data);
         
         // Free image data
         stbi_image_free(data);
@@ -176,7 +203,7 @@ unsigned int texture_load_png(const char* path) {
 unsigned int create_test_texture() {
     unsigned int textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    gl_state_bind_texture(0, textureID);
     
     // Create a 64x64 checkerboard texture with more vibrant colors
     unsigned char checkerboard[64 * 64 * 4];
@@ -260,7 +287,7 @@ unsigned int texture_load(const char* path) {
         // Create OpenGL texture
         unsigned int textureID;
         glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        gl_state_bind_texture(0, textureID);
         
         // Set texture parameters
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -283,7 +310,7 @@ unsigned int texture_load(const char* path) {
         }
         
         // Upload texture data
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        texture_stream_image(0, format, width, height, format, data);
         glGenerateMipmap(GL_TEXTURE_2D);
         
         // Free image data
@@ -292,3 +319,278 @@ unsigned int texture_load(const char* path) {
         return textureID;
     }
 }
+
+// One cached file. An empty path marks a free slot; a tombstone keeps probe
+// chains intact after a release.
+typedef struct {
+    char* path;
+    unsigned int pathHash;
+    unsigned int textureID;
+    int refCount;
+    long long bytes;
+    bool tombstone;
+    AssetState state;          // LOADING until an async decode has been uploaded
+} TextureCacheEntry;
+
+static TextureCacheEntry textureCache[TEXTURE_CACHE_SIZE];
+static TextureStats textureStats;
+
+// Pixels decoded on a worker for one cache entry
+typedef struct {
+    TextureCacheEntry* entry;
+    char* path;
+    unsigned char* pixels;
+    int width;
+    int height;
+} TextureDecode;
+
+// FNV-1a hash of a path
+static unsigned int hash_path(const char* path) {
+    unsigned int hash = 2166136261u;
+    while (*path) {
+        hash ^= (unsigned char)*path++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// VRAM of a texture's level 0 and every mip level below it (RGBA8)
+static long long texture_resident_bytes(unsigned int textureID) {
+    GLint width = 0, height = 0, maxLevel = 0;
+    GLint minFilter = GL_LINEAR;
+    gl_state_bind_texture(0, textureID);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &minFilter);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+    gl_state_bind_texture(0, 0);
+    
+    bool mipmapped = minFilter != GL_LINEAR && minFilter != GL_NEAREST;
+    long long bytes = 0;
+    for (int level = 0; level <= maxLevel; level++) {
+        bytes += (long long)width * height * 4;
+        if (!mipmapped || (width == 1 && height == 1)) {
+            break;
+        }
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return bytes;
+}
+
+// Find path in the cache. Returns its entry, or NULL with *freeSlot set to
+// the slot a new entry should take (-1 if the cache is full).
+static TextureCacheEntry* find_entry(const char* path, unsigned int hash, int* freeSlot) {
+    *freeSlot = -1;
+    
+    for (int probe = 0; probe < TEXTURE_CACHE_SIZE; probe++) {
+        int slot = (int)((hash + (unsigned int)probe) & (TEXTURE_CACHE_SIZE - 1));
+        TextureCacheEntry* entry = &textureCache[slot];
+        
+        if (entry->path == NULL) {
+            if (*freeSlot < 0) {
+                *freeSlot = slot;
+            }
+            if (!entry->tombstone) {
+                break;
+            }
+            continue;
+        }
+        
+        if (entry->pathHash == hash && strcmp(entry->path, path) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Fill a free slot for path
+static TextureCacheEntry* insert_entry(int slot, const char* path, unsigned int hash, unsigned int textureID) {
+    TextureCacheEntry* entry = &textureCache[slot];
+    size_t length = strlen(path) + 1;
+    entry->path = (char*)malloc(length);
+    memcpy(entry->path, path, length);
+    entry->pathHash = hash;
+    entry->textureID = textureID;
+    entry->refCount = 1;
+    entry->bytes = 0;
+    entry->tombstone = false;
+    entry->state = ASSET_STATE_READY;
+    
+    textureStats.cachedTextures++;
+    textureStats.references++;
+    textureStats.loads++;
+    return entry;
+}
+
+// Delete an unreferenced entry's texture and free its slot
+static void evict_entry(TextureCacheEntry* entry) {
+    LOG("Releasing texture %s (ID: %u)", entry->path, entry->textureID);
+    gl_state_delete_textures(1, &entry->textureID);
+    textureStats.cachedTextures--;
+    textureStats.residentBytes -= entry->bytes;
+    
+    free(entry->path);
+    memset(entry, 0, sizeof(*entry));
+    entry->tombstone = true;
+}
+
+// Take one more reference on a cached entry
+static unsigned int reference_entry(TextureCacheEntry* entry) {
+    entry->refCount++;
+    textureStats.references++;
+    textureStats.hits++;
+    return entry->textureID;
+}
+
+// Load a texture once per path and return it with one more reference
+unsigned int texture_acquire(const char* path) {
+    unsigned int hash = hash_path(path);
+    int freeSlot;
+    TextureCacheEntry* entry = find_entry(path, hash, &freeSlot);
+    if (entry) {
+        return reference_entry(entry);
+    }
+    
+    if (freeSlot < 0) {
+        printf("ERROR: Texture cache full, cannot load %s\n", path);
+        return 0;
+    }
+    
+    unsigned int textureID = texture_load(path);
+    if (textureID == 0) {
+        return 0;
+    }
+    
+    entry = insert_entry(freeSlot, path, hash, textureID);
+    entry->bytes = texture_resident_bytes(textureID);
+    textureStats.residentBytes += entry->bytes;
+    
+    LOG("Cached texture %s (ID: %u, %lld bytes)", path, textureID, entry->bytes);
+    return textureID;
+}
+
+// Worker side of texture_acquire_async
+static bool decode_texture(void* payload) {
+    TextureDecode* decode = (TextureDecode*)payload;
+    decode->pixels = decode_premultiplied(decode->path, &decode->width, &decode->height);
+    return decode->pixels != NULL;
+}
+
+// GL side of texture_acquire_async: replace the placeholder with the image
+static bool upload_texture(void* payload, bool decoded) {
+    TextureDecode* decode = (TextureDecode*)payload;
+    TextureCacheEntry* entry = decode->entry;
+    
+    if (decoded) {
+        upload_rgba(entry->textureID, decode->width, decode->height, decode->pixels);
+        stbi_image_free(decode->pixels);
+        
+        textureStats.residentBytes -= entry->bytes;
+        entry->bytes = texture_resident_bytes(entry->textureID);
+        textureStats.residentBytes += entry->bytes;
+        LOG("Cached texture %s (ID: %u, %lld bytes)", entry->path, entry->textureID, entry->bytes);
+    } else {
+        LOG("Failed to load texture: %s", decode->path);
+    }
+    entry->state = decoded ? ASSET_STATE_READY : ASSET_STATE_FAILED;
+    
+    // Every reference was dropped while the decode was in flight
+    if (entry->refCount == 0) {
+        evict_entry(entry);
+    }
+    
+    free(decode->path);
+    free(decode);
+    return decoded;
+}
+
+// Start loading a texture on the job system and return its name right away
+unsigned int texture_acquire_async(const char* path) {
+    unsigned int hash = hash_path(path);
+    int freeSlot;
+    TextureCacheEntry* entry = find_entry(path, hash, &freeSlot);
+    if (entry) {
+        return reference_entry(entry);
+    }
+    
+    if (freeSlot < 0) {
+        printf("ERROR: Texture cache full, cannot load %s\n", path);
+        return 0;
+    }
+    
+    // Transparent 1x1 placeholder: the name is usable (and draws nothing)
+    // until the decoded image replaces it
+    static const unsigned char transparent[4] = {0, 0, 0, 0};
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    gl_state_bind_texture(0, textureID);
+    set_default_parameters();
+    upload_rgba(textureID, 1, 1, transparent);
+    
+    entry = insert_entry(freeSlot, path, hash, textureID);
+    entry->bytes = texture_resident_bytes(textureID);
+    textureStats.residentBytes += entry->bytes;
+    
+    TextureDecode* decode = (TextureDecode*)calloc(1, sizeof(TextureDecode));
+    decode->entry = entry;
+    size_t length = strlen(path) + 1;
+    decode->path = (char*)malloc(length);
+    memcpy(decode->path, path, length);
+    asset_loader_submit(decode_texture, upload_texture, decode, &entry->state);
+    
+    return textureID;
+}
+
+// Load state of a texture returned by texture_acquire or texture_acquire_async
+AssetState texture_get_state(unsigned int textureID) {
+    if (textureID == 0) {
+        return ASSET_STATE_FAILED;
+    }
+    
+    for (int slot = 0; slot < TEXTURE_CACHE_SIZE; slot++) {
+        if (textureCache[slot].path != NULL && textureCache[slot].textureID == textureID) {
+            return textureCache[slot].state;
+        }
+    }
+    return ASSET_STATE_READY;
+}
+
+// Drop a reference taken by texture_acquire
+void texture_release(unsigned int textureID) {
+    if (textureID == 0) {
+        return;
+    }
+    
+    for (int slot = 0; slot < TEXTURE_CACHE_SIZE; slot++) {
+        TextureCacheEntry* entry = &textureCache[slot];
+        if (entry->path == NULL || entry->textureID != textureID) {
+            continue;
+        }
+        
+        textureStats.references--;
+        if (--entry->refCount > 0) {
+            return;
+        }
+        
+        // A decode still points at this entry; its upload evicts it
+        if (entry->state == ASSET_STATE_LOADING) {
+            return;
+        }
+        
+        evict_entry(entry);
+        return;
+    }
+    
+    LOG("Warning: texture_release on uncached texture %u", textureID);
+}
+
+// Add VRAM used by textures created outside the cache to the resident total
+void texture_account_bytes(long long delta) {
+    textureStats.residentBytes += delta;
+}
+
+// Current cache counters
+TextureStats texture_get_stats(void) {
+    return textureStats;
+}
@@ -3,6 +3,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "../external/stb/stb_image.h"
 #include <glad/glad.h> // For OpenGL functions
+#include "gl_state.h"
 
 unsigned int load_texture(const char* filepath) {
     unsigned int textureID;
@@ -20,7 +21,7 @@ unsigned int load_texture(const char* filepath) {
         else if (nrChannels == 4)
             format = GL_RGBA;
         
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        gl_state_bind_texture(0, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
         
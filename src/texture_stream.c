@@ -0,0 +1,174 @@
+#include "texture_stream.h"
+#include <string.h>
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Offsets handed out are multiples of this (covers every pixel format's alignment)
+#define TEXTURE_STREAM_ALIGNMENT 64
+
+// Longest a begin waits on one old upload before giving up on the ring
+#define TEXTURE_STREAM_WAIT_NS 100000000ull
+
+// Ring range the GPU may still be reading, released when its fence signals
+typedef struct {
+    size_t offset;
+    size_t size;
+    GLsync fence;
+} StreamRegion;
+
+static unsigned int streamPBO = 0;
+static size_t streamHead = 0;
+static StreamRegion inFlight[TEXTURE_STREAM_MAX_IN_FLIGHT];
+static int inFlightFirst = 0;
+static int inFlightCount = 0;
+
+// Create the ring on first use
+static void ensure_ring(void) {
+    if (streamPBO != 0) {
+        return;
+    }
+    glGenBuffers(1, &streamPBO);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamPBO);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, TEXTURE_STREAM_RING_BYTES, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// Drop the oldest in-flight region, waiting for its fence if wait is set.
+// Returns false if it is still in use.
+static bool retire_oldest(bool wait) {
+    StreamRegion* region = &inFlight[inFlightFirst];
+    GLenum status = glClientWaitSync(region->fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                     wait ? TEXTURE_STREAM_WAIT_NS : 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+
+    glDeleteSync(region->fence);
+    inFlightFirst = (inFlightFirst + 1) & (TEXTURE_STREAM_MAX_IN_FLIGHT - 1);
+    inFlightCount--;
+    return true;
+}
+
+// True if [offset, offset + size) overlaps any in-flight region
+static bool overlaps_in_flight(size_t offset, size_t size) {
+    for (int i = 0; i < inFlightCount; i++) {
+        const StreamRegion* region = &inFlight[(inFlightFirst + i) & (TEXTURE_STREAM_MAX_IN_FLIGHT - 1)];
+        if (offset < region->offset + region->size && region->offset < offset + size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Map size bytes of the ring for writing
+bool texture_stream_begin(TextureStreamUpload* upload, size_t size) {
+    size = (size + TEXTURE_STREAM_ALIGNMENT - 1) & ~(size_t)(TEXTURE_STREAM_ALIGNMENT - 1);
+    if (size > TEXTURE_STREAM_RING_BYTES) {
+        return false;
+    }
+    ensure_ring();
+
+    // Release whatever the GPU has already consumed without blocking
+    while (inFlightCount > 0 && retire_oldest(false)) {
+    }
+
+    size_t offset = streamHead;
+    if (offset + size > TEXTURE_STREAM_RING_BYTES) {
+        offset = 0;
+    }
+
+    // Regions retire in submission order, oldest first, until the range is free
+    while (inFlightCount > 0 && (overlaps_in_flight(offset, size) || inFlightCount == TEXTURE_STREAM_MAX_IN_FLIGHT)) {
+        if (!retire_oldest(true)) {
+            LOG("Texture stream ring still busy, uploading directly");
+            return false;
+        }
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamPBO);
+    // Fences already guarantee the GPU is done with this range
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, (GLintptr)offset, (GLsizeiptr)size,
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    upload->pixels = (unsigned char*)mapped;
+    upload->offset = offset;
+    upload->size = size;
+    streamHead = offset + size;
+    return true;
+}
+
+// Unmap the region and copy it into the bound texture asynchronously
+void texture_stream_end(TextureStreamUpload* upload, int level, int width, int height,
+                        GLenum format, GLenum type) {
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // With an unpack buffer bound the pointer is an offset into it
+    glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, type,
+                    (const void*)(size_t)upload->offset);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    int slot = (inFlightFirst + inFlightCount) & (TEXTURE_STREAM_MAX_IN_FLIGHT - 1);
+    inFlight[slot].offset = upload->offset;
+    inFlight[slot].size = upload->size;
+    inFlight[slot].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    inFlightCount++;
+
+    upload->pixels = NULL;
+}
+
+// Bytes per pixel of the unsigned-byte formats the engine uploads
+static int bytes_per_pixel(GLenum format) {
+    switch (format) {
+        case GL_RED:  return 1;
+        case GL_RG:   return 2;
+        case GL_RGB:
+        case GL_BGR:  return 3;
+        default:      return 4;
+    }
+}
+
+// Allocate level of the bound texture and stream pixels into it
+void texture_stream_image(int level, GLint internalFormat, int width, int height,
+                          GLenum format, const unsigned char* pixels) {
+    size_t size = (size_t)width * height * bytes_per_pixel(format);
+
+    // Rows are tightly packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Allocate before the ring is bound, or NULL would read as offset 0 into it
+    glTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, NULL);
+
+    TextureStreamUpload upload;
+    if (pixels && texture_stream_begin(&upload, size)) {
+        memcpy(upload.pixels, pixels, size);
+        texture_stream_end(&upload, level, width, height, format, GL_UNSIGNED_BYTE);
+    } else if (pixels) {
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+// Wait for in-flight uploads and delete the ring
+void texture_stream_cleanup(void) {
+    while (inFlightCount > 0) {
+        if (!retire_oldest(true)) {
+            // Give up on a stuck fence rather than hang on exit
+            glDeleteSync(inFlight[inFlightFirst].fence);
+            inFlightFirst = (inFlightFirst + 1) & (TEXTURE_STREAM_MAX_IN_FLIGHT - 1);
+            inFlightCount--;
+        }
+    }
+
+    if (streamPBO != 0) {
+        glDeleteBuffers(1, &streamPBO);
+        streamPBO = 0;
+    }
+    streamHead = 0;
+}
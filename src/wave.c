@@ -0,0 +1,113 @@
+#include "wave.h"
+#include "enemy.h"
+#include "physics.h"
+#include <stdlib.h>
+#include "logging.h"
+
+// Define this module for logging
+LOG_MODULE_DEFINE(__FILE__, false);
+
+// Wave size and pacing
+#define WAVE_BASE_ENEMIES 5
+#define WAVE_ENEMIES_PER_WAVE 2
+#define WAVE_BATCH_SIZE 3
+#define WAVE_FIRST_BATCH_DELAY 0.5f
+#define WAVE_BATCH_INTERVAL 1.0f
+#define WAVE_COOLDOWN 5.0f
+
+// Reset to "no wave started yet"
+void wave_init(WaveState* wave) {
+    wave->waveNumber = 0;
+    wave->enemiesRemainingInWave = 0;
+    wave->spawnTimer = 0.0f;
+    wave->cooldown = 0.0f;
+    wave->inProgress = false;
+}
+
+// Random point on the arena border
+static void random_edge_position(float* x, float* z) {
+    // Choose a random edge (0=top, 1=right, 2=bottom, 3=left)
+    int edge = rand() % 4;
+    float gridSize = WAVE_ARENA_HALF_SIZE;
+    
+    switch (edge) {
+        case 0: // Top edge
+            *x = ((float)rand() / RAND_MAX) * (gridSize * 2) - gridSize;
+            *z = -gridSize;
+            break;
+        case 1: // Right edge
+            *x = gridSize;
+            *z = ((float)rand() / RAND_MAX) * (gridSize * 2) - gridSize;
+            break;
+        case 2: // Bottom edge
+            *x = ((float)rand() / RAND_MAX) * (gridSize * 2) - gridSize;
+            *z = gridSize;
+            break;
+        default: // Left edge
+            *x = -gridSize;
+            *z = ((float)rand() / RAND_MAX) * (gridSize * 2) - gridSize;
+            break;
+    }
+}
+
+// Advance timers, start/spawn/finish waves. Returns the number of enemies spawned
+int wave_update(WaveState* wave, bool startRequested, float deltaTime) {
+    int spawned = 0;
+    
+    // Update wave timers
+    if (wave->cooldown > 0.0f) {
+        wave->cooldown -= deltaTime;
+    }
+    
+    if (wave->spawnTimer > 0.0f) {
+        wave->spawnTimer -= deltaTime;
+    }
+    
+    // Check if we should start a new wave
+    if (startRequested && wave->cooldown <= 0.0f && !wave->inProgress) {
+        wave->waveNumber++;
+        wave->inProgress = true;
+        
+        // Number of enemies grows with every wave
+        wave->enemiesRemainingInWave = WAVE_BASE_ENEMIES +
+                                       (wave->waveNumber - 1) * WAVE_ENEMIES_PER_WAVE;
+        
+        // Set spawn timer for first batch
+        wave->spawnTimer = WAVE_FIRST_BATCH_DELAY;
+        
+        LOG("Starting Wave %d with %d enemies!", wave->waveNumber, wave->enemiesRemainingInWave);
+    }
+    
+    // Spawn enemies in batches during a wave
+    if (wave->inProgress && wave->spawnTimer <= 0.0f && wave->enemiesRemainingInWave > 0) {
+        int batchSize = WAVE_BATCH_SIZE;
+        if (batchSize > wave->enemiesRemainingInWave) {
+            batchSize = wave->enemiesRemainingInWave;
+        }
+        
+        // Spawn a batch of enemies from random edges of the grid
+        for (int i = 0; i < batchSize; i++) {
+            float enemyX, enemyZ;
+            random_edge_position(&enemyX, &enemyZ);
+            spawn_enemy(enemyX, GROUND_LEVEL, enemyZ);
+            wave->enemiesRemainingInWave--;
+            spawned++;
+        }
+        
+        // Set timer for next batch
+        wave->spawnTimer = WAVE_BATCH_INTERVAL;
+        
+        LOG("Spawned %d enemies. %d remaining in wave %d",
+            batchSize, wave->enemiesRemainingInWave, wave->waveNumber);
+    }
+    
+    // Check if wave is complete
+    if (wave->inProgress && wave->enemiesRemainingInWave <= 0 && get_enemy_count() == 0) {
+        wave->inProgress = false;
+        wave->cooldown = WAVE_COOLDOWN;
+        LOG("Wave %d complete! Next wave available in %.1f seconds",
+            wave->waveNumber, wave->cooldown);
+    }
+    
+    return spawned;
+}
@@ -10,8 +10,18 @@
 #include "texture.h"
 #include "../external/stb/stb_image.h"
 #include "character_animation.h"
-#include "projectile.h"
+#include "projectile_render.h"
 #include "enemy.h"
+#include "enemy_render.h"
+#include "frame_uniforms.h"
+#include "renderer.h"
+#include "culling.h"
+#include "gl_state.h"
+#include "sampler.h"
+#include "particles.h"
+#include "text.h"
+#include "sim.h"
+#include "profiler.h"
 #include "logging.h"
 
 // Define this module for logging
@@ -35,18 +45,6 @@ static unsigned int gridVAO = 0;
 static unsigned int gridVBO = 0;
 static int gridVertexCount = 0;
 
-// Add these variables to track movement direction
-static float playerDirection = 0.0f; // Angle in radians (0 = facing +Z)
-static vec3 lastMovement = {0.0f, 0.0f, 0.0f};
-
-// Add these constants for physics
-static const float GRAVITY = 0.008f;
-static const float JUMP_FORCE = 0.12f;
-static const float GROUND_LEVEL = 0.5f;
-
-// Add these variables for timing
-static double lastFrameTime = 0.0;
-
 // Camera smoothing variables
 static vec3 cameraTargetPosition = {0.0f, 0.0f, 0.0f};
 static float cameraSmoothSpeed = 5.0f; // Adjust this to control smoothing speed
@@ -72,26 +70,18 @@ static bool debugControllerOnce = false;
 // Add this at the top of the file with other global variables
 static int debugCounter = 0;
 
-// Add this global variable
-static float attackFlashTimer = 0.0f;
-
-// Add these variables at the top of world.c for wave management
-static int waveNumber = 0;
-static int enemiesRemainingInWave = 0;
-static float waveSpawnTimer = 0.0f;
-static float waveCooldown = 0.0f;
-static bool waveInProgress = false;
-
-// Add these function declarations at the top
-void set_projectile_orbit_mode(bool enabled);
-void update_orbit_center(float x, float z);
+// Font of the HUD and the damage numbers (-1 if it failed to load)
+static int hudFont = -1;
 
 // Function to initialize the game world
 void initWorld(GLFWwindow* win) {
     // Store the window pointer
     window = win;
     
-    // Initialize shaders
+    // Initialize shaders and the per-frame uniform buffer they share
+    frame_uniforms_init();
+    renderer_init();
+    sampler_init();
     shader_init(&shader, "assets/shaders/basic.vert", "assets/shaders/basic.frag");
     shader_init(&spriteShader, "assets/shaders/sprite.vert", "assets/shaders/sprite.frag");
     
@@ -99,14 +89,11 @@ void initWorld(GLFWwindow* win) {
     character_init(&player, 0.0f, GROUND_LEVEL, 0.0f);
     
     // Enable depth testing
-    glEnable(GL_DEPTH_TEST);
-    
-    // Enable alpha blending
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gl_state_set_enabled(GL_DEPTH_TEST, true);
     
-    // Initialize timing
-    lastFrameTime = glfwGetTime();
+    // Enable alpha blending (sprite textures are premultiplied)
+    gl_state_set_enabled(GL_BLEND, true);
+    gl_state_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     
     // Ensure viewport covers the entire window
     int width, height;
@@ -114,7 +101,7 @@ void initWorld(GLFWwindow* win) {
     glViewport(0, 0, width, height);
     
     // Disable scissor test which might be causing the line
-    glDisable(GL_SCISSOR_TEST);
+    gl_state_set_enabled(GL_SCISSOR_TEST, false);
     
     // Debug OpenGL state after initialization
     LOG("After initialization:");
@@ -125,151 +112,151 @@ void initWorld(GLFWwindow* win) {
     glGetBooleanv(GL_SCISSOR_TEST, &scissorEnabled);
     if (scissorEnabled) {
         LOG("Disabling scissor test that was enabled by default");
-        glDisable(GL_SCISSOR_TEST);
+        gl_state_set_enabled(GL_SCISSOR_TEST, false);
     }
     
-    // Initialize projectile system
-    projectile_system_init();
-    enemy_system_init();
+    // Initialize the simulation and the GL resources used to draw it
+    sim_init();
+    projectile_render_init();
+    enemy_render_init();
+    particles_init(PARTICLES_DEFAULT_CAPACITY);
+    text_init();
+    hudFont = text_font_load("assets/fonts/hud.ttf", 32.0f);
 
     // Spawn a test enemy at a fixed position
     spawn_enemy(2.0f, GROUND_LEVEL, 2.0f);
     LOG("Spawned test enemy at (2.0, %.2f, 2.0)", GROUND_LEVEL);
 }
 
-// Function to update the game world
-void updateWorld() {
-    // Calculate delta time
-    double currentTime = glfwGetTime();
-    float deltaTime = (float)(currentTime - lastFrameTime);
-    lastFrameTime = currentTime;
+// Copy the simulated player into the render-side character
+static void sync_player_from_sim(void) {
+    const SimPlayer* simPlayer = sim_get_player();
+    player.x = simPlayer->body.x;
+    player.y = simPlayer->body.y;
+    player.z = simPlayer->body.z;
+    player.velocityY = simPlayer->body.velocityY;
+    player.isGrounded = simPlayer->body.isGrounded;
+    player.attackCooldown = simPlayer->attackCooldown;
+    player.isMoving = simPlayer->isMoving;
+    player.isAttacking = simPlayer->attack != SIM_ATTACK_NONE;
+    player.animator.facingRight = simPlayer->facingRight;
+}
+
+// Decode the controller into simulation commands
+static SimInput read_sim_input(void) {
+    SimInput input = {0};
     
     // Get controller input
     int count;
     const float* axes = getControllerAxes(&count);
     float deadzone = 0.1f;
-    float controllerMoveSpeed = 0.03f;
     
-    // Determine if player is moving
-    bool isMoving = false;
     if (count >= 2 && (fabs(axes[0]) > deadzone || fabs(axes[1]) > deadzone)) {
-        // Update position
-        player.x += axes[0] * controllerMoveSpeed;
-        player.z += axes[1] * controllerMoveSpeed;
-        
-        // Calculate the angle
-        playerDirection = atan2f(axes[1], axes[0]);
-        
-        // Set facing direction
-        player.animator.facingRight = (axes[0] > 0);
-        
-        isMoving = true;
+        input.moveX = axes[0];
+        input.moveZ = axes[1];
     }
     
-    // Handle jumping
-    bool isJumping = false;
-    if (player.isGrounded) {
-        // Check for jump button press - only use Cross (X) for jumping, not Square
-        if (isButtonPressed(BUTTON_CROSS)) {
-            player.velocityY = JUMP_FORCE;
-            player.isGrounded = false;
-            isJumping = true;
-        }
-    } else {
-        // Apply gravity and update vertical position
-        player.velocityY -= GRAVITY;
-        
-        // Update player's Y position
-        float newY = player.y + player.velocityY;
-        
-        // Check if landed
-        if (newY <= GROUND_LEVEL) {
-            player.y = GROUND_LEVEL;
-            player.velocityY = 0.0f;
-            player.isGrounded = true;
-        } else {
-            // Only update if we haven't landed
-            player.y = newY;
-            isJumping = true;
-        }
-    }
+    // Only use Cross (X) for jumping, not Square
+    input.jump = isButtonPressed(BUTTON_CROSS);
     
-    // Check for attack buttons
-    bool isAttacking = false;
+    // Primary attack (Square or Circle), secondary attack (Triangle)
+    input.attack = isButtonPressed(BUTTON_SQUARE) || isButtonPressed(BUTTON_CIRCLE);
+    input.spinAttack = isButtonPressed(BUTTON_TRIANGLE);
+    
+    // Start a wave on the L1 press edge
+    static bool l1WasPressed = false;
+    bool l1IsPressed = isButtonPressed(BUTTON_L1);
+    input.startWave = l1IsPressed && !l1WasPressed;
+    l1WasPressed = l1IsPressed;
+    
+    return input;
+}
 
-    // Update attack cooldown
-    if (player.attackCooldown > 0) {
-        player.attackCooldown -= deltaTime;
+// Wave counter and status in the top-left corner
+static void draw_hud(void) {
+    const WaveState* waves = sim_get_waves();
+    vec4 white = {1.0f, 1.0f, 1.0f, 1.0f};
+    vec4 dim = {0.8f, 0.85f, 0.85f, 0.9f};
+    char line[64];
+    
+    snprintf(line, sizeof(line), "Wave %d", waves->waveNumber);
+    text_draw_screen(hudFont, 16.0f, 12.0f, 32.0f, white, line);
+    
+    if (waves->inProgress) {
+        snprintf(line, sizeof(line), "Enemies: %d", get_enemy_count() + waves->enemiesRemainingInWave);
+    } else if (waves->cooldown > 0.0f) {
+        snprintf(line, sizeof(line), "Next wave in %.1f s", waves->cooldown);
+    } else {
+        snprintf(line, sizeof(line), "Press L1 to start wave %d", waves->waveNumber + 1);
     }
+    text_draw_screen(hudFont, 16.0f, 48.0f, 22.0f, dim, line);
+}
 
-    // Only check for attacks if cooldown is done
-    if (player.attackCooldown <= 0) {
-        // Primary attack (Square or Circle)
-        if (isButtonPressed(BUTTON_SQUARE) || isButtonPressed(BUTTON_CIRCLE)) {
-            isAttacking = true;
-            player.attackCooldown = 0.5f; // Set cooldown time
-            LOG("Attack triggered! Button: %s", 
-                   isButtonPressed(BUTTON_SQUARE) ? "Square" : "Circle");
-        }
-        // Secondary attack (Triangle)
-        else if (isButtonPressed(BUTTON_TRIANGLE)) {
-            isAttacking = true;
-            player.attackCooldown = 0.5f; // Set cooldown time
-            LOG("Spinning dagger attack triggered!");
-            
-            // Enable orbit mode for projectiles
-            set_projectile_orbit_mode(true);
-            
-            // Spawn spinning daggers around the player
-            float orbitLifetime = 5.0f; // Longer lifetime for orbit mode
-            float spawnHeight = player.y + 0.3f;
-            
-            // Spawn the orbiting daggers (direction doesn't matter in orbit mode)
-            spawn_projectile(player.x, spawnHeight, player.z, 0.0f, 0.0f, 0.0f, orbitLifetime);
+// Start the particle effects for what happened during the last tick
+static void emit_sim_events(void) {
+    int count;
+    const SimEvent* events = sim_events_get(&count);
+    
+    for (int i = 0; i < count; i++) {
+        const SimEvent* event = &events[i];
+        vec3 position = {event->x, event->y, event->z};
+        
+        switch (event->type) {
+            case SIM_EVENT_ENEMY_HIT:
+                particles_emit(PARTICLE_EFFECT_HIT, position, (vec3){0.0f, 1.0f, 0.0f});
+                text_spawn_damage(hudFont, (vec3){event->x, event->y + 0.3f, event->z}, event->value);
+                break;
+            case SIM_EVENT_ENEMY_KILLED:
+                particles_emit(PARTICLE_EFFECT_DEATH, position, NULL);
+                break;
+            case SIM_EVENT_SWORD_SLASH:
+                // Sparks fly forward from in front of the player
+                position[0] += event->value * 0.3f;
+                particles_emit(PARTICLE_EFFECT_SLASH, position, (vec3){event->value, 0.25f, 0.0f});
+                break;
+            case SIM_EVENT_SPIN_ATTACK:
+                particles_emit(PARTICLE_EFFECT_SPIN, position, NULL);
+                break;
+            case SIM_EVENT_TYPE_COUNT:
+                break;
         }
     }
+}
+
+// Function to advance the game world by one fixed simulation step
+void updateWorld(float deltaTime) {
+    // Start the simulation tick; its parallel part runs while we animate below
+    SimInput input;
+    PROFILE_SCOPE("updateWorld.input") input = read_sim_input();
+    sim_tick_begin(&input, deltaTime);
+    PROFILE_BEGIN("updateWorld.animate");
+    
+    const SimPlayer* simPlayer = sim_get_player();
+    sync_player_from_sim();
     
     // Determine character state
     CharacterState newState;
     
-    if (isAttacking) {
-        // Check which attack button was pressed
-        if (isButtonPressed(BUTTON_TRIANGLE)) {
-            // For Triangle (projectile attack), don't change animation state
-            // Just keep the current state (idle, run, or jump)
-            if (isJumping) {
-                newState = CHARACTER_STATE_JUMP;
-            } else if (isMoving) {
-                newState = CHARACTER_STATE_RUN;
-            } else {
-                newState = CHARACTER_STATE_IDLE;
-            }
-            
-            // We could also add a special projectile casting animation state here
-            // newState = CHARACTER_STATE_CAST;
+    if (simPlayer->attack == SIM_ATTACK_SWORD) {
+        // Sword attack uses the attack animation
+        if (!simPlayer->body.isGrounded) {
+            newState = CHARACTER_STATE_AIR_ATTACK;
+            LOG("Air attack triggered!");
         } else {
-            // For other attack buttons (sword attack), use attack animation
-            if (!player.isGrounded) {
-                newState = CHARACTER_STATE_AIR_ATTACK;
-                LOG("Air attack triggered!");
-            } else {
-                newState = CHARACTER_STATE_ATTACK;
-            }
+            newState = CHARACTER_STATE_ATTACK;
         }
-    } else if (isJumping) {
+    } else if (simPlayer->isJumping) {
+        // The spinning dagger attack keeps the current movement animation
         newState = CHARACTER_STATE_JUMP;
-    } else if (isMoving) {
+    } else if (simPlayer->isMoving) {
         newState = CHARACTER_STATE_RUN;
     } else {
         newState = CHARACTER_STATE_IDLE;
     }
     
-    // Update character animator
+    // Update character animator (main thread, overlaps the simulation jobs)
     character_animator_update(&player.animator, newState, deltaTime);
 
-    // Update projectiles
-    update_projectiles(deltaTime);
-
     // Camera mode switching
     static bool dpadUpWasPressed = false;
     bool dpadUpIsPressed = isButtonPressed(BUTTON_DPAD_UP);
@@ -282,143 +269,25 @@ void updateWorld() {
 
     // Update previous state
     dpadUpWasPressed = dpadUpIsPressed;
+    PROFILE_END();
 
-    // Update the orbit center to follow the player
-    update_orbit_center(player.x, player.z);
-
-    // Update enemies
-    update_enemies(deltaTime, player.x, player.z);
-
-    // Check for collisions between enemies and projectiles
-    check_enemy_projectile_collisions();
-
-    // Update wave timers
-    if (waveCooldown > 0.0f) {
-        waveCooldown -= deltaTime;
-    }
-
-    if (waveSpawnTimer > 0.0f) {
-        waveSpawnTimer -= deltaTime;
-    }
-
-    // Check if we should start a new wave
-    static bool l1WasPressed = false;
-    bool l1IsPressed = isButtonPressed(BUTTON_L1);
-
-    if (l1IsPressed && !l1WasPressed && waveCooldown <= 0.0f && !waveInProgress) {
-        // Start a new wave
-        waveNumber++;
-        waveInProgress = true;
-        
-        // Calculate number of enemies based on wave number
-        int baseEnemies = 5;
-        int enemiesPerWave = baseEnemies + (waveNumber - 1) * 2; // Increase by 2 each wave
-        enemiesRemainingInWave = enemiesPerWave;
-        
-        // Set spawn timer for first batch
-        waveSpawnTimer = 0.5f;
-        
-        LOG("Starting Wave %d with %d enemies!", waveNumber, enemiesRemainingInWave);
-    }
-
-    l1WasPressed = l1IsPressed;
-
-    // Spawn enemies in batches during a wave
-    if (waveInProgress && waveSpawnTimer <= 0.0f && enemiesRemainingInWave > 0) {
-        // Determine how many enemies to spawn in this batch
-        int batchSize = 3;
-        if (batchSize > enemiesRemainingInWave) {
-            batchSize = enemiesRemainingInWave;
-        }
-        
-        // Spawn a batch of enemies from random edges of the grid
-        for (int i = 0; i < batchSize; i++) {
-            // Choose a random edge (0=top, 1=right, 2=bottom, 3=left)
-            int edge = rand() % 4;
-            
-            float gridSize = 20.0f; // Match the grid size from initGrid
-            float enemyX, enemyZ;
-            
-            switch (edge) {
-                case 0: // Top edge
-                    enemyX = ((float)rand() / RAND_MAX) * (gridSize * 2) - gridSize;
-                    enemyZ = -gridSize;
-                    break;
-                case 1: // Right edge
-                    enemyX = gridSize;
-                    enemyZ = ((float)rand() / RAND_MAX) * (gridSize * 2) - gridSize;
-                    break;
-                case 2: // Bottom edge
-                    enemyX = ((float)rand() / RAND_MAX) * (gridSize * 2) - gridSize;
-                    enemyZ = gridSize;
-                    break;
-                case 3: // Left edge
-                    enemyX = -gridSize;
-                    enemyZ = ((float)rand() / RAND_MAX) * (gridSize * 2) - gridSize;
-                    break;
-            }
-            
-            // Spawn the enemy
-            spawn_enemy(enemyX, GROUND_LEVEL, enemyZ);
-            
-            // Decrease remaining enemies
-            enemiesRemainingInWave--;
-        }
-        
-        // Set timer for next batch
-        waveSpawnTimer = 1.0f;
-        
-        LOG("Spawned %d enemies. %d remaining in wave %d", 
-               batchSize, enemiesRemainingInWave, waveNumber);
-    }
-
-    // Check if wave is complete
-    if (waveInProgress && enemiesRemainingInWave <= 0) {
-        // Count active enemies
-        int activeEnemies = 0;
-        for (int i = 0; i < MAX_ENEMIES; i++) {
-            if (is_enemy_active(i)) {
-                activeEnemies++;
-            }
-        }
-        
-        if (activeEnemies == 0) {
-            // Wave complete
-            waveInProgress = false;
-            waveCooldown = 5.0f; // 5 seconds until next wave can be started
-            LOG("Wave %d complete! Next wave available in %.1f seconds", 
-                   waveNumber, waveCooldown);
-        }
-    }
-
-    // Display wave status
-    if (!waveInProgress && waveCooldown <= 0.0f) {
-        static int readyCounter = 0;
-        if (readyCounter++ % 60 == 0) { // Every ~60 frames
-            LOG("Press L1 to start Wave %d!", waveNumber + 1);
-        }
-    } else if (waveInProgress) {
-        static int statusCounter = 0;
-        if (statusCounter++ % 120 == 0) { // Every ~120 frames
-            // Count active enemies
-            int activeEnemies = 0;
-            for (int i = 0; i < MAX_ENEMIES; i++) {
-                if (is_enemy_active(i)) {
-                    activeEnemies++;
-                }
-            }
-            
-            LOG("Wave %d in progress: %d enemies remaining, %d active", 
-                   waveNumber, enemiesRemainingInWave, activeEnemies);
-        }
-    }
+    // Join the simulation before rendering reads enemies and projectiles
+    sim_tick_end();
+    emit_sim_events();
 }
 
 // Function to render the game world
-void renderWorld(float aspectRatio) {
-    // Calculate delta time for camera smoothing
-    double currentTime = glfwGetTime();
-    float deltaTime = (float)(currentTime - lastFrameTime);
+void renderWorld(float aspectRatio, float alpha, float frameTime) {
+    // Camera smoothing runs on real frame time, not the simulation step
+    float deltaTime = frameTime;
+    
+    // Draw the player between the last two simulation ticks
+    const SimPlayer* simPlayer = sim_get_player();
+    vec3 playerRenderPos = {
+        simPlayer->prevX + (simPlayer->body.x - simPlayer->prevX) * alpha,
+        simPlayer->prevY + (simPlayer->body.y - simPlayer->prevY) * alpha,
+        simPlayer->prevZ + (simPlayer->body.z - simPlayer->prevZ) * alpha
+    };
     
     // Debug rendering state before clearing
     static bool debugOnce = true;
@@ -478,9 +347,9 @@ void renderWorld(float aspectRatio) {
 
     // Update camera target position (smoothly follow player)
     vec3 desiredCameraPos = {
-        player.x + cameraOffset[0],
+        playerRenderPos[0] + cameraOffset[0],
         cameraOffset[1],  // Fixed height, ignores player.y
-        player.z + cameraOffset[2]
+        playerRenderPos[2] + cameraOffset[2]
     };
 
     // Calculate distance between current camera and desired position
@@ -505,9 +374,9 @@ void renderWorld(float aspectRatio) {
     // Camera target follows player horizontally but maintains a fixed vertical focus point
     // Adjust the look-at point to be slightly higher
     vec3 cameraTarget = {
-        player.x,                  // Look at player X position
+        playerRenderPos[0],        // Look at player X position
         GROUND_LEVEL + 0.6f,       // Look at a fixed height slightly higher above ground level
-        player.z                   // Look at player Z position
+        playerRenderPos[2]         // Look at player Z position
     };
 
     vec3 up = {0.0f, 1.0f, 0.0f};
@@ -520,73 +389,33 @@ void renderWorld(float aspectRatio) {
     // Adjust the field of view slightly to help with the black line issue
     glm_perspective(glm_rad(42.0f), aspectRatio, 0.1f, 100.0f, projection);
     
-    // Set shader uniforms
-    shader_set_mat4(&shader, "view", view);
-    shader_set_mat4(&shader, "projection", projection);
-    shader_set_vec3(&shader, "viewPos", cameraTargetPosition);
-    
-    // Set light properties
-    vec3 lightPos = {player.x, 10.0f, player.z}; // Light follows player
-    vec3 lightColor = {1.0f, 1.0f, 1.0f};
-    shader_set_vec3(&shader, "lightPos", lightPos);
-    shader_set_vec3(&shader, "lightColor", lightColor);
+    // Camera and light data for every program, written once per frame
+    FrameUniforms frame;
+    glm_mat4_copy(view, frame.view);
+    glm_mat4_copy(projection, frame.projection);
+    glm_mat4_mul(projection, view, frame.viewProj);
+    glm_vec4(cameraTargetPosition, 1.0f, frame.cameraPos);
+    glm_vec4((vec3){playerRenderPos[0], 10.0f, playerRenderPos[2]}, 1.0f, frame.lightPos); // Light follows player
+    glm_vec4_copy((vec4){1.0f, 1.0f, 1.0f, 1.0f}, frame.lightColor);
+    frame.time = (float)glfwGetTime();
+    frame.padding[0] = frame.padding[1] = frame.padding[2] = 0.0f;
+    frame_uniforms_update(&frame);
+    
+    // Entities outside this frustum are skipped before they are queued
+    culling_begin(frame.viewProj);
+    
+    // Everything drawn this frame goes through the render queue, which sorts
+    // it by layer, state and depth before issuing any GL call
+    renderer_begin(view);
     
     // Draw the grid for the ground plane
-    drawGrid();
+    PROFILE_SCOPE("drawGrid") drawGrid();
     
     // Use sprite shader for rendering sprites
     shader_use(&spriteShader);
     
-    // Set up view and projection for sprite shader
-    shader_set_mat4(&spriteShader, "view", view);
-    shader_set_mat4(&spriteShader, "projection", projection);
-    
-    // Add texture wrapping and filtering settings to fix the black line
-    // This should be done before rendering the sprite
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    
-    // Add a visual flash effect during attacks
-    if (player.animator.currentState == CHARACTER_STATE_ATTACK || 
-        player.animator.currentState == CHARACTER_STATE_AIR_ATTACK) {
-        // Slow down time slightly during attacks for dramatic effect
-        deltaTime *= 0.8f;
-        
-        // Add a more dramatic visual effect
-        // (This would be better with a proper particle system, but this is a simple approach)
-        
-        // Draw a simple "slash" effect
-        vec3 slashPos = {
-            player.x + (player.animator.facingRight ? 0.5f : -0.5f), 
-            player.y + 0.5f, 
-            player.z
-        };
-        
-        // Get the current frame progress (0.0 to 1.0)
-        float frameProgress = player.animator.animations[player.animator.currentState].timer / 
-                             player.animator.animations[player.animator.currentState].frameDuration;
-        
-        // Scale the slash based on frame progress (grows and then shrinks)
-        float slashScale = 1.0f;
-        if (player.animator.animations[player.animator.currentState].currentFrame < 3) {
-            slashScale = 0.5f + player.animator.animations[player.animator.currentState].currentFrame * 0.5f;
-        } else {
-            slashScale = 2.0f - (player.animator.animations[player.animator.currentState].currentFrame - 3) * 0.3f;
-        }
-        
-        // Draw the slash effect (this would be better with a dedicated slash sprite)
-        // For now, we'll just use a colored quad
-        // This would require adding a simple colored quad rendering function
-    } else {
-        // Reset the timer when not attacking
-        attackFlashTimer = 0.0f;
-        shader_set_bool(&spriteShader, "hasAttackLight", false);
-    }
-    
     // Draw player with a slight adjustment to position
-    vec3 playerPos = {player.x, player.y + 0.01f, player.z}; // Slightly raise the player
+    vec3 playerPos = {playerRenderPos[0], playerRenderPos[1] + 0.01f, playerRenderPos[2]}; // Slightly raise the player
     
     // Print sprite information
     //printf("Drawing sprite at position: x=%.2f, y=%.2f, z=%.2f\n", 
@@ -598,14 +427,25 @@ void renderWorld(float aspectRatio) {
     // Add a custom flag to the sprite shader to fix the black line
     shader_set_bool(&spriteShader, "clampTexture", true);
 
-    // Render the sprite
-    character_animator_render(&player.animator, &spriteShader, playerPos, 1.0f);
+    // Queue the player, projectile and enemy sprites; they draw back to front in one pass
+    PROFILE_SCOPE("render_player") character_animator_render(&player.animator, &spriteShader, playerPos, 1.0f);
+    PROFILE_SCOPE("render_projectiles") render_projectiles(&spriteShader, alpha);
+    PROFILE_SCOPE("render_enemies") render_enemies(alpha);
+    
+    // Particles step on the GPU at frame rate, then join the transparent pass
+    PROFILE_SCOPE("particles") {
+        particles_update(frameTime);
+        particles_render(cameraTargetPosition, (float)(viewport[3] - 1));
+    }
     
-    // Render projectiles
-    render_projectiles(&spriteShader);
+    // Damage numbers and the HUD, one overlay draw per font
+    PROFILE_SCOPE("text") {
+        text_update(frameTime);
+        draw_hud();
+        text_render((float)viewport[2], (float)(viewport[3] - 1));
+    }
     
-    // Render enemies
-    render_enemies(&spriteShader);
+    PROFILE_SCOPE("renderer_flush") renderer_flush();
     
     // Debug after all rendering is complete
     static bool debugAfterRender = true;
@@ -656,7 +496,7 @@ void initGrid() {
     glGenVertexArrays(1, &gridVAO);
     glGenBuffers(1, &gridVBO);
     
-    glBindVertexArray(gridVAO);
+    gl_state_bind_vertex_array(gridVAO);
     
     glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
     glBufferData(GL_ARRAY_BUFFER, gridVertexCount * 3 * sizeof(float), vertices, GL_STATIC_DRAW);
@@ -667,18 +507,15 @@ void initGrid() {
     
     // Unbind
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    gl_state_bind_vertex_array(0);
     
     // Free memory
     free(vertices);
 }
 
-// Function to draw the grid using modern OpenGL
-void drawGrid() {
-    // Initialize grid if not already done
-    if (gridVAO == 0) {
-        initGrid();
-    }
+// Render queue callback: the basic shader and grid VAO are already bound
+static void draw_grid_item(void* data) {
+    (void)data;
     
     // Set up model matrix for grid
     mat4 model = GLM_MAT4_IDENTITY_INIT;
@@ -690,16 +527,43 @@ void drawGrid() {
     shader_set_bool(&shader, "useTexture", false);
     
     // Draw grid
-    glBindVertexArray(gridVAO);
     glDrawArrays(GL_LINES, 0, gridVertexCount);
-    glBindVertexArray(0);
+}
+
+// Function to queue the grid with the render queue
+void drawGrid() {
+    // Initialize grid if not already done
+    if (gridVAO == 0) {
+        initGrid();
+    }
+    
+    RenderItem item = {
+        RENDER_LAYER_OPAQUE,
+        RENDER_BLEND_OPAQUE,
+        &shader,
+        0,
+        SAMPLER_NONE,
+        gridVAO,
+        {0.0f, 0.0f, 0.0f},
+        draw_grid_item,
+        NULL
+    };
+    renderer_submit(&item);
 }
 
 // Function to clean up resources
 void cleanupWorld() {
     character_cleanup(&player);
-    projectile_system_cleanup();
-    enemy_system_cleanup();
+    projectile_render_cleanup();
+    enemy_render_cleanup();
+    particles_cleanup();
+    text_cleanup();
+    shader_cleanup(&shader);
+    shader_cleanup(&spriteShader);
+    sampler_cleanup();
+    renderer_cleanup();
+    frame_uniforms_cleanup();
+    sim_cleanup();
 }
 
 // Function to debug rendering issues
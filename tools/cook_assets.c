@@ -0,0 +1,190 @@
+// cook_assets.c
+//
+// Converts the Terrible Knight and Fire Skull frame directories into one
+// binary pack (see asset_pack.h): a premultiplied RGBA atlas page with its mip
+// chain, the frame UV table and the animation groups. The game maps the pack
+// and uploads it directly instead of decoding PNGs at startup.
+//
+// Usage: cook_assets [--out FILE] (run from the repository root)
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../external/stb/stb_image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "asset_pack.h"
+#include "atlas_packer.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#define make_directory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define make_directory(path) mkdir(path, 0755)
+#endif
+
+// Largest page the cooker produces; every GL 3.3 driver we ship on supports it
+#define COOK_MAX_PAGE_SIZE 4096
+
+// Pixel data starts on this boundary so uploads read aligned rows
+#define COOK_DATA_ALIGNMENT 16
+
+static uint64_t align_offset(uint64_t offset) {
+    return (offset + COOK_DATA_ALIGNMENT - 1) & ~(uint64_t)(COOK_DATA_ALIGNMENT - 1);
+}
+
+// Pad the file with zeros up to offset
+static bool seek_to(FILE* file, uint64_t offset) {
+    long position = ftell(file);
+    if (position < 0) {
+        return false;
+    }
+    for (uint64_t i = (uint64_t)position; i < offset; i++) {
+        if (fputc(0, file) == EOF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Create the directory part of path if it is missing
+static void make_parent_directory(const char* path) {
+    char directory[512];
+    snprintf(directory, sizeof(directory), "%s", path);
+    char* slash = strrchr(directory, '/');
+    if (slash) {
+        *slash = '\0';
+        make_directory(directory);
+    }
+}
+
+static bool write_pack(const char* path, const AtlasPage* page, const AtlasImage* images, int frameCount,
+                       const AssetPackGroup* groups) {
+    AssetPackHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = ASSET_PACK_MAGIC;
+    header.version = ASSET_PACK_VERSION;
+    header.pageWidth = (uint32_t)page->width;
+    header.pageHeight = (uint32_t)page->height;
+    header.mipCount = (uint32_t)page->mipCount;
+    header.frameCount = (uint32_t)frameCount;
+    header.groupCount = ASSET_GROUP_COUNT;
+    
+    header.framesOffset = align_offset(sizeof(AssetPackHeader));
+    header.groupsOffset = align_offset(header.framesOffset + (uint64_t)frameCount * sizeof(AssetPackFrame));
+    uint64_t offset = header.groupsOffset + ASSET_GROUP_COUNT * sizeof(AssetPackGroup);
+    for (int level = 0; level < page->mipCount; level++) {
+        header.mipOffsets[level] = align_offset(offset);
+        header.mipSizes[level] = (uint64_t)atlas_mip_width(page, level) * atlas_mip_height(page, level) * 4;
+        offset = header.mipOffsets[level] + header.mipSizes[level];
+    }
+    
+    AssetPackFrame* frames = (AssetPackFrame*)calloc((size_t)(frameCount > 0 ? frameCount : 1), sizeof(AssetPackFrame));
+    for (int i = 0; i < frameCount; i++) {
+        frames[i].width = (uint32_t)images[i].width;
+        frames[i].height = (uint32_t)images[i].height;
+        if (images[i].pixels) {
+            frames[i].u0 = (float)images[i].x / (float)page->width;
+            frames[i].v0 = (float)images[i].y / (float)page->height;
+            frames[i].u1 = (float)(images[i].x + images[i].width) / (float)page->width;
+            frames[i].v1 = (float)(images[i].y + images[i].height) / (float)page->height;
+        }
+    }
+    
+    make_parent_directory(path);
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "cook_assets: cannot write %s\n", path);
+        free(frames);
+        return false;
+    }
+    
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              seek_to(file, header.framesOffset) &&
+              fwrite(frames, sizeof(AssetPackFrame), (size_t)frameCount, file) == (size_t)frameCount &&
+              seek_to(file, header.groupsOffset) &&
+              fwrite(groups, sizeof(AssetPackGroup), ASSET_GROUP_COUNT, file) == ASSET_GROUP_COUNT;
+    for (int level = 0; ok && level < page->mipCount; level++) {
+        ok = seek_to(file, header.mipOffsets[level]) &&
+             fwrite(page->mips[level], 1, (size_t)header.mipSizes[level], file) == header.mipSizes[level];
+    }
+    
+    ok = fclose(file) == 0 && ok;
+    free(frames);
+    
+    if (ok) {
+        printf("wrote %s: %dx%d atlas, %d mips, %d frames, %llu bytes\n", path, page->width, page->height,
+               page->mipCount, frameCount, (unsigned long long)offset);
+    } else {
+        fprintf(stderr, "cook_assets: failed writing %s\n", path);
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const char* outPath = ASSET_PACK_PATH;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--out FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    // Decode every group's frames in pack order
+    AtlasImage* images = NULL;
+    int frameCount = 0;
+    AssetPackGroup groups[ASSET_GROUP_COUNT];
+    
+    for (int group = 0; group < ASSET_GROUP_COUNT; group++) {
+        const char* directory = asset_group_directory((AssetGroup)group);
+        char** framePaths = NULL;
+        int count = load_animation_frames(directory, &framePaths);
+        if (count <= 0) {
+            fprintf(stderr, "cook_assets: no frames in %s\n", directory);
+            count = 0;
+        }
+        
+        groups[group].firstFrame = (uint32_t)frameCount;
+        groups[group].frameCount = (uint32_t)count;
+        
+        images = (AtlasImage*)realloc(images, (size_t)(frameCount + count + 1) * sizeof(AtlasImage));
+        for (int i = 0; i < count; i++) {
+            AtlasImage* image = &images[frameCount + i];
+            int channels;
+            memset(image, 0, sizeof(*image));
+            image->pixels = stbi_load(framePaths[i], &image->width, &image->height, &channels, 4);
+            if (!image->pixels) {
+                fprintf(stderr, "cook_assets: cannot decode %s: %s\n", framePaths[i], stbi_failure_reason());
+            }
+            free(framePaths[i]);
+        }
+        free(framePaths);
+        
+        printf("%-44s %3d frames\n", directory, count);
+        frameCount += count;
+    }
+    
+    AtlasPage page;
+    if (!atlas_pack(images, frameCount, COOK_MAX_PAGE_SIZE, &page)) {
+        fprintf(stderr, "cook_assets: nothing to pack\n");
+        free(images);
+        return 1;
+    }
+    
+    if (page.width > COOK_MAX_PAGE_SIZE || page.height > COOK_MAX_PAGE_SIZE) {
+        fprintf(stderr, "cook_assets: atlas %dx%d exceeds %d\n", page.width, page.height, COOK_MAX_PAGE_SIZE);
+    }
+    
+    bool ok = write_pack(outPath, &page, images, frameCount, groups);
+    
+    atlas_page_free(&page);
+    for (int i = 0; i < frameCount; i++) {
+        stbi_image_free(images[i].pixels);
+    }
+    free(images);
+    return ok ? 0 : 1;
+}